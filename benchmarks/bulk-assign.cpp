@@ -0,0 +1,142 @@
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include <xlnt/xlnt.hpp>
+
+namespace {
+using milliseconds_d = std::chrono::duration<double, std::milli>;
+
+template <typename Fn>
+double time_ms(Fn fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return milliseconds_d(std::chrono::steady_clock::now() - start).count();
+}
+
+// Writes and reads back a block of rows x columns numbers, first a cell at a
+// time and then with worksheet::assign and worksheet::extract.
+void run_bulk_test(xlnt::row_t rows, xlnt::column_t::index_t columns)
+{
+    std::cout << rows << " rows of " << columns << " numbers\n\n";
+
+    std::vector<double> values(static_cast<std::size_t>(rows) * columns);
+
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        values[i] = static_cast<double>(i) * 0.5;
+    }
+
+    const auto range = xlnt::range_reference(1, 1, columns, rows);
+    std::vector<double> read(values.size());
+
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        auto write = time_ms([&]() {
+            auto value = values.begin();
+
+            for (xlnt::row_t row = 1; row <= rows; ++row)
+            {
+                for (xlnt::column_t::index_t column = 1; column <= columns; ++column)
+                {
+                    ws.cell(column, row).value(*value++);
+                }
+            }
+        });
+
+        auto extract = time_ms([&]() {
+            auto value = read.begin();
+
+            for (xlnt::row_t row = 1; row <= rows; ++row)
+            {
+                for (xlnt::column_t::index_t column = 1; column <= columns; ++column)
+                {
+                    *value++ = ws.cell(column, row).value<double>();
+                }
+            }
+        });
+
+        std::cout << "per cell: " << write << " ms write, " << extract << " ms read\n";
+    }
+
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        auto write = time_ms([&]() { ws.assign(range, values.data(), values.size()); });
+        auto extract = time_ms([&]() { ws.extract(range, read.data(), read.size()); });
+
+        std::cout << "bulk:     " << write << " ms write, " << extract << " ms read\n";
+    }
+
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        std::vector<std::vector<xlnt::variant>> batch(rows, std::vector<xlnt::variant>(columns));
+
+        for (xlnt::row_t row = 0; row < rows; ++row)
+        {
+            for (xlnt::column_t::index_t column = 0; column < columns; ++column)
+            {
+                batch[row][column] = xlnt::variant(values[row * columns + column]);
+            }
+        }
+
+        auto write = time_ms([&]() { ws.assign(xlnt::cell_reference(1, 1), batch); });
+
+        std::cout << "variants: " << write << " ms write\n\n";
+    }
+}
+
+// Writes a block of rows x columns dates, first a cell at a time and then with
+// worksheet::assign, which looks up the date format once rather than per cell.
+void run_date_test(xlnt::row_t rows, xlnt::column_t::index_t columns)
+{
+    std::cout << rows << " rows of " << columns << " dates\n\n";
+
+    std::vector<std::vector<xlnt::variant>> batch(rows, std::vector<xlnt::variant>(columns));
+
+    for (xlnt::row_t row = 0; row < rows; ++row)
+    {
+        for (xlnt::column_t::index_t column = 0; column < columns; ++column)
+        {
+            batch[row][column] = xlnt::variant(xlnt::datetime(2021, 1 + static_cast<int>(row % 12), 1 + static_cast<int>(column % 28)));
+        }
+    }
+
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        auto write = time_ms([&]() {
+            for (xlnt::row_t row = 1; row <= rows; ++row)
+            {
+                for (xlnt::column_t::index_t column = 1; column <= columns; ++column)
+                {
+                    ws.cell(column, row).value(batch[row - 1][column - 1].get<xlnt::datetime>());
+                }
+            }
+        });
+
+        std::cout << "per cell: " << write << " ms write\n";
+    }
+
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        auto write = time_ms([&]() { ws.assign(xlnt::cell_reference(1, 1), batch); });
+
+        std::cout << "variants: " << write << " ms write\n\n";
+    }
+}
+} // namespace
+
+int main()
+{
+    run_bulk_test(200000, 20);
+    run_date_test(2000, 4);
+}
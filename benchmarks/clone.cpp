@@ -0,0 +1,59 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <xlnt/xlnt.hpp>
+
+namespace {
+using milliseconds_d = std::chrono::duration<double, std::milli>;
+
+// Copies a workbook with a sheet of rows rows of columns numbers and a column
+// of strings clones times, changing changes cells of each copy, and reports
+// the time taken by the copies and by the changes.
+void run_clone_test(xlnt::row_t rows, xlnt::column_t::index_t columns, int clones, int changes)
+{
+    std::cout << clones << " clones of " << rows << " rows of " << columns
+              << " numbers, " << changes << " changed cells each\n\n";
+
+    xlnt::workbook wb;
+    auto ws = wb.active_sheet();
+    std::vector<double> values(static_cast<std::size_t>(rows) * columns, 1.0);
+    ws.assign(xlnt::range_reference(1, 1, columns, rows), values.data(), values.size());
+
+    for (xlnt::row_t row = 1; row <= rows; row += 10)
+    {
+        ws.cell(columns + 1, row).value("string " + std::to_string(row));
+    }
+
+    auto copying = milliseconds_d(0);
+    auto changing = milliseconds_d(0);
+
+    for (int i = 0; i < clones; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        xlnt::workbook clone(wb);
+        auto copied = std::chrono::steady_clock::now();
+
+        auto clone_ws = clone.active_sheet();
+
+        for (int j = 0; j < changes; ++j)
+        {
+            const auto row = static_cast<xlnt::row_t>(j) * (rows / static_cast<xlnt::row_t>(changes)) + 1;
+            clone_ws.cell(1, row).value(j);
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        copying += copied - start;
+        changing += end - copied;
+    }
+
+    std::cout << copying.count() / clones << " ms per clone\n"
+              << changing.count() / clones << " ms per " << changes << " changes\n\n";
+}
+} // namespace
+
+int main()
+{
+    run_clone_test(200000, 10, 20, 300);
+}
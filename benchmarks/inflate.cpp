@@ -0,0 +1,120 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <detail/serialization/zstream.hpp>
+#include <helpers/path_helper.hpp>
+#include <xlnt/xlnt.hpp>
+
+namespace {
+
+using milliseconds_d = std::chrono::duration<double, std::milli>;
+
+// Inflates every part of the archive through a std::istream the way the XML
+// readers consume them and returns the number of bytes read.
+std::size_t inflate_all(const xlnt::detail::izstream &archive)
+{
+    std::vector<char> chunk(64 * 1024);
+    std::size_t total = 0;
+
+    for (const auto &part : archive.files())
+    {
+        auto buffer = archive.open(part);
+        std::istream stream(buffer.get());
+
+        while (stream)
+        {
+            stream.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+            total += static_cast<std::size_t>(stream.gcount());
+        }
+    }
+
+    return total;
+}
+
+void report(const std::string &label, xlnt::detail::izstream &archive,
+    std::size_t buffer_size, std::size_t contiguous_limit, int runs)
+{
+    archive.inflate_buffer_size(buffer_size);
+    archive.contiguous_inflate_limit(contiguous_limit);
+
+    auto best = milliseconds_d::max();
+    std::size_t bytes = 0;
+
+    for (int i = 0; i < runs; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        bytes = inflate_all(archive);
+        auto end = std::chrono::steady_clock::now();
+
+        best = std::min(best, milliseconds_d(end - start));
+    }
+
+    std::cout << label << ": " << best.count() << " ms, "
+              << static_cast<double>(bytes) / (1024 * 1024) / (best.count() / 1000) << " MiB/s\n";
+}
+
+void run_inflate_test(const xlnt::path &file, int runs = 5)
+{
+    std::cout << file.string() << "\n\n";
+
+    std::ifstream file_stream(file.string(), std::ios::binary);
+    const std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(file_stream)),
+        std::istreambuf_iterator<char>());
+
+    // the reader before inflate buffers were configurable
+    file_stream.clear();
+    file_stream.seekg(0);
+    xlnt::detail::izstream stream_archive(file_stream);
+    report("stream, 512 B buffers", stream_archive, 512, 0, runs);
+    report("stream, 256 KiB buffers", stream_archive,
+        xlnt::detail::default_inflate_buffer_size, xlnt::detail::default_contiguous_inflate_limit, runs);
+
+    xlnt::detail::izstream memory_archive(bytes.data(), bytes.size());
+    report("memory, 512 B buffers", memory_archive, 512, 0, runs);
+
+    for (auto size : {64 * 1024, 256 * 1024, 1024 * 1024})
+    {
+        const auto label = std::to_string(size / 1024) + " KiB buffers";
+        report("memory, " + label, memory_archive, static_cast<std::size_t>(size), 0, runs);
+        report("memory, " + label + ", small parts whole", memory_archive,
+            static_cast<std::size_t>(size), xlnt::detail::default_contiguous_inflate_limit, runs);
+    }
+
+    std::cout << "\n";
+}
+
+} // namespace
+
+int main()
+{
+    run_inflate_test(path_helper::benchmark_file("large.xlsx"));
+
+    return 0;
+}
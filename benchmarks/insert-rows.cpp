@@ -0,0 +1,53 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <xlnt/xlnt.hpp>
+
+namespace {
+using milliseconds_d = std::chrono::duration<double, std::milli>;
+
+// Inserts inserts single rows at random positions into a sheet of rows rows
+// of columns numbers, then deletes as many again, and reports the time taken.
+void run_insert_test(xlnt::row_t rows, xlnt::column_t::index_t columns, int inserts)
+{
+    std::cout << inserts << " random row inserts/deletes in " << rows
+              << " rows of " << columns << " numbers\n\n";
+
+    xlnt::workbook wb;
+    auto ws = wb.active_sheet();
+    std::vector<double> values(static_cast<std::size_t>(rows) * columns, 1.0);
+    ws.assign(xlnt::range_reference(1, 1, columns, rows), values.data(), values.size());
+
+    std::mt19937 random(42);
+    std::uniform_int_distribution<xlnt::row_t> position(1, rows);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < inserts; ++i)
+    {
+        ws.insert_rows(position(random), 1);
+    }
+
+    auto inserted = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < inserts; ++i)
+    {
+        ws.delete_rows(position(random), 1);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << milliseconds_d(inserted - start).count() << " ms insert ("
+              << milliseconds_d(inserted - start).count() / inserts << " ms per row)\n"
+              << milliseconds_d(end - inserted).count() << " ms delete ("
+              << milliseconds_d(end - inserted).count() / inserts << " ms per row)\n"
+              << ws.highest_row() << " rows left\n\n";
+}
+} // namespace
+
+int main()
+{
+    run_insert_test(200000, 10, 1000);
+}
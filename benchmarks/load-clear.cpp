@@ -0,0 +1,74 @@
+#include <xlnt/xlnt.hpp>
+#include <chrono>
+#include <helpers/path_helper.hpp>
+
+namespace {
+using milliseconds_d = std::chrono::duration<double, std::milli>;
+
+// Loads and clears a workbook runs times, like a server reading uploaded files
+// one after another, and reports how long each of the two steps took.
+template <typename Load>
+void run_load_clear_test(const std::string &name, Load load, int runs = 10)
+{
+    for (auto cell_arena : {false, true})
+    {
+        std::cout << name << (cell_arena ? " (cell arena)" : "") << "\n\n";
+
+        const auto options = xlnt::load_options().cell_arena(cell_arena);
+        xlnt::workbook wb;
+        milliseconds_d total_load(0);
+        milliseconds_d total_clear(0);
+
+        for (int i = 0; i < runs; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            load(wb, options);
+            auto loaded = std::chrono::steady_clock::now();
+            wb.clear();
+            auto end = std::chrono::steady_clock::now();
+
+            total_load += loaded - start;
+            total_clear += end - loaded;
+            std::cout << milliseconds_d(loaded - start).count() << " ms load, "
+                      << milliseconds_d(end - loaded).count() << " ms clear\n";
+        }
+
+        std::cout << "average " << total_load.count() / runs << " ms load, "
+                  << total_clear.count() / runs << " ms clear\n\n";
+    }
+}
+
+std::vector<std::uint8_t> generate_tall_workbook(xlnt::row_t rows)
+{
+    xlnt::workbook wb;
+    auto ws = wb.active_sheet();
+
+    for (xlnt::row_t row = 1; row <= rows; ++row)
+    {
+        for (xlnt::column_t::index_t column = 1; column < 10; ++column)
+        {
+            ws.cell(column, row).value(row * column);
+        }
+
+        ws.cell(10, row).formula("=SUM(A" + std::to_string(row) + ":I" + std::to_string(row) + ")");
+    }
+
+    std::vector<std::uint8_t> data;
+    wb.save(data);
+
+    return data;
+}
+} // namespace
+
+int main()
+{
+    const auto large = path_helper::benchmark_file("large.xlsx");
+    run_load_clear_test(large.string(), [&large](xlnt::workbook &wb, const xlnt::load_options &options) {
+        wb.load(large, options);
+    });
+
+    const auto tall = generate_tall_workbook(100000);
+    run_load_clear_test("100000 rows of 10 cells", [&tall](xlnt::workbook &wb, const xlnt::load_options &options) {
+        wb.load(tall, options);
+    });
+}
@@ -0,0 +1,74 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include <xlnt/xlnt.hpp>
+
+namespace {
+using milliseconds_d = std::chrono::duration<double, std::milli>;
+
+// Returns a workbook with format_count distinct cell formats, combinations of
+// fonts, fills and number formats, used round robin by rows rows of columns
+// numbers.
+std::vector<std::uint8_t> generate_formatted_workbook(std::size_t format_count, xlnt::row_t rows, xlnt::column_t::index_t columns)
+{
+    xlnt::workbook wb;
+    auto ws = wb.active_sheet();
+    std::vector<xlnt::format> formats;
+    const std::size_t number_formats[] = {0, 1, 2, 3, 4, 9, 10, 11, 12, 13};
+
+    // formatted through cells in an extra column, formats without cells would be removed
+    for (std::size_t i = 0; i < format_count; ++i)
+    {
+        auto cell = ws.cell(columns + 1, static_cast<xlnt::row_t>(i + 1));
+        cell.font(xlnt::font().size(8.0 + static_cast<double>(i % 50)));
+        cell.fill(xlnt::fill::solid(xlnt::rgb_color(0, static_cast<std::uint8_t>(i / 50 % 10 * 20), 0)));
+        cell.number_format(xlnt::number_format::from_builtin_id(number_formats[i / 500 % 10]));
+        formats.push_back(cell.format());
+    }
+
+    for (xlnt::row_t row = 1; row <= rows; ++row)
+    {
+        for (xlnt::column_t::index_t column = 1; column <= columns; ++column)
+        {
+            auto cell = ws.cell(column, row);
+            cell.value(row);
+            cell.format(formats[(row * columns + column) % formats.size()]);
+        }
+    }
+
+    std::vector<std::uint8_t> data;
+    wb.save(data);
+
+    return data;
+}
+
+// Loads a workbook with format_count cell formats runs times and reports how
+// long loading took.
+void run_load_formats_test(std::size_t format_count, xlnt::row_t rows, xlnt::column_t::index_t columns, int runs)
+{
+    std::cout << rows << " rows of " << columns << " cells using " << format_count << " formats\n\n";
+
+    const auto data = generate_formatted_workbook(format_count, rows, columns);
+    milliseconds_d total(0);
+
+    for (int i = 0; i < runs; ++i)
+    {
+        xlnt::workbook wb;
+        auto start = std::chrono::steady_clock::now();
+        wb.load(data);
+        auto end = std::chrono::steady_clock::now();
+
+        total += end - start;
+        std::cout << milliseconds_d(end - start).count() << " ms\n";
+    }
+
+    std::cout << "average " << total.count() / runs << " ms\n\n";
+}
+} // namespace
+
+int main()
+{
+    run_load_formats_test(5000, 50000, 10, 5);
+}
@@ -0,0 +1,120 @@
+// Almost all of the time spent loading a worksheet goes into reading its sheetData element
+// this compares the general purpose xml::parser with the sheetData tokenizer used by xlsx_consumer
+// - both read the same generated sheetData of numeric, shared string and formula cells
+// - both visit every name, attribute and value the consumer would look at
+
+#include <benchmark/benchmark.h>
+#include <sstream>
+#include <string>
+
+#include <detail/external/include_libstudxml.hpp>
+#include <detail/serialization/sheet_data_tokenizer.hpp>
+
+namespace {
+
+std::string generate_worksheet(int rows)
+{
+    std::string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>"
+                      "<worksheet xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\">"
+                      "<sheetData>";
+
+    for (int row = 1; row <= rows; ++row)
+    {
+        const auto r = std::to_string(row);
+        xml.append("<row r=\"" + r + "\" spans=\"1:3\">");
+        xml.append("<c r=\"A" + r + "\"><v>" + std::to_string(row * 1.25) + "</v></c>");
+        xml.append("<c r=\"B" + r + "\" t=\"s\" s=\"1\"><v>" + std::to_string(row % 100) + "</v></c>");
+        xml.append("<c r=\"C" + r + "\"><f>A" + r + "*2</f><v>" + std::to_string(row * 2.5) + "</v></c>");
+        xml.append("</row>");
+    }
+
+    xml.append("</sheetData></worksheet>");
+
+    return xml;
+}
+
+class SheetData : public benchmark::Fixture
+{
+public:
+    void SetUp(const ::benchmark::State &state)
+    {
+        xml = generate_worksheet(static_cast<int>(state.range(0)));
+    }
+
+    void TearDown(const ::benchmark::State &)
+    {
+        xml = std::string{};
+    }
+
+    std::string xml;
+};
+
+} // namespace
+
+BENCHMARK_DEFINE_F(SheetData, studxml_parser)
+(benchmark::State &state)
+{
+    while (state.KeepRunning())
+    {
+        std::istringstream part(xml);
+        xml::parser parser(part, "sheet1.xml");
+        std::size_t total = 0;
+
+        for (auto e : parser)
+        {
+            if (e == xml::parser::start_element)
+            {
+                for (auto &attr : parser.attribute_map())
+                {
+                    total += attr.second.value.size();
+                }
+            }
+            else if (e == xml::parser::characters)
+            {
+                total += parser.value().size();
+            }
+        }
+
+        benchmark::DoNotOptimize(total);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * xml.size()));
+}
+BENCHMARK_REGISTER_F(SheetData, studxml_parser)->Arg(1000)->Arg(100000);
+
+BENCHMARK_DEFINE_F(SheetData, sheet_data_tokenizer)
+(benchmark::State &state)
+{
+    using event = xlnt::detail::sheet_data_tokenizer::event;
+
+    while (state.KeepRunning())
+    {
+        std::istringstream part(xml);
+        xlnt::detail::sheet_data_tokenizer tokenizer(part);
+        std::string document;
+        std::size_t total = 0;
+
+        tokenizer.read_to_sheet_data(document);
+
+        for (auto e = tokenizer.next(); e != event::end_of_sheet_data; e = tokenizer.next())
+        {
+            if (e == event::start_element)
+            {
+                for (auto &attr : tokenizer.attributes())
+                {
+                    total += attr.value.size;
+                }
+            }
+            else if (e == event::characters)
+            {
+                total += tokenizer.value().size;
+            }
+        }
+
+        tokenizer.read_remainder(document);
+        benchmark::DoNotOptimize(total);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * xml.size()));
+}
+BENCHMARK_REGISTER_F(SheetData, sheet_data_tokenizer)->Arg(1000)->Arg(100000);
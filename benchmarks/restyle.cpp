@@ -0,0 +1,58 @@
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include <xlnt/xlnt.hpp>
+
+namespace {
+using milliseconds_d = std::chrono::duration<double, std::milli>;
+
+// Gives the cells of a sheet of rows rows of columns numbers one of fonts
+// distinct fonts each, then the next one, and reports the time taken.
+void run_restyle_test(xlnt::row_t rows, xlnt::column_t::index_t columns, std::size_t fonts)
+{
+    std::cout << fonts << " fonts applied to " << rows << " rows of " << columns << " numbers\n\n";
+
+    xlnt::workbook wb;
+    auto ws = wb.active_sheet();
+    std::vector<double> values(static_cast<std::size_t>(rows) * columns, 1.0);
+    ws.assign(xlnt::range_reference(1, 1, columns, rows), values.data(), values.size());
+
+    std::vector<xlnt::font> distinct;
+
+    for (std::size_t i = 0; i < fonts; ++i)
+    {
+        distinct.push_back(xlnt::font().name("Calibri").size(10.0 + static_cast<double>(i)));
+    }
+
+    for (std::size_t pass = 0; pass < 2; ++pass)
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::size_t i = pass;
+
+        for (xlnt::row_t row = 1; row <= rows; ++row)
+        {
+            for (xlnt::column_t::index_t column = 1; column <= columns; ++column)
+            {
+                ws.cell(column, row).font(distinct[i++ % fonts]);
+            }
+        }
+
+        auto end = std::chrono::steady_clock::now();
+
+        std::cout << (pass == 0 ? "unformatted cells: " : "formatted cells: ")
+                  << milliseconds_d(end - start).count() << " ms\n";
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    wb.compact_styles();
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << "compact_styles: " << milliseconds_d(end - start).count() << " ms\n\n";
+}
+} // namespace
+
+int main()
+{
+    run_restyle_test(100000, 10, 10);
+}
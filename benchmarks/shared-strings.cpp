@@ -0,0 +1,126 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <xlnt/xlnt.hpp>
+
+namespace {
+using milliseconds_d = std::chrono::duration<double, std::milli>;
+
+// every allocation is prefixed with its size so that live bytes can be counted
+const std::size_t header_size = sizeof(std::max_align_t);
+std::size_t live_bytes = 0;
+std::size_t allocations = 0;
+} // namespace
+
+void *operator new(std::size_t size)
+{
+    auto block = static_cast<char *>(std::malloc(size + header_size));
+
+    if (block == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    *reinterpret_cast<std::size_t *>(block) = size;
+    live_bytes += size;
+    ++allocations;
+
+    return block + header_size;
+}
+
+void operator delete(void *pointer) noexcept
+{
+    if (pointer == nullptr) return;
+
+    auto block = static_cast<char *>(pointer) - header_size;
+    live_bytes -= *reinterpret_cast<std::size_t *>(block);
+    std::free(block);
+}
+
+namespace {
+
+// Adds count strings, unique of them distinct, to a workbook, then adds them
+// all again, and reports the memory taken by the shared strings and the
+// allocations made while adding strings which are already shared. The same is
+// reported for a vector of rich_text with a hash map from rich_text to index,
+// which is how shared strings were kept before.
+void run_shared_strings_test(std::size_t count, std::size_t unique)
+{
+    std::cout << count << " strings, " << unique << " distinct\n\n";
+
+    std::vector<std::string> strings;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        strings.push_back("customer name " + std::to_string(i % unique));
+    }
+
+    {
+        const auto before = live_bytes;
+        std::unordered_map<xlnt::rich_text, std::size_t, xlnt::rich_text_hash> ids;
+        std::vector<xlnt::rich_text> values;
+
+        for (const auto &text : strings)
+        {
+            const auto rich = xlnt::rich_text(text);
+
+            if (ids.find(rich) == ids.end())
+            {
+                ids[rich] = values.size();
+                values.push_back(rich);
+            }
+        }
+
+        const auto used = live_bytes - before;
+        const auto allocations_before = allocations;
+        auto start = std::chrono::steady_clock::now();
+
+        for (const auto &text : strings)
+        {
+            ids.find(xlnt::rich_text(text));
+        }
+
+        auto end = std::chrono::steady_clock::now();
+
+        std::cout << "rich_text table: " << used / (1024.0 * 1024.0) << " MB, "
+                  << milliseconds_d(end - start).count() << " ms and "
+                  << allocations - allocations_before << " allocations to find existing strings\n";
+    }
+
+    {
+        xlnt::workbook wb;
+        const auto before = live_bytes;
+
+        for (const auto &text : strings)
+        {
+            wb.add_shared_string(text);
+        }
+
+        const auto used = live_bytes - before;
+        const auto allocations_before = allocations;
+        auto start = std::chrono::steady_clock::now();
+
+        for (const auto &text : strings)
+        {
+            wb.add_shared_string(text);
+        }
+
+        auto end = std::chrono::steady_clock::now();
+
+        std::cout << "workbook:        " << used / (1024.0 * 1024.0) << " MB, "
+                  << milliseconds_d(end - start).count() << " ms and "
+                  << allocations - allocations_before << " allocations to find existing strings\n\n";
+    }
+}
+} // namespace
+
+int main()
+{
+    run_shared_strings_test(1000000, 200000);
+}
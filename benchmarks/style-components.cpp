@@ -0,0 +1,49 @@
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include <detail/implementations/stylesheet.hpp>
+#include <xlnt/xlnt.hpp>
+
+namespace {
+using milliseconds_d = std::chrono::duration<double, std::milli>;
+
+// Adds distinct fonts and as many fills to a stylesheet, then looks them up
+// lookups times in turn, as setting the font or fill of a cell does, and
+// reports the time taken.
+void run_style_components_test(std::size_t distinct, std::size_t lookups)
+{
+    std::cout << lookups << " lookups of " << distinct << " fonts and fills\n\n";
+
+    std::vector<xlnt::font> fonts;
+    std::vector<xlnt::fill> fills;
+
+    for (std::size_t i = 0; i < distinct; ++i)
+    {
+        fonts.push_back(xlnt::font().name("Calibri").size(8.0 + static_cast<double>(i % 40)).bold(i / 40 % 2 == 0).italic(i / 80 % 2 == 0).color(xlnt::rgb_color(0, 0, static_cast<std::uint8_t>(i / 160))));
+        fills.push_back(xlnt::fill::solid(xlnt::rgb_color(static_cast<std::uint8_t>(i % 256), static_cast<std::uint8_t>(i / 256), 0)));
+    }
+
+    xlnt::detail::stylesheet stylesheet;
+    std::size_t checksum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i < lookups; ++i)
+    {
+        checksum += stylesheet.find_or_add(stylesheet.fonts, fonts[i % distinct]);
+        checksum += stylesheet.find_or_add(stylesheet.fills, fills[i % distinct]);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << milliseconds_d(end - start).count() << " ms ("
+              << milliseconds_d(end - start).count() * 1e6 / static_cast<double>(2 * lookups) << " ns per lookup), "
+              << stylesheet.fonts.size() << " fonts, " << stylesheet.fills.size() << " fills, checksum " << checksum << "\n\n";
+}
+} // namespace
+
+int main()
+{
+    run_style_components_test(300, 1000000);
+}
@@ -0,0 +1,59 @@
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include <xlnt/xlnt.hpp>
+
+namespace {
+using milliseconds_d = std::chrono::duration<double, std::milli>;
+
+// Converts every cell of a sheet of rows rows of columns numbers to a string,
+// as a CSV export does, then formats as many numbers with a percentage
+// format, and reports the time taken.
+void run_to_string_test(xlnt::row_t rows, xlnt::column_t::index_t columns)
+{
+    std::cout << "to_string of " << rows << " rows of " << columns << " numbers\n\n";
+
+    xlnt::workbook wb;
+    auto ws = wb.active_sheet();
+    std::vector<double> values(static_cast<std::size_t>(rows) * columns);
+
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        values[i] = static_cast<double>(i) / 7.0;
+    }
+
+    ws.assign(xlnt::range_reference(1, 1, columns, rows), values.data(), values.size());
+
+    std::size_t length = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (auto row : ws.rows())
+    {
+        for (auto cell : row)
+        {
+            length += cell.to_string().size();
+        }
+    }
+
+    auto converted = std::chrono::steady_clock::now();
+
+    const auto percentage = xlnt::number_format::percentage_00();
+
+    for (auto value : values)
+    {
+        length += percentage.format(value, xlnt::calendar::windows_1900).size();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << milliseconds_d(converted - start).count() << " ms for cell::to_string\n"
+              << milliseconds_d(end - converted).count() << " ms for number_format::format\n"
+              << length << " characters\n\n";
+}
+} // namespace
+
+int main()
+{
+    run_to_string_test(100000, 10);
+}
@@ -67,6 +67,7 @@ class xlsx_consumer;
 class xlsx_producer;
 
 struct cell_impl;
+struct worksheet_impl;
 
 } // namespace detail
 
@@ -626,6 +627,7 @@ public:
     bool operator!=(const cell &comparand) const;
 
 private:
+    friend class range;
     friend class style;
     friend class worksheet;
     friend class detail::xlsx_consumer;
@@ -644,14 +646,21 @@ private:
     cell() = delete;
 
     /// <summary>
-    /// Private constructor to create a cell from its implementation.
+    /// Private constructor to create a cell from its implementation and the
+    /// worksheet it was found in.
     /// </summary>
-    cell(detail::cell_impl *d);
+    cell(detail::cell_impl *d, detail::worksheet_impl *parent);
 
     /// <summary>
     /// A pointer to this cell's implementation.
     /// </summary>
     detail::cell_impl *d_;
+
+    /// <summary>
+    /// The worksheet this cell belongs to. The implementation may be shared
+    /// by copies of the worksheet, so it's held here rather than taken from it.
+    /// </summary>
+    detail::worksheet_impl *parent_;
 };
 
 /// <summary>
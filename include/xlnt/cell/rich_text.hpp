@@ -33,6 +33,12 @@
 
 namespace xlnt {
 
+namespace detail {
+
+class shared_string_pool;
+
+} // namespace detail
+
 /// <summary>
 /// Encapsulates zero or more formatted text runs where a text run
 /// is a string of text with the same defined formatting.
@@ -152,6 +158,8 @@ public:
     bool operator!=(const std::string &rhs) const;
 
 private:
+    friend class detail::shared_string_pool;
+
     /// <summary>
     /// The runs that make up this rich text.
     /// </summary>
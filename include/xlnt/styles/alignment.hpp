@@ -24,6 +24,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include <xlnt/xlnt_config.hpp>
 #include <xlnt/utils/optional.hpp>
 
@@ -166,3 +168,19 @@ private:
 };
 
 } // namespace xlnt
+
+namespace std {
+
+/// <summary>
+/// Template specialization to allow xlnt::alignment to be used as a key in a std container.
+/// </summary>
+template <>
+struct XLNT_API hash<xlnt::alignment>
+{
+    /// <summary>
+    /// Returns the result of hashing a. Equal alignments have equal hashes.
+    /// </summary>
+    size_t operator()(const xlnt::alignment &a) const;
+};
+
+} // namespace std
@@ -225,3 +225,19 @@ private:
 };
 
 } // namespace xlnt
+
+namespace std {
+
+/// <summary>
+/// Template specialization to allow xlnt::border to be used as a key in a std container.
+/// </summary>
+template <>
+struct XLNT_API hash<xlnt::border>
+{
+    /// <summary>
+    /// Returns the result of hashing b. Equal borders have equal hashes.
+    /// </summary>
+    size_t operator()(const xlnt::border &b) const;
+};
+
+} // namespace std
@@ -25,6 +25,7 @@
 #pragma once
 
 #include <array>
+#include <functional>
 #include <string>
 
 #include <xlnt/xlnt_config.hpp>
@@ -348,3 +349,19 @@ private:
 };
 
 } // namespace xlnt
+
+namespace std {
+
+/// <summary>
+/// Template specialization to allow xlnt::color to be used as a key in a std container.
+/// </summary>
+template <>
+struct XLNT_API hash<xlnt::color>
+{
+    /// <summary>
+    /// Returns the result of hashing c. Equal colors have equal hashes.
+    /// </summary>
+    size_t operator()(const xlnt::color &c) const;
+};
+
+} // namespace std
@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <functional>
 #include <string>
 
 #include <xlnt/xlnt_config.hpp>
@@ -322,3 +323,19 @@ private:
 };
 
 } // namespace xlnt
+
+namespace std {
+
+/// <summary>
+/// Template specialization to allow xlnt::font to be used as a key in a std container.
+/// </summary>
+template <>
+struct XLNT_API hash<xlnt::font>
+{
+    /// <summary>
+    /// Returns the result of hashing f. Equal fonts have equal hashes.
+    /// </summary>
+    size_t operator()(const xlnt::font &f) const;
+};
+
+} // namespace std
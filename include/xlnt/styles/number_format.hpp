@@ -25,6 +25,7 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
 #include <string>
 
 #include <xlnt/xlnt_config.hpp>
@@ -272,3 +273,19 @@ private:
 };
 
 } // namespace xlnt
+
+namespace std {
+
+/// <summary>
+/// Template specialization to allow xlnt::number_format to be used as a key in a std container.
+/// </summary>
+template <>
+struct XLNT_API hash<xlnt::number_format>
+{
+    /// <summary>
+    /// Returns the result of hashing f. Number formats with the same format string have equal hashes.
+    /// </summary>
+    size_t operator()(const xlnt::number_format &f) const;
+};
+
+} // namespace std
@@ -25,6 +25,7 @@
 #pragma once
 
 #include <cstddef>
+#include <functional>
 
 #include <xlnt/xlnt_config.hpp>
 #include <xlnt/utils/optional.hpp>
@@ -105,3 +106,19 @@ private:
 };
 
 } // namespace xlnt
+
+namespace std {
+
+/// <summary>
+/// Template specialization to allow xlnt::protection to be used as a key in a std container.
+/// </summary>
+template <>
+struct XLNT_API hash<xlnt::protection>
+{
+    /// <summary>
+    /// Returns the result of hashing p. Equal protections have equal hashes.
+    /// </summary>
+    size_t operator()(const xlnt::protection &p) const;
+};
+
+} // namespace std
@@ -62,7 +62,7 @@ public:
         //ui8,
         //uint,
         //r4,
-        //r8,
+        r8,
         //decimal,
         lpstr, // TODO: how does this differ from lpwstr?
         //lpwstr,
@@ -100,6 +100,11 @@ public:
     /// </summary>
     variant(std::int32_t value);
 
+    /// <summary>
+    /// Creates a r8-type variant with the given value.
+    /// </summary>
+    variant(double value);
+
     /// <summary>
     /// Creates a bool-type variant with the given value.
     /// </summary>
@@ -168,6 +173,7 @@ private:
     type type_;
     std::vector<variant> vector_value_;
     std::int32_t i4_value_;
+    double r8_value_;
     std::string lpstr_value_;
 };
 
@@ -177,6 +183,9 @@ bool variant::get() const;
 template <>
 std::int32_t variant::get() const;
 
+template <>
+double variant::get() const;
+
 template <>
 std::string variant::get() const;
 
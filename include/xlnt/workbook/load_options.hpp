@@ -0,0 +1,284 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/utils/optional.hpp>
+#include <xlnt/worksheet/range_reference.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// Controls how workbook::load reads an XLSX package.
+/// Default constructed options behave exactly like the overloads of load
+/// which don't take options.
+/// </summary>
+class XLNT_API load_options
+{
+public:
+    /// <summary>
+    /// Constructs the default options. Every part is read and worksheets are
+    /// read serially.
+    /// </summary>
+    load_options();
+
+    /// <summary>
+    /// Returns the maximum number of threads used to parse worksheets.
+    /// </summary>
+    std::size_t worker_threads() const;
+
+    /// <summary>
+    /// Sets the maximum number of threads used to parse worksheets concurrently.
+    /// A value of 1 reads every worksheet on the calling thread and a value of 0
+    /// uses one thread per hardware core. The loaded workbook is identical in all cases.
+    /// </summary>
+    load_options &worker_threads(std::size_t count);
+
+    /// <summary>
+    /// Returns the titles of the worksheets to be loaded.
+    /// </summary>
+    const std::vector<std::string> &sheet_titles() const;
+
+    /// <summary>
+    /// Loads only the worksheets with the given titles and those selected by
+    /// sheet_indices. Other worksheets are left out of the loaded workbook and
+    /// their parts are never read. If neither list is set, every worksheet is
+    /// loaded. Loading throws xlnt::key_not_found if a title doesn't exist.
+    /// </summary>
+    load_options &sheet_titles(const std::vector<std::string> &titles);
+
+    /// <summary>
+    /// Returns the zero-based indices of the worksheets to be loaded.
+    /// </summary>
+    const std::vector<std::size_t> &sheet_indices() const;
+
+    /// <summary>
+    /// Loads only the worksheets at the given zero-based positions in the
+    /// workbook and those selected by sheet_titles. Loading throws
+    /// xlnt::key_not_found if an index is out of range.
+    /// </summary>
+    load_options &sheet_indices(const std::vector<std::size_t> &indices);
+
+    /// <summary>
+    /// Returns true if the worksheet at index with the given title should be loaded.
+    /// </summary>
+    bool loads_sheet(std::size_t index, const std::string &title) const;
+
+    /// <summary>
+    /// Returns the range of cells to be loaded from each worksheet, if set.
+    /// </summary>
+    const optional<range_reference> &projection() const;
+
+    /// <summary>
+    /// Loads only the cells and row properties inside range from each
+    /// worksheet, e.g. "A2:H1048576" for columns A to H from the second row
+    /// down. Rows and cells outside range are skipped without being parsed.
+    /// Merged cells, hyperlinks and comments are not affected. Shared formulae
+    /// defined by a skipped cell are not restored in the cells inside range.
+    /// </summary>
+    load_options &projection(const range_reference &range);
+
+    /// <summary>
+    /// Returns true if cell comments won't be loaded.
+    /// </summary>
+    bool skip_comments() const;
+
+    /// <summary>
+    /// If skip is true, the comments parts of worksheets and their legacy
+    /// VML drawings aren't read.
+    /// </summary>
+    load_options &skip_comments(bool skip);
+
+    /// <summary>
+    /// Returns true if drawings and images won't be loaded.
+    /// </summary>
+    bool skip_drawings() const;
+
+    /// <summary>
+    /// If skip is true, worksheet drawings, the images they embed and the
+    /// package thumbnail aren't read.
+    /// </summary>
+    load_options &skip_drawings(bool skip);
+
+    /// <summary>
+    /// Returns true if document properties won't be loaded.
+    /// </summary>
+    bool skip_properties() const;
+
+    /// <summary>
+    /// If skip is true, the core, extended and custom document properties
+    /// aren't read.
+    /// </summary>
+    load_options &skip_properties(bool skip);
+
+    /// <summary>
+    /// Returns true if the theme won't be loaded.
+    /// </summary>
+    bool skip_themes() const;
+
+    /// <summary>
+    /// If skip is true, the workbook theme isn't read.
+    /// </summary>
+    load_options &skip_themes(bool skip);
+
+    /// <summary>
+    /// Returns true if only cell values will be loaded.
+    /// </summary>
+    bool values_only() const;
+
+    /// <summary>
+    /// If enabled is true, cell formulae and hyperlinks are dropped while
+    /// loading. Cells keep the values cached when the file was last calculated.
+    /// </summary>
+    load_options &values_only(bool enabled);
+
+    /// <summary>
+    /// Returns true if worksheets will be read when they're first accessed.
+    /// </summary>
+    bool lazy_worksheets() const;
+
+    /// <summary>
+    /// If enabled is true, load only reads the workbook part, styles and shared
+    /// strings. The archive is kept in memory and each worksheet is read the first
+    /// time it's accessed through the workbook, e.g. by workbook::sheet_by_title,
+    /// workbook::sheet_by_index or by iterating over the workbook. Saving or
+    /// copying the workbook reads any worksheets which haven't been accessed yet.
+    /// Worksheets may be accessed from several threads, also through the const
+    /// accessors, since the workbook reads one worksheet at a time.
+    /// </summary>
+    load_options &lazy_worksheets(bool enabled);
+
+    /// <summary>
+    /// Returns the size in bytes of the buffers parts of the archive are inflated through.
+    /// </summary>
+    std::size_t inflate_buffer_size() const;
+
+    /// <summary>
+    /// Sets the size of the buffers parts of the archive are inflated through,
+    /// 256 KiB by default. Sizes outside 64 KiB to 1 MiB are clamped to that range.
+    /// Parts of up to 4 MiB uncompressed are always inflated in a single block.
+    /// </summary>
+    load_options &inflate_buffer_size(std::size_t bytes);
+
+    /// <summary>
+    /// Returns the number of threads inflating parts ahead of the parser.
+    /// </summary>
+    std::size_t prefetch_threads() const;
+
+    /// <summary>
+    /// Sets the number of background threads which inflate the shared strings,
+    /// styles, theme and worksheet parts, in the order they're read, into a few
+    /// buffers each ahead of the parser. 0, the default, inflates each part on
+    /// the parsing thread as it's read. Worksheets parsed concurrently (see
+    /// worker_threads) are inflated by their own threads instead.
+    /// </summary>
+    load_options &prefetch_threads(std::size_t count);
+
+    /// <summary>
+    /// Returns true if cells will be allocated from an arena.
+    /// </summary>
+    bool cell_arena() const;
+
+    /// <summary>
+    /// If enabled is true, the cells of the loaded workbook, their rows and their
+    /// text values, formulae and hyperlinks are allocated in large blocks owned by
+    /// their worksheet. This makes loading and dropping the workbook, e.g. by clearing
+    /// it or loading another file into it, cheaper but memory freed by erasing
+    /// cells is only reused for new cells of the same worksheet until then.
+    /// Copies of the workbook allocate their cells separately.
+    /// </summary>
+    load_options &cell_arena(bool enabled);
+
+private:
+    /// <summary>
+    /// Maximum number of worksheet parsing threads, 0 for hardware concurrency.
+    /// </summary>
+    std::size_t worker_threads_;
+
+    /// <summary>
+    /// Titles of the worksheets to load.
+    /// </summary>
+    std::vector<std::string> sheet_titles_;
+
+    /// <summary>
+    /// Indices of the worksheets to load.
+    /// </summary>
+    std::vector<std::size_t> sheet_indices_;
+
+    /// <summary>
+    /// Cells to load from each worksheet.
+    /// </summary>
+    optional<range_reference> projection_;
+
+    /// <summary>
+    /// Don't read comments parts.
+    /// </summary>
+    bool skip_comments_;
+
+    /// <summary>
+    /// Don't read drawings, images or the thumbnail.
+    /// </summary>
+    bool skip_drawings_;
+
+    /// <summary>
+    /// Don't read document properties.
+    /// </summary>
+    bool skip_properties_;
+
+    /// <summary>
+    /// Don't read the theme.
+    /// </summary>
+    bool skip_themes_;
+
+    /// <summary>
+    /// Drop formulae and hyperlinks.
+    /// </summary>
+    bool values_only_;
+
+    /// <summary>
+    /// Defer reading worksheets until they're accessed.
+    /// </summary>
+    bool lazy_worksheets_;
+
+    /// <summary>
+    /// Size of the inflate buffers.
+    /// </summary>
+    std::size_t inflate_buffer_size_;
+
+    /// <summary>
+    /// Number of threads inflating parts ahead of the parser.
+    /// </summary>
+    std::size_t prefetch_threads_;
+
+    /// <summary>
+    /// Allocate cells from an arena owned by each worksheet.
+    /// </summary>
+    bool cell_arena_;
+};
+
+} // namespace xlnt
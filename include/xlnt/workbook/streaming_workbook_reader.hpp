@@ -41,6 +41,7 @@ class cell;
 template <typename T>
 class optional;
 class path;
+class range_reference;
 class workbook;
 class worksheet;
 
@@ -65,6 +66,15 @@ public:
 
     bool has_cell();
 
+    /// <summary>
+    /// If enabled is true, worksheets begun after this call are inflated on a
+    /// background thread into a small ring of large buffers ahead of has_cell()
+    /// and read_cell(), so inflating and parsing overlap. The buffers are
+    /// released and the thread stopped when the worksheet is replaced by the
+    /// next one or the reader is closed. Disabled by default.
+    /// </summary>
+    void read_ahead(bool enabled);
+
     /// <summary>
     /// Reads the next cell in the current worksheet and optionally returns it if
     /// the last cell in the sheet has not yet been read.
@@ -79,6 +89,13 @@ public:
     /// </summary>
     void begin_worksheet(const std::string &name);
 
+    /// <summary>
+    /// Begins reading of the worksheet with the given title like begin_worksheet(name)
+    /// but only cells within projection are returned by read_cell(). Rows and
+    /// cells outside of it are skipped without being constructed.
+    /// </summary>
+    void begin_worksheet(const std::string &name, const range_reference &projection);
+
     /// <summary>
     /// Ends reading of the current worksheet in the workbook and optionally
     /// returns a worksheet object corresponding to the worksheet with the title
@@ -138,6 +155,7 @@ private:
     std::unique_ptr<std::istream> part_stream_;
     std::unique_ptr<std::streambuf> part_stream_buffer_;
     std::unique_ptr<xml::parser> parser_;
+    bool read_ahead_;
 };
 
 } // namespace xlnt
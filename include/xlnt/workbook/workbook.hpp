@@ -53,6 +53,7 @@ class const_worksheet_iterator;
 class fill;
 class font;
 class format;
+class load_options;
 class rich_text;
 class manifest;
 class metadata_property;
@@ -158,6 +159,8 @@ public:
 
     /// <summary>
     /// Copy constructor. Constructs this workbook from existing workbook, other.
+    /// The cells and shared strings are shared with other and only copied,
+    /// a block of rows at a time, when either workbook changes them.
     /// </summary>
     workbook(const workbook &other);
 
@@ -187,7 +190,8 @@ public:
 
     /// <summary>
     /// Creates and returns a new sheet after the last sheet initializing it
-    /// with all of the data from the provided worksheet.
+    /// with all of the data from the provided worksheet. The cells are shared
+    /// with the provided worksheet until either of them changes them.
     /// </summary>
     worksheet copy_sheet(worksheet worksheet);
 
@@ -591,6 +595,43 @@ public:
     /// </summary>
     void load(std::istream &stream, const std::string &password);
 
+    /// <summary>
+    /// Interprets byte vector data as an XLSX file and sets the content of this
+    /// workbook to match that file, reading it according to options.
+    /// </summary>
+    void load(const std::vector<std::uint8_t> &data, const load_options &options);
+
+    /// <summary>
+    /// Interprets file with the given filename as an XLSX file and sets the
+    /// content of this workbook to match that file, reading it according to options.
+    /// </summary>
+    void load(const std::string &filename, const load_options &options);
+
+    /// <summary>
+    /// Interprets file with the given filename as an XLSX file and sets the
+    /// content of this workbook to match that file, reading it according to options.
+    /// </summary>
+    void load(const xlnt::path &filename, const load_options &options);
+
+    /// <summary>
+    /// Interprets data in stream as an XLSX file and sets the content of this
+    /// workbook to match that file, reading it according to options.
+    /// </summary>
+    void load(std::istream &stream, const load_options &options);
+
+    /// <summary>
+    /// Interprets the size bytes at data as an XLSX file and sets the content of
+    /// this workbook to match that file. The bytes are read in place without being
+    /// copied first and needn't outlive this call.
+    /// </summary>
+    void load(const void *data, std::size_t size);
+
+    /// <summary>
+    /// Interprets the size bytes at data as an XLSX file and sets the content of
+    /// this workbook to match that file, reading it according to options.
+    /// </summary>
+    void load(const void *data, std::size_t size, const load_options &options);
+
     // View
 
     /// <summary>
@@ -692,6 +733,15 @@ public:
     /// </summary>
     void clear_formats();
 
+    /// <summary>
+    /// Removes the formats which no cell uses any more and the fonts, fills,
+    /// borders, alignments and protections which no format or style uses,
+    /// renumbering those left. This is done when the workbook is saved after
+    /// cells have been restyled, so it's only needed to get the final format
+    /// indices earlier. Format objects of removed formats must not be used.
+    /// </summary>
+    void compact_styles();
+
     // Styles
 
     /// <summary>
@@ -774,13 +824,23 @@ public:
     std::size_t add_shared_string(const rich_text &shared, bool allow_duplicates = false);
 
     /// <summary>
-    /// Returns a reference to the shared string related to the specified index
+    /// Append an unformatted shared string like add_shared_string(rich_text).
+    /// Unlike that, looking up a string which is already in the collection
+    /// doesn't allocate.
     /// </summary>
-    const rich_text &shared_strings(std::size_t index) const;
+    std::size_t add_shared_string(const std::string &shared, bool allow_duplicates = false);
+
+    /// <summary>
+    /// Returns the shared string related to the specified index, or an empty
+    /// string if there's none. Unformatted strings are stored as plain text, so
+    /// this returns a copy built from the stored string.
+    /// </summary>
+    rich_text shared_strings(std::size_t index) const;
 
     /// <summary>
     /// Returns a reference to the shared strings being used by cells
-    /// in this workbook.
+    /// in this workbook. After this is called every shared string is kept
+    /// as rich_text, which takes considerably more memory.
     /// </summary>
     std::vector<rich_text> &shared_strings();
 
@@ -857,6 +917,7 @@ public:
     bool operator!=(const workbook &rhs) const;
 
 private:
+    friend class cell;
     friend class streaming_workbook_reader;
     friend class worksheet;
     friend class detail::xlsx_consumer;
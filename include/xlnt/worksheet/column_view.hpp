@@ -0,0 +1,187 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/cell/index_types.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// A read-only snapshot of the values of consecutive cells in a column, see
+/// worksheet::column_values. The values are held in a contiguous array with
+/// one element per row. Whether a row held a value of type T is recorded in
+/// a separate validity bitmap. Elements for rows which didn't, because the cell
+/// doesn't exist, is empty or holds another type, are zero, false or, for
+/// datetime, the datetime of serial number 0. Copies share the same immutable values.
+/// </summary>
+template <typename T>
+class column_view
+{
+public:
+    /// <summary>
+    /// Iterate over the values with a pointer.
+    /// </summary>
+    using const_iterator = const T *;
+
+    /// <summary>
+    /// Constructs an empty view.
+    /// </summary>
+    column_view()
+        : first_row_(1),
+          size_(0)
+    {
+    }
+
+    /// <summary>
+    /// Constructs a view of size values starting at first_row held in values
+    /// with validity bits held in validity, bit i % 8 of byte i / 8 for value i.
+    /// </summary>
+    column_view(row_t first_row, std::size_t size, std::shared_ptr<const T> values,
+        std::vector<std::uint8_t> validity)
+        : first_row_(first_row),
+          size_(size),
+          values_(std::move(values)),
+          validity_(std::move(validity))
+    {
+    }
+
+    /// <summary>
+    /// Returns the row of the first value.
+    /// </summary>
+    row_t first_row() const
+    {
+        return first_row_;
+    }
+
+    /// <summary>
+    /// Returns the number of values, one per row.
+    /// </summary>
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+    /// <summary>
+    /// Returns true if the view has no rows.
+    /// </summary>
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    /// <summary>
+    /// Returns the contiguous array of size() values.
+    /// </summary>
+    const T *data() const
+    {
+        return values_.get();
+    }
+
+    /// <summary>
+    /// Returns the value of row first_row() + index.
+    /// </summary>
+    const T &operator[](std::size_t index) const
+    {
+        return values_.get()[index];
+    }
+
+    /// <summary>
+    /// Returns true if row first_row() + index held a value of type T.
+    /// </summary>
+    bool valid(std::size_t index) const
+    {
+        return (validity_[index / 8] >> (index % 8) & 1) != 0;
+    }
+
+    /// <summary>
+    /// Returns the validity bitmap, bit i % 8 of byte i / 8 is set if value i is valid.
+    /// </summary>
+    const std::uint8_t *validity() const
+    {
+        return validity_.data();
+    }
+
+    /// <summary>
+    /// Returns the number of valid values.
+    /// </summary>
+    std::size_t valid_count() const
+    {
+        std::size_t count = 0;
+
+        for (auto byte : validity_)
+        {
+            for (; byte != 0; byte &= static_cast<std::uint8_t>(byte - 1))
+            {
+                ++count;
+            }
+        }
+
+        return count;
+    }
+
+    /// <summary>
+    /// Returns a pointer to the first value.
+    /// </summary>
+    const_iterator begin() const
+    {
+        return data();
+    }
+
+    /// <summary>
+    /// Returns a pointer one past the last value.
+    /// </summary>
+    const_iterator end() const
+    {
+        return data() + size_;
+    }
+
+private:
+    /// <summary>
+    /// The row of the first value.
+    /// </summary>
+    row_t first_row_;
+
+    /// <summary>
+    /// The number of values.
+    /// </summary>
+    std::size_t size_;
+
+    /// <summary>
+    /// The array of values.
+    /// </summary>
+    std::shared_ptr<const T> values_;
+
+    /// <summary>
+    /// One bit per value, set if the value is valid.
+    /// </summary>
+    std::vector<std::uint8_t> validity_;
+};
+
+} // namespace xlnt
@@ -291,6 +291,13 @@ public:
     bool operator!=(const range &comparand) const;
 
 private:
+    /// <summary>
+    /// Calls change with the first cell of each distinct format in the range
+    /// and gives the other cells with that format the format it ended up
+    /// with, so that each distinct format is only derived once.
+    /// </summary>
+    range restyle(const std::function<void(class cell)> &change);
+
     /// <summary>
     /// The worksheet this range is within
     /// </summary>
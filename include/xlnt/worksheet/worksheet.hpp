@@ -33,6 +33,8 @@
 #include <xlnt/xlnt_config.hpp>
 #include <xlnt/cell/index_types.hpp>
 #include <xlnt/packaging/relationship.hpp>
+#include <xlnt/worksheet/column_view.hpp>
+#include <xlnt/worksheet/major_order.hpp>
 #include <xlnt/worksheet/page_margins.hpp>
 #include <xlnt/worksheet/page_setup.hpp>
 #include <xlnt/worksheet/sheet_view.hpp>
@@ -55,10 +57,12 @@ class range_reference;
 class relationship;
 class row_properties;
 class sheet_format_properties;
+class variant;
 class workbook;
 class phonetic_pr;
 
 struct date;
+struct datetime;
 
 namespace detail {
 
@@ -254,6 +258,66 @@ public:
     /// </summary>
     const class range columns(bool skip_null = true) const;
 
+    /// <summary>
+    /// Returns the cells stored in this sheet in row-major or column-major
+    /// order. Unlike iterating rows() or columns(), only the stored cells are
+    /// visited, so the cost doesn't depend on how far apart they are.
+    /// </summary>
+    std::vector<class cell> stored_cells(major_order order = major_order::row);
+
+    /// <summary>
+    /// Returns the cells stored in this sheet in row-major or column-major
+    /// order. Unlike iterating rows() or columns(), only the stored cells are
+    /// visited, so the cost doesn't depend on how far apart they are.
+    /// </summary>
+    const std::vector<class cell> stored_cells(major_order order = major_order::row) const;
+
+    /// <summary>
+    /// Returns the values of the cells in column from first_row to last_row,
+    /// inclusive, as a contiguous array. A value is valid if its cell holds a
+    /// number, or a boolean for column_view<bool>. Integers are truncated towards
+    /// zero and datetimes are relative to the base date of the workbook. Numbers
+    /// that don't fit, e.g. NaN or 1e30 as an integer or a negative number as a
+    /// datetime, are invalid.
+    /// Specialized for double, std::int64_t, bool and datetime.
+    /// </summary>
+    template <typename T>
+    column_view<T> column_values(column_t column, row_t first_row, row_t last_row) const;
+
+    /// <summary>
+    /// Returns the values of the cells in column from lowest_row() to highest_row().
+    /// </summary>
+    template <typename T>
+    column_view<T> column_values(column_t column) const
+    {
+        return column_values<T>(column, lowest_row(), highest_row());
+    }
+
+    /// <summary>
+    /// Sets the cells of range to the count numbers in values, given in
+    /// row-major order, creating the cells which don't exist. Like
+    /// cell::value(double), formats and formulae of the cells are kept.
+    /// Throws xlnt::invalid_parameter if count isn't the number of cells in range.
+    /// </summary>
+    void assign(const range_reference &range, const double *values, std::size_t count);
+
+    /// <summary>
+    /// Sets the cells of consecutive rows starting at top_left to the values of
+    /// each row of rows. Null variants clear the value of existing cells and
+    /// don't create new ones, i4 and r8 variants set numbers, bool variants set
+    /// booleans, lpstr variants set shared strings and date variants set datetimes
+    /// like cell::value(datetime). Throws xlnt::invalid_parameter for vector variants.
+    /// </summary>
+    void assign(const cell_reference &top_left, const std::vector<std::vector<variant>> &rows);
+
+    /// <summary>
+    /// Reads the numbers of the cells of range into the count elements of values
+    /// in row-major order. Elements for cells which don't hold a number are set
+    /// to quiet NaN. Throws xlnt::invalid_parameter if count isn't the number of
+    /// cells in range.
+    /// </summary>
+    void extract(const range_reference &range, double *values, std::size_t count) const;
+
     //TODO: finish implementing cell_iterator wrapping before uncommenting
     //class cell_vector cells(bool skip_null = true);
 
@@ -795,6 +859,8 @@ public:
 
 private:
     friend class cell;
+    friend class cell_iterator;
+    friend class const_cell_iterator;
     friend class const_range_iterator;
     friend class range_iterator;
     friend class workbook;
@@ -832,10 +898,50 @@ private:
     /// </summary>
     void move_cells(std::uint32_t index, std::uint32_t amount, row_or_col_t row_or_col, bool reverse = false);
 
+    /// <summary>
+    /// Returns the first stored cell within bounds at or after cursor along its
+    /// row if order is major_order::row, or along its column otherwise. If
+    /// there's none, returns the reference one past the end of the row or column.
+    /// </summary>
+    cell_reference next_stored_cell(const cell_reference &cursor, const range_reference &bounds, major_order order) const;
+
+    /// <summary>
+    /// Returns the last stored cell within bounds at or before cursor along its
+    /// row if order is major_order::row, or along its column otherwise. If
+    /// there's none, returns the first reference of the row or column.
+    /// </summary>
+    cell_reference previous_stored_cell(const cell_reference &cursor, const range_reference &bounds, major_order order) const;
+
+    /// <summary>
+    /// Returns the first row (major_order::row) or column at or after cursor
+    /// which has a stored cell within bounds, or the one after the last row
+    /// or column of bounds if there's none.
+    /// </summary>
+    cell_reference next_stored_vector(const cell_reference &cursor, const range_reference &bounds, major_order order) const;
+
+    /// <summary>
+    /// Returns the last row (major_order::row) or column at or before cursor
+    /// which has a stored cell within bounds, or the first row or column of
+    /// bounds if there's none.
+    /// </summary>
+    cell_reference previous_stored_vector(const cell_reference &cursor, const range_reference &bounds, major_order order) const;
+
     /// <summary>
     /// The pointer to this sheet's implementation.
     /// </summary>
     detail::worksheet_impl *d_;
 };
 
+template <>
+column_view<double> worksheet::column_values<double>(column_t column, row_t first_row, row_t last_row) const;
+
+template <>
+column_view<std::int64_t> worksheet::column_values<std::int64_t>(column_t column, row_t first_row, row_t last_row) const;
+
+template <>
+column_view<bool> worksheet::column_values<bool>(column_t column, row_t first_row, row_t last_row) const;
+
+template <>
+column_view<datetime> worksheet::column_values<datetime>(column_t column, row_t first_row, row_t last_row) const;
+
 } // namespace xlnt
@@ -64,6 +64,7 @@
 // workbook
 #include <xlnt/workbook/document_security.hpp>
 #include <xlnt/workbook/external_book.hpp>
+#include <xlnt/workbook/load_options.hpp>
 #include <xlnt/workbook/metadata_property.hpp>
 #include <xlnt/workbook/named_range.hpp>
 #include <xlnt/workbook/streaming_workbook_reader.hpp>
@@ -76,6 +77,7 @@
 #include <xlnt/worksheet/cell_iterator.hpp>
 #include <xlnt/worksheet/cell_vector.hpp>
 #include <xlnt/worksheet/column_properties.hpp>
+#include <xlnt/worksheet/column_view.hpp>
 #include <xlnt/worksheet/header_footer.hpp>
 #include <xlnt/worksheet/major_order.hpp>
 #include <xlnt/worksheet/page_margins.hpp>
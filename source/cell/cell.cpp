@@ -56,11 +56,39 @@
 #include <detail/implementations/format_impl.hpp>
 #include <detail/implementations/hyperlink_impl.hpp>
 #include <detail/implementations/stylesheet.hpp>
+#include <detail/implementations/workbook_impl.hpp>
 #include <detail/implementations/worksheet_impl.hpp>
+#include <detail/number_format/number_formatter.hpp>
 #include <xlnt/utils/numeric.hpp>
 
 namespace {
 
+// Must be called before the cell is changed. If copies of its worksheet may
+// share the cell, d is replaced by the worksheet's own copy of it.
+void detach(xlnt::detail::cell_impl *&d, xlnt::detail::worksheet_impl *parent)
+{
+    if (parent != nullptr)
+    {
+        d = parent->cells_.detach(d);
+    }
+}
+
+// max string length in Excel
+const std::size_t max_string_length = 32767;
+
+// Throws illegal_character if s has a control character which isn't allowed
+// in a cell.
+void check_characters(const std::string &s)
+{
+    for (char c : s)
+    {
+        if (c >= 0 && (c <= 8 || c == 11 || c == 12 || (c >= 14 && c <= 31)))
+        {
+            throw xlnt::illegal_character(c);
+        }
+    }
+}
+
 std::pair<bool, double> cast_numeric(const std::string &s)
 {
     xlnt::detail::number_serialiser ser;
@@ -175,24 +203,19 @@ std::string cell::check_string(const std::string &to_check)
     {
         return s;
     }
-    else if (s.size() > 32767)
+    else if (s.size() > max_string_length)
     {
-        s = s.substr(0, 32767); // max string length in Excel
+        s = s.substr(0, max_string_length);
     }
 
-    for (char c : s)
-    {
-        if (c >= 0 && (c <= 8 || c == 11 || c == 12 || (c >= 14 && c <= 31)))
-        {
-            throw illegal_character(c);
-        }
-    }
+    check_characters(s);
 
     return s;
 }
 
-cell::cell(detail::cell_impl *d)
-    : d_(d)
+cell::cell(detail::cell_impl *d, detail::worksheet_impl *parent)
+    : d_(d),
+      parent_(parent)
 {
 }
 
@@ -208,53 +231,72 @@ void cell::value(std::nullptr_t)
 
 void cell::value(bool boolean_value)
 {
+    detach(d_, parent_);
     d_->type_ = type::boolean;
     d_->value_numeric_ = boolean_value ? 1.0 : 0.0;
 }
 
 void cell::value(int int_value)
 {
+    detach(d_, parent_);
     d_->value_numeric_ = static_cast<double>(int_value);
     d_->type_ = type::number;
 }
 
 void cell::value(unsigned int int_value)
 {
+    detach(d_, parent_);
     d_->value_numeric_ = static_cast<double>(int_value);
     d_->type_ = type::number;
 }
 
 void cell::value(long long int int_value)
 {
+    detach(d_, parent_);
     d_->value_numeric_ = static_cast<double>(int_value);
     d_->type_ = type::number;
 }
 
 void cell::value(unsigned long long int int_value)
 {
+    detach(d_, parent_);
     d_->value_numeric_ = static_cast<double>(int_value);
     d_->type_ = type::number;
 }
 
 void cell::value(float float_value)
 {
+    detach(d_, parent_);
     d_->value_numeric_ = static_cast<double>(float_value);
     d_->type_ = type::number;
 }
 
 void cell::value(double float_value)
 {
+    detach(d_, parent_);
     d_->value_numeric_ = static_cast<double>(float_value);
     d_->type_ = type::number;
 }
 
 void cell::value(const std::string &s)
 {
-    value(rich_text(check_string(s)));
+    if (s.size() > max_string_length)
+    {
+        value(check_string(s));
+        return;
+    }
+
+    detach(d_, parent_);
+    // checked in place so that adding a string which is already shared doesn't copy it
+    check_characters(s);
+
+    d_->type_ = type::shared_string;
+    d_->value_numeric_ = static_cast<double>(workbook().add_shared_string(s));
 }
 
 void cell::value(const rich_text &text)
 {
+    detach(d_, parent_);
     check_string(text.plain_text());
 
     d_->type_ = type::shared_string;
@@ -268,16 +310,23 @@ void cell::value(const char *c)
 
 void cell::value(const cell c)
 {
+    detach(d_, parent_);
     d_->type_ = c.d_->type_;
     d_->value_numeric_ = c.d_->value_numeric_;
-    d_->value_text_ = c.d_->value_text_;
-    d_->hyperlink_ = c.d_->hyperlink_;
-    d_->formula_ = c.d_->formula_;
-    d_->format_ = c.d_->format_;
+    if (c.d_->extras_ != nullptr)
+    {
+        d_->extras() = *c.d_->extras_;
+    }
+    else
+    {
+        d_->reset_extras();
+    }
+    detail::stylesheet::restyle(*d_, c.d_->format_);
 }
 
 void cell::value(const date &d)
 {
+    detach(d_, parent_);
     d_->type_ = type::number;
     d_->value_numeric_ = d.to_number(base_date());
     number_format(number_format::date_yyyymmdd2());
@@ -285,6 +334,7 @@ void cell::value(const date &d)
 
 void cell::value(const datetime &d)
 {
+    detach(d_, parent_);
     d_->type_ = type::number;
     d_->value_numeric_ = d.to_number(base_date());
     number_format(number_format::date_datetime());
@@ -292,6 +342,7 @@ void cell::value(const datetime &d)
 
 void cell::value(const time &t)
 {
+    detach(d_, parent_);
     d_->type_ = type::number;
     d_->value_numeric_ = t.to_number();
     number_format(number_format::date_time6());
@@ -299,6 +350,7 @@ void cell::value(const time &t)
 
 void cell::value(const timedelta &t)
 {
+    detach(d_, parent_);
     d_->type_ = type::number;
     d_->value_numeric_ = t.to_number();
     number_format(xlnt::number_format("[hh]:mm:ss"));
@@ -316,11 +368,12 @@ column_t cell::column() const
 
 column_t::index_t cell::column_index() const
 {
-    return d_->column_.index;
+    return d_->column_;
 }
 
 void cell::merged(bool merged)
 {
+    detach(d_, parent_);
     d_->is_merged_ = merged;
 }
 
@@ -336,6 +389,7 @@ bool cell::phonetics_visible() const
 
 void cell::show_phonetics(bool phonetics)
 {
+    detach(d_, parent_);
     d_->phonetics_visible_ = phonetics;
 }
 
@@ -365,11 +419,17 @@ cell &cell::operator=(const cell &rhs) = default;
 
 hyperlink cell::hyperlink() const
 {
-    return xlnt::hyperlink(&d_->hyperlink_.get());
+    if (!has_hyperlink())
+    {
+        throw invalid_attribute();
+    }
+
+    return xlnt::hyperlink(&d_->extras_->hyperlink.get());
 }
 
 void cell::hyperlink(const std::string &url, const std::string &display)
 {
+    detach(d_, parent_);
     if (url.empty())
     {
         throw invalid_parameter();
@@ -378,7 +438,8 @@ void cell::hyperlink(const std::string &url, const std::string &display)
     auto ws = worksheet();
     auto &manifest = ws.workbook().manifest();
 
-    d_->hyperlink_ = detail::hyperlink_impl();
+    auto &cell_hyperlink = d_->extras().hyperlink;
+    cell_hyperlink = detail::hyperlink_impl();
 
     // check for existing relationships
     auto relationships = manifest.relationships(ws.path(), relationship_type::hyperlink);
@@ -386,7 +447,7 @@ void cell::hyperlink(const std::string &url, const std::string &display)
         [&url](xlnt::relationship rel) { return rel.target().path().string() == url; });
     if (relation != relationships.end())
     {
-        d_->hyperlink_.get().relationship = *relation;
+        cell_hyperlink.get().relationship = *relation;
     }
     else
     { // register a new relationship
@@ -396,63 +457,68 @@ void cell::hyperlink(const std::string &url, const std::string &display)
             uri(url),
             target_mode::external);
         // TODO: make manifest::register_relationship return the created relationship instead of rel id
-        d_->hyperlink_.get().relationship = manifest.relationship(ws.path(), rel_id);
+        cell_hyperlink.get().relationship = manifest.relationship(ws.path(), rel_id);
     }
     // if a value is already present, the display string is ignored
     if (has_value())
     {
-        d_->hyperlink_.get().display.set(to_string());
+        cell_hyperlink.get().display.set(to_string());
     }
     else
     {
-        d_->hyperlink_.get().display.set(display.empty() ? url : display);
+        cell_hyperlink.get().display.set(display.empty() ? url : display);
         value(hyperlink().display());
     }
 }
 
 void cell::hyperlink(xlnt::cell target, const std::string &display)
 {
+    detach(d_, parent_);
     // TODO: should this computed value be a method on a cell?
     const auto cell_address = target.worksheet().title() + "!" + target.reference().to_string();
 
-    d_->hyperlink_ = detail::hyperlink_impl();
-    d_->hyperlink_.get().relationship = xlnt::relationship("", relationship_type::hyperlink,
+    auto &cell_hyperlink = d_->extras().hyperlink;
+    cell_hyperlink = detail::hyperlink_impl();
+    cell_hyperlink.get().relationship = xlnt::relationship("", relationship_type::hyperlink,
         uri(""), uri(cell_address), target_mode::internal);
     // if a value is already present, the display string is ignored
     if (has_value())
     {
-        d_->hyperlink_.get().display.set(to_string());
+        cell_hyperlink.get().display.set(to_string());
     }
     else
     {
-        d_->hyperlink_.get().display.set(display.empty() ? cell_address : display);
+        cell_hyperlink.get().display.set(display.empty() ? cell_address : display);
         value(hyperlink().display());
     }
 }
 
 void cell::hyperlink(xlnt::range target, const std::string &display)
 {
+    detach(d_, parent_);
     // TODO: should this computed value be a method on a cell?
     const auto range_address = target.target_worksheet().title() + "!" + target.reference().to_string();
 
-    d_->hyperlink_ = detail::hyperlink_impl();
-    d_->hyperlink_.get().relationship = xlnt::relationship("", relationship_type::hyperlink,
+    auto &cell_hyperlink = d_->extras().hyperlink;
+    cell_hyperlink = detail::hyperlink_impl();
+    cell_hyperlink.get().relationship = xlnt::relationship("", relationship_type::hyperlink,
         uri(""), uri(range_address), target_mode::internal);
 
     // if a value is already present, the display string is ignored
     if (has_value())
     {
-        d_->hyperlink_.get().display.set(to_string());
+        cell_hyperlink.get().display.set(to_string());
     }
     else
     {
-        d_->hyperlink_.get().display.set(display.empty() ? range_address : display);
+        cell_hyperlink.get().display.set(display.empty() ? range_address : display);
         value(hyperlink().display());
     }
 }
 
 void cell::formula(const std::string &formula)
 {
+    detach(d_, parent_);
     if (formula.empty())
     {
         return clear_formula();
@@ -460,11 +526,11 @@ void cell::formula(const std::string &formula)
 
     if (formula[0] == '=')
     {
-        d_->formula_ = formula.substr(1);
+        d_->extras().formula = formula.substr(1);
     }
     else
     {
-        d_->formula_ = formula;
+        d_->extras().formula = formula;
     }
 
     worksheet().register_calc_chain_in_manifest();
@@ -472,19 +538,26 @@ void cell::formula(const std::string &formula)
 
 bool cell::has_formula() const
 {
-    return d_->formula_.is_set();
+    return d_->has_formula();
 }
 
 std::string cell::formula() const
 {
-    return d_->formula_.get();
+    if (!has_formula())
+    {
+        throw invalid_attribute();
+    }
+
+    return d_->extras_->formula.get();
 }
 
 void cell::clear_formula()
 {
+    detach(d_, parent_);
     if (has_formula())
     {
-        d_->formula_.clear();
+        d_->extras_->formula.clear();
+        d_->trim_extras();
         worksheet().garbage_collect_formulae();
     }
 }
@@ -500,12 +573,13 @@ std::string cell::error() const
 
 void cell::error(const std::string &error)
 {
+    detach(d_, parent_);
     if (error.length() == 0 || error[0] != '#')
     {
         throw invalid_data_type();
     }
 
-    d_->value_text_.plain_text(error, false);
+    d_->extras().value_text.plain_text(error, false);
     d_->type_ = type::error;
 }
 
@@ -516,12 +590,12 @@ cell cell::offset(int column, int row)
 
 worksheet cell::worksheet()
 {
-    return xlnt::worksheet(d_->parent_);
+    return xlnt::worksheet(parent_);
 }
 
 const worksheet cell::worksheet() const
 {
-    return xlnt::worksheet(d_->parent_);
+    return xlnt::worksheet(parent_);
 }
 
 workbook &cell::workbook()
@@ -560,6 +634,7 @@ cell::type cell::data_type() const
 
 void cell::data_type(type t)
 {
+    detach(d_, parent_);
     d_->type_ = t;
 }
 
@@ -595,8 +670,13 @@ protection cell::computed_protection() const
 
 void cell::clear_value()
 {
+    detach(d_, parent_);
     d_->value_numeric_ = 0;
-    d_->value_text_.clear();
+    if (d_->extras_)
+    {
+        d_->extras_->value_text.clear();
+        d_->trim_extras();
+    }
     d_->type_ = cell::type::empty;
     clear_formula();
 }
@@ -706,7 +786,15 @@ void cell::protection(const class protection &protection_)
 template <>
 XLNT_API std::string cell::value() const
 {
-    return value<rich_text>().plain_text();
+    if (data_type() == cell::type::shared_string)
+    {
+        const auto &strings = *workbook().d_->shared_strings_;
+        const auto index = static_cast<std::size_t>(d_->value_numeric_);
+
+        return index < strings.size() ? strings.plain_text(index) : std::string();
+    }
+
+    return d_->value_text().plain_text();
 }
 
 template <>
@@ -714,10 +802,13 @@ XLNT_API rich_text cell::value() const
 {
     if (data_type() == cell::type::shared_string)
     {
-        return workbook().shared_strings(static_cast<std::size_t>(d_->value_numeric_));
+        const auto &strings = *workbook().d_->shared_strings_;
+        const auto index = static_cast<std::size_t>(d_->value_numeric_);
+
+        return index < strings.size() ? strings.value(index) : rich_text();
     }
 
-    return d_->value_text_;
+    return d_->value_text();
 }
 
 bool cell::has_value() const
@@ -727,7 +818,10 @@ bool cell::has_value() const
 
 std::string cell::to_string() const
 {
-    auto nf = computed_number_format();
+    // compiled once for the workbook rather than parsed on every call
+    auto compiled_number_format = [this]() {
+        return workbook().d_->stylesheet_.get().compiled_number_formats.get(computed_number_format());
+    };
 
     switch (data_type())
     {
@@ -735,12 +829,12 @@ std::string cell::to_string() const
         return "";
     case cell::type::date:
     case cell::type::number:
-        return nf.format(value<double>(), base_date());
+        return detail::number_formatter(compiled_number_format(), base_date()).format_number(value<double>());
     case cell::type::inline_string:
     case cell::type::shared_string:
     case cell::type::formula_string:
     case cell::type::error:
-        return nf.format(value<std::string>());
+        return detail::number_formatter(compiled_number_format(), calendar::windows_1900).format_text(value<std::string>());
     case cell::type::boolean:
         return value<double>() == 0.0 ? "FALSE" : "TRUE";
     }
@@ -750,18 +844,13 @@ std::string cell::to_string() const
 
 bool cell::has_format() const
 {
-    return d_->format_.is_set();
+    return d_->format_ != nullptr;
 }
 
 void cell::format(const class format new_format)
 {
-    if (has_format())
-    {
-        format().d_->references -= format().d_->references > 0 ? 1 : 0;
-    }
-
-    ++new_format.d_->references;
-    d_->format_ = new_format.d_;
+    detach(d_, parent_);
+    detail::stylesheet::restyle(*d_, new_format.d_);
 }
 
 calendar cell::base_date() const
@@ -838,11 +927,8 @@ void cell::value(const std::string &value_string, bool infer_type)
 
 void cell::clear_format()
 {
-    if (d_->format_.is_set())
-    {
-        format().d_->references -= format().d_->references > 0 ? 1 : 0;
-        d_->format_.clear();
-    }
+    detach(d_, parent_);
+    detail::stylesheet::restyle(*d_, nullptr);
 }
 
 void cell::clear_style()
@@ -899,22 +985,22 @@ bool cell::has_style() const
 
 format cell::modifiable_format()
 {
-    if (!d_->format_.is_set())
+    if (d_->format_ == nullptr)
     {
         throw invalid_attribute();
     }
 
-    return xlnt::format(d_->format_.get());
+    return xlnt::format(d_->format_);
 }
 
 const format cell::format() const
 {
-    if (!d_->format_.is_set())
+    if (d_->format_ == nullptr)
     {
         throw invalid_attribute();
     }
 
-    return xlnt::format(d_->format_.get());
+    return xlnt::format(d_->format_);
 }
 
 alignment cell::alignment() const
@@ -949,22 +1035,23 @@ protection cell::protection() const
 
 bool cell::has_hyperlink() const
 {
-    return d_->hyperlink_.is_set();
+    return d_->has_hyperlink();
 }
 
 // comment
 
 bool cell::has_comment()
 {
-    return d_->comment_.is_set();
+    return d_->has_comment_;
 }
 
 void cell::clear_comment()
 {
+    detach(d_, parent_);
     if (has_comment())
     {
-        d_->parent_->comments_.erase(reference().to_string());
-        d_->comment_.clear();
+        parent_->comments_.erase(reference().to_string());
+        d_->has_comment_ = false;
     }
 }
 
@@ -975,7 +1062,7 @@ class comment cell::comment()
         throw xlnt::exception("cell has no comment");
     }
 
-    return *d_->comment_.get();
+    return parent_->comments_.at(reference().to_string());
 }
 
 void cell::comment(const std::string &text, const std::string &author)
@@ -990,22 +1077,17 @@ void cell::comment(const std::string &text, const class font &comment_font, cons
 
 void cell::comment(const class comment &new_comment)
 {
-    if (has_comment())
-    {
-        *d_->comment_.get() = new_comment;
-    }
-    else
-    {
-        d_->parent_->comments_[reference().to_string()] = new_comment;
-        d_->comment_.set(&d_->parent_->comments_[reference().to_string()]);
-    }
+    detach(d_, parent_);
+    auto &cell_comment = parent_->comments_[reference().to_string()];
+    cell_comment = new_comment;
+    d_->has_comment_ = true;
 
     // offset comment 5 pixels down and 5 pixels right of the top right corner of the cell
     auto cell_position = anchor();
     cell_position.first += static_cast<int>(width()) + 5;
     cell_position.second += 5;
 
-    d_->comment_.get()->position(cell_position.first, cell_position.second);
+    cell_comment.position(cell_position.first, cell_position.second);
 
     worksheet().register_comments_in_manifest();
 }
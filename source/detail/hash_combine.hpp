@@ -0,0 +1,81 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+#include <xlnt/utils/optional.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Mixes value into seed like boost::hash_combine.
+/// </summary>
+inline void hash_combine(std::size_t &seed, std::size_t value)
+{
+    seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+/// <summary>
+/// Mixes value into seed. 0.0 and -0.0 compare equal, so they're mixed in
+/// the same way.
+/// </summary>
+inline void hash_combine(std::size_t &seed, double value)
+{
+    hash_combine(seed, value == 0.0 ? std::size_t(0) : std::hash<double>()(value));
+}
+
+/// <summary>
+/// Mixes whether value is set and if it is, its value into seed. Enums are
+/// hashed through their underlying value since std::hash doesn't accept them
+/// before C++14.
+/// </summary>
+template <typename T>
+void hash_combine(std::size_t &seed, const optional<T> &value)
+{
+    hash_combine(seed, static_cast<std::size_t>(value.is_set()));
+
+    if (value.is_set())
+    {
+        hash_combine(seed, static_cast<std::size_t>(value.get()));
+    }
+}
+
+/// <summary>
+/// Mixes whether value is set and if it is, its value into seed.
+/// </summary>
+inline void hash_combine(std::size_t &seed, const optional<double> &value)
+{
+    hash_combine(seed, static_cast<std::size_t>(value.is_set()));
+
+    if (value.is_set())
+    {
+        hash_combine(seed, value.get());
+    }
+}
+
+} // namespace detail
+} // namespace xlnt
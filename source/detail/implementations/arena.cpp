@@ -0,0 +1,99 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <algorithm>
+#include <cstdint>
+
+#include <detail/implementations/arena.hpp>
+
+namespace {
+
+const std::size_t first_block_size = 64 * 1024;
+const std::size_t max_block_size = 4 * 1024 * 1024;
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+arena::arena()
+    : next_(nullptr),
+      remaining_(0),
+      block_size_(first_block_size),
+      capacity_(0)
+{
+}
+
+arena::~arena()
+{
+}
+
+void *arena::allocate(std::size_t size, std::size_t alignment)
+{
+    auto freed = free_.find(size);
+
+    if (freed != free_.end() && !freed->second.empty()
+        && reinterpret_cast<std::uintptr_t>(freed->second.back()) % alignment == 0)
+    {
+        auto result = freed->second.back();
+        freed->second.pop_back();
+
+        return result;
+    }
+
+    auto padding = (alignment - reinterpret_cast<std::uintptr_t>(next_) % alignment) % alignment;
+
+    if (padding + size > remaining_)
+    {
+        // blocks from new[] are aligned for any fundamental type
+        auto block_size = std::max(size, block_size_);
+        blocks_.emplace_back(new char[block_size]);
+        next_ = blocks_.back().get();
+        remaining_ = block_size;
+        capacity_ += block_size;
+        block_size_ = std::min(block_size_ * 2, max_block_size);
+        padding = 0;
+    }
+
+    auto result = next_ + padding;
+    next_ = result + size;
+    remaining_ -= padding + size;
+
+    return result;
+}
+
+void arena::deallocate(void *pointer, std::size_t size)
+{
+    if (pointer != nullptr && size > 0)
+    {
+        free_[size].push_back(pointer);
+    }
+}
+
+std::size_t arena::capacity() const
+{
+    return capacity_;
+}
+
+} // namespace detail
+} // namespace xlnt
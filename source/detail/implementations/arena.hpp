@@ -0,0 +1,150 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// A monotonic allocator which hands out memory from a list of blocks. Memory
+/// is returned all at once when the arena is destroyed, so objects allocated
+/// from it must either be trivially destructible or be destroyed by their
+/// owner. Memory given back with deallocate is only reused for allocations of
+/// the same size, such as the buffers a growing vector leaves behind. An arena
+/// isn't thread safe, so each worksheet has its own.
+/// </summary>
+class arena
+{
+public:
+    arena();
+    ~arena();
+
+    arena(const arena &) = delete;
+    arena &operator=(const arena &) = delete;
+
+    /// <summary>
+    /// Returns size bytes aligned to alignment, which must be a power of two
+    /// no larger than alignof(std::max_align_t).
+    /// </summary>
+    void *allocate(std::size_t size, std::size_t alignment);
+
+    /// <summary>
+    /// Makes size bytes at pointer, which were returned by allocate, available
+    /// to a later allocation of the same size.
+    /// </summary>
+    void deallocate(void *pointer, std::size_t size);
+
+    /// <summary>
+    /// Returns the number of bytes held in blocks.
+    /// </summary>
+    std::size_t capacity() const;
+
+private:
+    std::vector<std::unique_ptr<char[]>> blocks_;
+
+    /// <summary>
+    /// Memory given back with deallocate by size.
+    /// </summary>
+    std::unordered_map<std::size_t, std::vector<void *>> free_;
+    char *next_;
+    std::size_t remaining_;
+    std::size_t block_size_;
+    std::size_t capacity_;
+};
+
+/// <summary>
+/// A standard allocator which allocates from an arena or, if it has none,
+/// from the heap. Deallocating arena memory does nothing.
+/// </summary>
+template <typename T>
+class arena_allocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    arena_allocator(arena *source = nullptr)
+        : arena_(source)
+    {
+    }
+
+    template <typename U>
+    arena_allocator(const arena_allocator<U> &other)
+        : arena_(other.source())
+    {
+    }
+
+    T *allocate(std::size_t count)
+    {
+        if (arena_ == nullptr)
+        {
+            return static_cast<T *>(::operator new(count * sizeof(T)));
+        }
+
+        return static_cast<T *>(arena_->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *pointer, std::size_t count)
+    {
+        if (arena_ == nullptr)
+        {
+            ::operator delete(pointer);
+        }
+        else
+        {
+            arena_->deallocate(pointer, count * sizeof(T));
+        }
+    }
+
+    arena *source() const
+    {
+        return arena_;
+    }
+
+private:
+    arena *arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const arena_allocator<T> &lhs, const arena_allocator<U> &rhs)
+{
+    return lhs.source() == rhs.source();
+}
+
+template <typename T, typename U>
+bool operator!=(const arena_allocator<T> &lhs, const arena_allocator<U> &rhs)
+{
+    return lhs.source() != rhs.source();
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -25,20 +25,132 @@
 #include <xlnt/worksheet/worksheet.hpp>
 
 #include <detail/implementations/cell_impl.hpp>
+#include <detail/implementations/worksheet_impl.hpp>
 
 namespace xlnt {
 namespace detail {
 
-cell_impl::cell_impl()
-    : type_(cell_type::empty),
-      parent_(nullptr),
-      column_(1),
-      row_(1),
-      is_merged_(false),
-      phonetics_visible_(false),
-      value_numeric_(0)
+cell_impl::cell_impl(const cell_impl &other)
+    : parent_(other.parent_),
+      value_numeric_(other.value_numeric_),
+      format_(other.format_),
+      extras_(other.extras_ ? new cell_extras(*other.extras_) : nullptr),
+      column_(other.column_),
+      row_(other.row_),
+      type_(other.type_),
+      is_merged_(other.is_merged_),
+      phonetics_visible_(other.phonetics_visible_),
+      has_comment_(other.has_comment_),
+      pooled_extras_(false)
 {
 }
 
+cell_impl::cell_impl(cell_impl &&other)
+    : cell_impl()
+{
+    *this = std::move(other);
+}
+
+cell_impl &cell_impl::operator=(const cell_impl &other)
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    // copies always own their extras, cell_store::adopt moves them into an arena
+    auto extras = other.extras_ ? new cell_extras(*other.extras_) : nullptr;
+    reset_extras();
+    extras_ = extras;
+
+    parent_ = other.parent_;
+    value_numeric_ = other.value_numeric_;
+    format_ = other.format_;
+    column_ = other.column_;
+    row_ = other.row_;
+    type_ = other.type_;
+    is_merged_ = other.is_merged_;
+    phonetics_visible_ = other.phonetics_visible_;
+    has_comment_ = other.has_comment_;
+
+    return *this;
+}
+
+cell_impl &cell_impl::operator=(cell_impl &&other)
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    if (other.pooled_extras_)
+    {
+        // pooled extras stay with the cells they were allocated for
+        return *this = static_cast<const cell_impl &>(other);
+    }
+
+    reset_extras();
+    extras_ = other.extras_;
+    other.extras_ = nullptr;
+
+    parent_ = other.parent_;
+    value_numeric_ = other.value_numeric_;
+    format_ = other.format_;
+    column_ = other.column_;
+    row_ = other.row_;
+    type_ = other.type_;
+    is_merged_ = other.is_merged_;
+    phonetics_visible_ = other.phonetics_visible_;
+    has_comment_ = other.has_comment_;
+
+    return *this;
+}
+
+cell_extras &cell_impl::extras()
+{
+    if (extras_ == nullptr)
+    {
+        extras_ = parent_ != nullptr ? parent_->cells_.allocate_extras() : nullptr;
+        pooled_extras_ = extras_ != nullptr;
+
+        if (extras_ == nullptr)
+        {
+            extras_ = new cell_extras();
+        }
+    }
+
+    return *extras_;
+}
+
+void cell_impl::reset_extras()
+{
+    if (pooled_extras_)
+    {
+        parent_->cells_.release_extras(extras_);
+    }
+    else
+    {
+        delete extras_;
+    }
+
+    extras_ = nullptr;
+    pooled_extras_ = false;
+}
+
+void cell_impl::trim_extras()
+{
+    if (extras_ != nullptr && extras_->empty())
+    {
+        reset_extras();
+    }
+}
+
+const rich_text &cell_impl::value_text() const
+{
+    static const rich_text empty_text;
+
+    return extras_ ? extras_->value_text : empty_text;
+}
+
 } // namespace detail
 } // namespace xlnt
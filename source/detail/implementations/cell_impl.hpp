@@ -23,6 +23,7 @@
 #pragma once
 
 #include <cstddef>
+#include <memory>
 #include <string>
 
 #include <xlnt/cell/cell_type.hpp>
@@ -40,52 +41,166 @@ namespace detail {
 
 struct worksheet_impl;
 
+/// <summary>
+/// The parts of a cell which most cells don't have. They're only allocated
+/// for cells which have at least one of them to keep cell_impl small.
+/// </summary>
+struct cell_extras
+{
+    /// <summary>
+    /// The value of inline string, formula string and error cells.
+    /// </summary>
+    rich_text value_text;
+
+    optional<std::string> formula;
+    optional<hyperlink_impl> hyperlink;
+
+    bool empty() const
+    {
+        return !formula.is_set() && !hyperlink.is_set() && value_text == rich_text();
+    }
+};
+
+inline bool operator==(const cell_extras &lhs, const cell_extras &rhs)
+{
+    return lhs.value_text == rhs.value_text
+        && lhs.formula == rhs.formula
+        && lhs.hyperlink == rhs.hyperlink;
+}
+
 struct cell_impl
 {
-    cell_impl();
-    cell_impl(const cell_impl &other) = default;
-    cell_impl(cell_impl &&other) = default;
-    cell_impl &operator=(const cell_impl &other) = default;
-    cell_impl &operator=(cell_impl &&other) = default;
+    /// <summary>
+    /// Defined inline, like the destructor, so that the cells of a store
+    /// are constructed without a call each.
+    /// </summary>
+    cell_impl()
+        : parent_(nullptr),
+          value_numeric_(0),
+          format_(nullptr),
+          extras_(nullptr),
+          column_(1),
+          row_(1),
+          type_(cell_type::empty),
+          is_merged_(false),
+          phonetics_visible_(false),
+          has_comment_(false),
+          pooled_extras_(false)
+    {
+    }
 
-    cell_type type_;
+    cell_impl(const cell_impl &other);
+    cell_impl(cell_impl &&other);
+
+    ~cell_impl()
+    {
+        if (!pooled_extras_)
+        {
+            delete extras_;
+        }
+    }
+
+    cell_impl &operator=(const cell_impl &other);
+    cell_impl &operator=(cell_impl &&other);
 
+    /// <summary>
+    /// The worksheet whose cells the cell was created in. A cell shared by
+    /// copies of that worksheet keeps it, so xlnt::cell holds its worksheet itself.
+    /// </summary>
     worksheet_impl *parent_;
 
-    column_t column_;
+    /// <summary>
+    /// The value of number, date and boolean cells or the index of the
+    /// string of shared string cells.
+    /// </summary>
+    double value_numeric_;
+
+    /// <summary>
+    /// The format of the cell or nullptr if it has none.
+    /// </summary>
+    format_impl *format_;
+
+    /// <summary>
+    /// Text value, formula and hyperlink or nullptr if the cell has none of them.
+    /// They're owned by the cell unless pooled_extras_ is set.
+    /// </summary>
+    cell_extras *extras_;
+
+    /// <summary>
+    /// The index of the column rather than a column_t, whose constructors
+    /// aren't inline, so that setting it costs no call.
+    /// </summary>
+    column_t::index_t column_;
     row_t row_;
 
+    cell_type type_;
+
     bool is_merged_;
     bool phonetics_visible_;
 
-    rich_text value_text_;
-    double value_numeric_;
+    /// <summary>
+    /// The comment is held in the comments of the cell's worksheet under its reference.
+    /// </summary>
+    bool has_comment_;
+
+    /// <summary>
+    /// True if extras_ was allocated from the arena of the cells of parent_,
+    /// which then owns it.
+    /// </summary>
+    bool pooled_extras_;
+
+    /// <summary>
+    /// Returns the extras of the cell, allocating them if it has none. They're
+    /// taken from the cells of parent_ if it has an arena.
+    /// </summary>
+    cell_extras &extras();
 
-    optional<std::string> formula_;
-    optional<hyperlink_impl> hyperlink_;
-    optional<format_impl *> format_;
-    optional<comment *> comment_;
+    /// <summary>
+    /// Frees the extras of the cell.
+    /// </summary>
+    void reset_extras();
+
+    /// <summary>
+    /// Frees the extras if none of them is set anymore.
+    /// </summary>
+    void trim_extras();
+
+    /// <summary>
+    /// Returns the text value of the cell, which is empty unless it's an
+    /// inline string, formula string or error cell.
+    /// </summary>
+    const rich_text &value_text() const;
+
+    bool has_formula() const
+    {
+        return extras_ && extras_->formula.is_set();
+    }
+
+    bool has_hyperlink() const
+    {
+        return extras_ && extras_->hyperlink.is_set();
+    }
 
     bool is_garbage_collectible() const
     {
-        return !(type_ != cell_type::empty || is_merged_ || phonetics_visible_ || formula_.is_set() || format_.is_set() || hyperlink_.is_set());
+        return !(type_ != cell_type::empty || is_merged_ || phonetics_visible_ || has_formula() || format_ != nullptr || has_hyperlink());
     }
 };
 
 inline bool operator==(const cell_impl &lhs, const cell_impl &rhs)
 {
-    // not comparing parent
+    // not comparing parent, comments are compared with the worksheet
     return lhs.type_ == rhs.type_
         && lhs.column_ == rhs.column_
         && lhs.row_ == rhs.row_
         && lhs.is_merged_ == rhs.is_merged_
         && lhs.phonetics_visible_ == rhs.phonetics_visible_
-        && lhs.value_text_ == rhs.value_text_
+        && lhs.has_comment_ == rhs.has_comment_
+        && lhs.value_text() == rhs.value_text()
         && float_equals(lhs.value_numeric_, rhs.value_numeric_)
-        && lhs.formula_ == rhs.formula_
-        && lhs.hyperlink_ == rhs.hyperlink_
-        && (lhs.format_.is_set() == rhs.format_.is_set() && (!lhs.format_.is_set() || *lhs.format_.get() == *rhs.format_.get()))
-        && (lhs.comment_.is_set() == rhs.comment_.is_set() && (!lhs.comment_.is_set() || *lhs.comment_.get() == *rhs.comment_.get()));
+        && (lhs.has_formula() ? rhs.has_formula() && lhs.extras_->formula == rhs.extras_->formula : !rhs.has_formula())
+        && (lhs.has_hyperlink() ? rhs.has_hyperlink() && lhs.extras_->hyperlink == rhs.extras_->hyperlink : !rhs.has_hyperlink())
+        && ((lhs.format_ == nullptr) == (rhs.format_ == nullptr) && (lhs.format_ == nullptr || *lhs.format_ == *rhs.format_));
 }
 
 } // namespace detail
@@ -0,0 +1,1080 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+#include <detail/constants.hpp>
+#include <detail/implementations/cell_store.hpp>
+
+namespace {
+
+bool entry_before_column(const xlnt::detail::cell_entry &entry, xlnt::column_t::index_t column)
+{
+    return entry.column < column;
+}
+
+bool block_before_index(const xlnt::detail::cell_store::block_ptr &block, xlnt::row_t index)
+{
+    return block->index < index;
+}
+
+std::size_t next_store_id()
+{
+    static std::atomic<std::size_t> next_id(1);
+
+    return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+xlnt::detail::cell_impl *find_in_row(const xlnt::detail::cell_row &row, xlnt::column_t::index_t column)
+{
+    auto entry = std::lower_bound(row.begin(), row.end(), column, entry_before_column);
+
+    return entry != row.end() && entry->column == column ? entry->cell : nullptr;
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+const row_t cell_store::block_rows;
+
+cell_store::cell_store()
+    : parent_(nullptr),
+      id_(next_store_id()),
+      copies_(std::make_shared<const char>()),
+      size_(0),
+      shared_(false),
+      bounds_{0, 0, 0, 0},
+      bounds_stale_(false),
+      chunk_(nullptr),
+      chunk_size_(0),
+      chunk_used_(0)
+{
+}
+
+cell_store::cell_store(const cell_store &other)
+    : cell_store()
+{
+    *this = other;
+}
+
+cell_store::cell_store(cell_store &&other)
+    : cell_store()
+{
+    *this = std::move(other);
+}
+
+cell_store::~cell_store()
+{
+    // every cell of a chunk is constructed before the last store holding it frees it
+    retire_chunk();
+    destroy_extras();
+}
+
+void cell_store::parent(worksheet_impl *parent)
+{
+    parent_ = parent;
+}
+
+void cell_store::use_arena(const std::shared_ptr<arena> &source)
+{
+    clear();
+    arena_ = source;
+}
+
+const std::shared_ptr<arena> &cell_store::arena_source() const
+{
+    return arena_;
+}
+
+cell_store &cell_store::operator=(const cell_store &other)
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    clear();
+
+    if (!arena_ && !other.arena_)
+    {
+        // other is only read, the blocks are copied by whichever store
+        // changes them first
+        copies_ = other.copies_;
+        blocks_ = other.blocks_;
+        chunks_.insert(chunks_.end(), other.chunks_.begin(), other.chunks_.end());
+        size_ = other.size_;
+        bounds_ = size_ > 0 ? other.extent() : other.bounds_;
+        shared_ = !blocks_.empty();
+
+        return *this;
+    }
+
+    reserve(other.size_);
+    blocks_.reserve(other.blocks_.size());
+
+    for (const auto &other_block : other.blocks_)
+    {
+        blocks_.push_back(new_block(other_block->index));
+        auto &block = *blocks_.back();
+
+        for (row_t i = 0; i < block_rows; ++i)
+        {
+            block.rows[i].reserve(other_block->rows[i].size());
+
+            for (const auto &entry : other_block->rows[i])
+            {
+                auto cell = allocate();
+                *cell = *entry.cell;
+                cell->parent_ = parent_;
+                adopt(cell);
+                block.rows[i].push_back(cell_entry{entry.column, cell});
+            }
+        }
+    }
+
+    size_ = other.size_;
+
+    if (size_ > 0)
+    {
+        bounds_ = other.extent();
+    }
+
+    return *this;
+}
+
+cell_store &cell_store::operator=(cell_store &&other)
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    clear();
+    arena_ = std::move(other.arena_);
+    // the blocks of other keep their owner along with the id
+    std::swap(id_, other.id_);
+    copies_.swap(other.copies_);
+    blocks_.swap(other.blocks_);
+    size_ = other.size_;
+    shared_ = other.shared_;
+    bounds_ = other.bounds_;
+    bounds_stale_.store(other.bounds_stale_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    chunks_.swap(other.chunks_);
+    // swapped rather than copied so that other doesn't retire the last chunk
+    std::swap(chunk_, other.chunk_);
+    std::swap(chunk_size_, other.chunk_size_);
+    std::swap(chunk_used_, other.chunk_used_);
+    free_cells_.swap(other.free_cells_);
+    extras_.swap(other.extras_);
+    free_extras_.swap(other.free_extras_);
+
+    other.clear();
+
+    return *this;
+}
+
+std::size_t cell_store::size() const
+{
+    return size_;
+}
+
+bool cell_store::empty() const
+{
+    return size_ == 0;
+}
+
+cell_impl *cell_store::find(const cell_reference &reference)
+{
+    const auto &self = *this;
+
+    // blocks are only detached for cells which exist
+    if ((shared_ || copies_.use_count() > 1) && self.find(reference) != nullptr)
+    {
+        detach_row(reference.row());
+    }
+
+    return const_cast<cell_impl *>(self.find(reference));
+}
+
+const cell_impl *cell_store::find(const cell_reference &reference) const
+{
+    auto block = find_block((reference.row() - 1) / block_rows);
+
+    if (block == nullptr)
+    {
+        return nullptr;
+    }
+
+    return find_in_row(block->rows[(reference.row() - 1) % block_rows], reference.column_index());
+}
+
+std::pair<cell_impl *, bool> cell_store::emplace(const cell_reference &reference)
+{
+    auto &row = *row_entries(reference.row(), true);
+    const auto column = reference.column_index();
+
+    // cells are mostly added left to right
+    auto entry = !row.empty() && row.back().column < column
+        ? row.end()
+        : std::lower_bound(row.begin(), row.end(), column, entry_before_column);
+
+    if (entry != row.end() && entry->column == column)
+    {
+        return std::make_pair(entry->cell, false);
+    }
+
+    auto cell = allocate();
+    cell->column_ = column;
+    cell->row_ = reference.row();
+    row.insert(entry, cell_entry{column, cell});
+    include(reference.row(), column, column);
+    ++size_;
+
+    return std::make_pair(cell, true);
+}
+
+void cell_store::emplace_row(row_t row, column_t::index_t first_column, std::size_t count, cell_impl **cells)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    auto &entries = *row_entries(row, true);
+    auto position = std::lower_bound(entries.begin(), entries.end(), first_column, entry_before_column);
+
+    include(row, first_column, static_cast<column_t::index_t>(first_column + count - 1));
+
+    auto create = [this, row](column_t::index_t column) {
+        auto cell = allocate();
+        cell->column_ = column;
+        cell->row_ = row;
+        ++size_;
+
+        return cell;
+    };
+
+    if (position == entries.end())
+    {
+        // the common case, appending to the row, where the entries are
+        // written in place rather than pushed one at a time
+        allocate(count, cells);
+        size_ += count;
+        entries.resize(entries.size() + count);
+        auto entry = entries.end() - static_cast<std::ptrdiff_t>(count);
+        auto column = first_column;
+
+        for (auto cell = cells; cell != cells + count; ++cell, ++entry, ++column)
+        {
+            (*cell)->column_ = column;
+            (*cell)->row_ = row;
+            entry->column = column;
+            entry->cell = *cell;
+        }
+
+        return;
+    }
+
+    // merge the existing cells with the new ones
+    cell_row merged(entries.get_allocator());
+    merged.reserve(entries.size() + count);
+    merged.insert(merged.end(), entries.begin(), position);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const auto column = static_cast<column_t::index_t>(first_column + i);
+
+        while (position != entries.end() && position->column < column)
+        {
+            merged.push_back(*position++);
+        }
+
+        if (position != entries.end() && position->column == column)
+        {
+            cells[i] = position->cell;
+            merged.push_back(*position++);
+        }
+        else
+        {
+            cells[i] = create(column);
+            merged.push_back(cell_entry{column, cells[i]});
+        }
+    }
+
+    merged.insert(merged.end(), position, entries.end());
+    entries.swap(merged);
+}
+
+bool cell_store::erase(const cell_reference &reference)
+{
+    const auto &self = *this;
+
+    if (self.find(reference) == nullptr)
+    {
+        return false;
+    }
+
+    auto row = row_entries(reference.row(), false);
+    const auto column = reference.column_index();
+    auto entry = std::lower_bound(row->begin(), row->end(), column, entry_before_column);
+
+    exclude(reference.row(), column);
+    release(entry->cell);
+    row->erase(entry);
+    --size_;
+
+    return true;
+}
+
+void cell_store::erase_row(row_t row)
+{
+    auto block = find_block((row - 1) / block_rows);
+
+    if (block == nullptr || block->rows[(row - 1) % block_rows].empty())
+    {
+        return;
+    }
+
+    auto entries = row_entries(row, false);
+    exclude(row, entries->front().column);
+    exclude(row, entries->back().column);
+
+    for (auto &entry : *entries)
+    {
+        release(entry.cell);
+    }
+
+    size_ -= entries->size();
+    entries->clear();
+}
+
+void cell_store::insert_rows(row_t row, row_t amount)
+{
+    if (amount == 0 || empty())
+    {
+        return;
+    }
+
+    if (extent().max_row < row)
+    {
+        return;
+    }
+
+    bounds_.min_row = bounds_.min_row >= row ? bounds_.min_row + amount : bounds_.min_row;
+    bounds_.max_row += amount;
+
+    shift_rows(row, amount, false);
+}
+
+void cell_store::delete_rows(row_t row, row_t amount)
+{
+    if (amount == 0 || empty())
+    {
+        return;
+    }
+
+    for (auto deleted : rows(row, row + amount - 1))
+    {
+        erase_row(deleted);
+    }
+
+    // the bounds are usually stale now, they are recomputed when needed
+    if (!bounds_stale_.load(std::memory_order_relaxed) && !empty() && bounds_.max_row >= row + amount)
+    {
+        bounds_.min_row = bounds_.min_row >= row + amount ? bounds_.min_row - amount : bounds_.min_row;
+        bounds_.max_row -= amount;
+    }
+
+    shift_rows(row + amount, amount, true);
+}
+
+void cell_store::insert_columns(column_t::index_t column, column_t::index_t amount)
+{
+    if (amount == 0)
+    {
+        return;
+    }
+
+    auto moved = false;
+
+    for (auto &block : blocks_)
+    {
+        if (!std::any_of(block->rows.begin(), block->rows.end(), [column](const cell_row &entries) {
+                return !entries.empty() && entries.back().column >= column;
+            }))
+        {
+            continue;
+        }
+
+        for (auto &entries : own(block).rows)
+        {
+            auto entry = std::lower_bound(entries.begin(), entries.end(), column, entry_before_column);
+
+            // the order of the row is unchanged
+            for (; entry != entries.end(); ++entry)
+            {
+                entry->column += amount;
+                entry->cell->column_ = entry->column;
+                moved = true;
+            }
+        }
+    }
+
+    if (!bounds_stale_.load(std::memory_order_relaxed) && moved)
+    {
+        bounds_.min_column = bounds_.min_column >= column ? bounds_.min_column + amount : bounds_.min_column;
+        bounds_.max_column += amount;
+    }
+}
+
+void cell_store::delete_columns(column_t::index_t column, column_t::index_t amount)
+{
+    if (amount == 0)
+    {
+        return;
+    }
+
+    auto moved = false;
+
+    for (auto &block : blocks_)
+    {
+        if (!std::any_of(block->rows.begin(), block->rows.end(), [column](const cell_row &entries) {
+                return !entries.empty() && entries.back().column >= column;
+            }))
+        {
+            continue;
+        }
+
+        for (auto &entries : own(block).rows)
+        {
+            auto first = std::lower_bound(entries.begin(), entries.end(), column, entry_before_column);
+            auto last = std::lower_bound(first, entries.end(), column + amount, entry_before_column);
+
+            for (auto entry = first; entry != last; ++entry)
+            {
+                exclude(entry->cell->row_, entry->column);
+                release(entry->cell);
+                --size_;
+            }
+
+            auto entry = entries.erase(first, last);
+
+            for (; entry != entries.end(); ++entry)
+            {
+                entry->column -= amount;
+                entry->cell->column_ = entry->column;
+                moved = true;
+            }
+        }
+    }
+
+    if (!bounds_stale_.load(std::memory_order_relaxed) && moved)
+    {
+        bounds_.min_column = bounds_.min_column >= column + amount ? bounds_.min_column - amount : bounds_.min_column;
+        bounds_.max_column -= amount;
+    }
+}
+
+void cell_store::clear()
+{
+    retire_chunk();
+    destroy_extras();
+    blocks_.clear();
+
+    // copies may hold on to the old token, the blocks they share aren't ours anymore
+    if (copies_.use_count() > 1)
+    {
+        copies_ = std::make_shared<const char>();
+    }
+
+    size_ = 0;
+    shared_ = false;
+    bounds_stale_.store(false, std::memory_order_relaxed);
+    chunks_.clear();
+    chunk_ = nullptr;
+    chunk_size_ = 0;
+    chunk_used_ = 0;
+    free_cells_.clear();
+}
+
+void cell_store::reserve(std::size_t count)
+{
+    const auto available = free_cells_.size() + (chunk_size_ - chunk_used_);
+
+    if (count > size_ + available)
+    {
+        add_chunk(count - size_ - available);
+    }
+}
+
+void cell_store::reserve_row(row_t row, std::size_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    auto &entries = *row_entries(row, true);
+    entries.reserve(entries.size() + count);
+}
+
+const cell_row *cell_store::row(row_t row) const
+{
+    auto block = find_block((row - 1) / block_rows);
+
+    if (block == nullptr)
+    {
+        return nullptr;
+    }
+
+    const auto &entries = block->rows[(row - 1) % block_rows];
+
+    return entries.empty() ? nullptr : &entries;
+}
+
+std::vector<row_t> cell_store::rows() const
+{
+    std::vector<row_t> result;
+
+    for (const auto &block : blocks_)
+    {
+        for (std::size_t i = 0; i < block->rows.size(); ++i)
+        {
+            if (!block->rows[i].empty())
+            {
+                result.push_back(block->index * block_rows + static_cast<row_t>(i) + 1);
+            }
+        }
+    }
+
+    return result;
+}
+
+const cell_store::bounds &cell_store::extent() const
+{
+    if (!bounds_stale_.load(std::memory_order_acquire))
+    {
+        return bounds_;
+    }
+
+    // const access may be shared between threads, so only one of them
+    // recomputes the bounds and the others wait for it
+    std::lock_guard<std::mutex> lock(bounds_mutex_);
+
+    if (!bounds_stale_.load(std::memory_order_relaxed))
+    {
+        return bounds_;
+    }
+
+    auto first = true;
+
+    for_each_row(constants::min_row(), constants::max_row(), [&](row_t row, const cell_row &entries) {
+        if (first)
+        {
+            bounds_ = bounds{row, row, entries.front().column, entries.back().column};
+            first = false;
+
+            return;
+        }
+
+        bounds_.max_row = row;
+        bounds_.min_column = std::min(bounds_.min_column, entries.front().column);
+        bounds_.max_column = std::max(bounds_.max_column, entries.back().column);
+    });
+
+    bounds_stale_.store(false, std::memory_order_release);
+
+    return bounds_;
+}
+
+std::vector<row_t> cell_store::rows(row_t first_row, row_t last_row) const
+{
+    std::vector<row_t> result;
+
+    for_each_row(first_row, last_row, [&result](row_t row, const cell_row &) {
+        result.push_back(row);
+    });
+
+    return result;
+}
+
+void cell_store::shift_rows(row_t first_row, row_t amount, bool up)
+{
+    const auto target_row = [amount, up](row_t row) { return up ? row - amount : row + amount; };
+
+    // rows moving up land in blocks before the first moved row
+    own_from(up ? first_row - amount : first_row);
+
+    const auto first_block = std::lower_bound(blocks_.begin(), blocks_.end(), (first_row - 1) / block_rows, block_before_index);
+
+    // the blocks the rows of each block move into
+    std::vector<row_t> missing;
+
+    for (auto block = first_block; block != blocks_.end(); ++block)
+    {
+        const auto block_first = (*block)->index * block_rows + 1;
+        auto first = block_rows;
+        auto last = row_t(0);
+
+        for (row_t i = first_row > block_first ? first_row - block_first : 0; i < block_rows; ++i)
+        {
+            if (!(*block)->rows[i].empty())
+            {
+                first = std::min(first, i);
+                last = i;
+            }
+        }
+
+        if (first == block_rows)
+        {
+            continue;
+        }
+
+        for (auto index = (target_row(block_first + first) - 1) / block_rows;
+             index <= (target_row(block_first + last) - 1) / block_rows; ++index)
+        {
+            if (missing.empty() || missing.back() < index)
+            {
+                missing.push_back(index);
+            }
+        }
+    }
+
+    missing.erase(std::remove_if(missing.begin(), missing.end(), [this](row_t index) {
+        auto block = std::lower_bound(blocks_.begin(), blocks_.end(), index, block_before_index);
+        return block != blocks_.end() && (*block)->index == index;
+    }),
+        missing.end());
+
+    if (!missing.empty())
+    {
+        std::vector<block_ptr> merged;
+        merged.reserve(blocks_.size() + missing.size());
+        auto index = missing.begin();
+
+        for (auto &block : blocks_)
+        {
+            while (index != missing.end() && *index < block->index)
+            {
+                merged.push_back(new_block(*index++));
+            }
+
+            merged.push_back(std::move(block));
+        }
+
+        while (index != missing.end())
+        {
+            merged.push_back(new_block(*index++));
+        }
+
+        blocks_.swap(merged);
+    }
+
+    // every target row is empty by the time a row is moved into it: rows
+    // moving down are moved bottom up and rows moving up top down
+    const auto first_source = std::lower_bound(blocks_.begin(), blocks_.end(), (first_row - 1) / block_rows, block_before_index);
+    auto target = up ? blocks_.begin() : blocks_.end() - 1;
+
+    auto move = [&](row_block &block, row_t i) {
+        auto &entries = block.rows[i];
+
+        if (entries.empty())
+        {
+            return;
+        }
+
+        const auto to = target_row(block.index * block_rows + i + 1);
+        const auto index = (to - 1) / block_rows;
+
+        while ((*target)->index != index)
+        {
+            up ? ++target : --target;
+        }
+
+        auto &target_entries = (*target)->rows[(to - 1) % block_rows];
+        target_entries.swap(entries);
+
+        for (auto &entry : target_entries)
+        {
+            entry.cell->row_ = to;
+        }
+    };
+
+    if (up)
+    {
+        for (auto block = first_source; block != blocks_.end(); ++block)
+        {
+            const auto block_first = (*block)->index * block_rows + 1;
+
+            for (row_t i = first_row > block_first ? first_row - block_first : 0; i < block_rows; ++i)
+            {
+                move(**block, i);
+            }
+        }
+    }
+    else
+    {
+        for (auto block = blocks_.end(); block != first_source;)
+        {
+            --block;
+            const auto block_first = (*block)->index * block_rows + 1;
+            const auto begin = first_row > block_first ? first_row - block_first : 0;
+
+            for (auto i = block_rows; i > begin; --i)
+            {
+                move(**block, i - 1);
+            }
+        }
+    }
+}
+
+cell_extras *cell_store::allocate_extras()
+{
+    if (!arena_)
+    {
+        return nullptr;
+    }
+
+    if (!free_extras_.empty())
+    {
+        auto extras = free_extras_.back();
+        free_extras_.pop_back();
+
+        return extras;
+    }
+
+    auto extras = new (arena_->allocate(sizeof(cell_extras), alignof(cell_extras))) cell_extras();
+    extras_.push_back(extras);
+
+    return extras;
+}
+
+void cell_store::release_extras(cell_extras *extras)
+{
+    *extras = cell_extras();
+    free_extras_.push_back(extras);
+}
+
+void cell_store::adopt(cell_impl *cell)
+{
+    if (!arena_ || cell->extras_ == nullptr || cell->pooled_extras_)
+    {
+        return;
+    }
+
+    auto extras = allocate_extras();
+    *extras = std::move(*cell->extras_);
+    delete cell->extras_;
+    cell->extras_ = extras;
+    cell->pooled_extras_ = true;
+}
+
+cell_store::iterator cell_store::begin()
+{
+    for (auto &block : blocks_)
+    {
+        own(block);
+    }
+
+    return iterator(blocks_.begin(), blocks_.end());
+}
+
+cell_store::iterator cell_store::end()
+{
+    return iterator(blocks_.end(), blocks_.end());
+}
+
+cell_store::const_iterator cell_store::begin() const
+{
+    return const_iterator(blocks_.begin(), blocks_.end());
+}
+
+cell_store::const_iterator cell_store::end() const
+{
+    return const_iterator(blocks_.end(), blocks_.end());
+}
+
+bool cell_store::operator==(const cell_store &other) const
+{
+    if (size_ != other.size_)
+    {
+        return false;
+    }
+
+    auto other_cell = other.begin();
+
+    for (const auto &cell : *this)
+    {
+        if (!(cell == *other_cell))
+        {
+            return false;
+        }
+
+        ++other_cell;
+    }
+
+    return true;
+}
+
+cell_row *cell_store::row_entries(row_t row, bool create)
+{
+    const auto index = (row - 1) / block_rows;
+    auto block = blocks_.end();
+
+    // rows are mostly added and read from top to bottom
+    if (!blocks_.empty() && blocks_.back()->index <= index)
+    {
+        block = blocks_.back()->index == index ? blocks_.end() - 1 : blocks_.end();
+    }
+    else
+    {
+        block = std::lower_bound(blocks_.begin(), blocks_.end(), index, block_before_index);
+    }
+
+    if (block == blocks_.end() || (*block)->index != index)
+    {
+        if (!create)
+        {
+            return nullptr;
+        }
+
+        block = blocks_.insert(block, new_block(index));
+    }
+
+    return &own(*block).rows[(row - 1) % block_rows];
+}
+
+const cell_store::row_block *cell_store::find_block(row_t index) const
+{
+    auto block = std::lower_bound(blocks_.begin(), blocks_.end(), index, block_before_index);
+
+    return block != blocks_.end() && (*block)->index == index ? block->get() : nullptr;
+}
+
+cell_store::block_ptr cell_store::new_block(row_t index)
+{
+    const auto allocator = arena_allocator<cell_row>(arena_.get());
+
+    return std::make_shared<row_block>(row_block{index, {block_rows, cell_row(allocator), allocator}, id_});
+}
+
+cell_store::row_block &cell_store::own(block_ptr &block)
+{
+    if (owned(block))
+    {
+        return *block;
+    }
+
+    // a block is shared once another store took it, even if that store has
+    // since dropped it, so it's only read here
+    auto copy = std::make_shared<row_block>(row_block{block->index, block->rows, id_});
+
+    for (auto &entries : copy->rows)
+    {
+        for (auto &entry : entries)
+        {
+            auto cell = allocate();
+            *cell = *entry.cell;
+            cell->parent_ = parent_;
+            entry.cell = cell;
+        }
+    }
+
+    block = std::move(copy);
+    shared_ = true;
+
+    return *block;
+}
+
+void cell_store::own_from(row_t row)
+{
+    auto block = std::lower_bound(blocks_.begin(), blocks_.end(), (row - 1) / block_rows, block_before_index);
+
+    for (; block != blocks_.end(); ++block)
+    {
+        own(*block);
+    }
+}
+
+void cell_store::detach_row(row_t row)
+{
+    const auto index = (row - 1) / block_rows;
+    auto block = std::lower_bound(blocks_.begin(), blocks_.end(), index, block_before_index);
+
+    if (block != blocks_.end() && (*block)->index == index)
+    {
+        own(*block);
+    }
+}
+
+cell_impl *cell_store::detach_cell(const cell_impl *cell)
+{
+    // the cell may have been copied, so its position is what identifies it
+    auto entries = row_entries(cell->row_, true);
+    auto entry = std::lower_bound(entries->begin(), entries->end(), cell->column_, entry_before_column);
+
+    if (entry != entries->end() && entry->column == cell->column_)
+    {
+        return entry->cell;
+    }
+
+    // the cell was erased from this store after it was found
+    auto created = emplace(cell_reference(cell->column_, cell->row_)).first;
+    created->parent_ = parent_;
+
+    return created;
+}
+
+void cell_store::include(row_t row, column_t::index_t first_column, column_t::index_t last_column)
+{
+    if (bounds_stale_.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    if (size_ == 0)
+    {
+        bounds_ = bounds{row, row, first_column, last_column};
+        return;
+    }
+
+    bounds_.min_row = std::min(bounds_.min_row, row);
+    bounds_.max_row = std::max(bounds_.max_row, row);
+    bounds_.min_column = std::min(bounds_.min_column, first_column);
+    bounds_.max_column = std::max(bounds_.max_column, last_column);
+}
+
+void cell_store::exclude(row_t row, column_t::index_t column)
+{
+    if (row == bounds_.min_row || row == bounds_.max_row
+        || column == bounds_.min_column || column == bounds_.max_column)
+    {
+        bounds_stale_.store(true, std::memory_order_relaxed);
+    }
+}
+
+cell_impl *cell_store::allocate()
+{
+    if (!free_cells_.empty())
+    {
+        auto cell = free_cells_.back();
+        free_cells_.pop_back();
+
+        return cell;
+    }
+
+    if (chunk_used_ == chunk_size_)
+    {
+        // chunks grow with the sheet so small sheets stay small
+        add_chunk(std::min(std::max(size_, std::size_t(16)), std::size_t(4096)));
+    }
+
+    return new (&chunk_[chunk_used_++]) cell_impl();
+}
+
+void cell_store::allocate(std::size_t count, cell_impl **cells)
+{
+    std::size_t allocated = 0;
+
+    while (allocated < count && !free_cells_.empty())
+    {
+        cells[allocated++] = free_cells_.back();
+        free_cells_.pop_back();
+    }
+
+    while (allocated < count)
+    {
+        if (chunk_used_ == chunk_size_)
+        {
+            add_chunk(std::min(std::max(size_ + allocated, std::size_t(16)), std::size_t(4096)));
+        }
+
+        const auto run = std::min(count - allocated, chunk_size_ - chunk_used_);
+
+        for (std::size_t i = 0; i < run; ++i)
+        {
+            cells[allocated++] = new (&chunk_[chunk_used_++]) cell_impl();
+        }
+    }
+}
+
+void cell_store::release(cell_impl *cell)
+{
+    *cell = cell_impl();
+    free_cells_.push_back(cell);
+}
+
+void cell_store::add_chunk(std::size_t size)
+{
+    retire_chunk();
+
+    if (arena_)
+    {
+        // cells in the arena are never destroyed, see destroy_extras
+        chunk_ = static_cast<cell_impl *>(arena_->allocate(size * sizeof(cell_impl), alignof(cell_impl)));
+    }
+    else
+    {
+        chunks_.emplace_back(static_cast<cell_impl *>(::operator new(size * sizeof(cell_impl))), chunk_deleter{size});
+        chunk_ = chunks_.back().get();
+    }
+
+    chunk_size_ = size;
+    chunk_used_ = 0;
+}
+
+void cell_store::retire_chunk()
+{
+    while (chunk_used_ < chunk_size_)
+    {
+        free_cells_.push_back(new (&chunk_[--chunk_size_]) cell_impl());
+    }
+}
+
+void cell_store::chunk_deleter::operator()(cell_impl *cells) const
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        cells[i].~cell_impl();
+    }
+
+    ::operator delete(cells);
+}
+
+void cell_store::destroy_extras()
+{
+    for (auto extras : extras_)
+    {
+        extras->~cell_extras();
+    }
+
+    extras_.clear();
+    free_extras_.clear();
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,734 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <xlnt/cell/cell_reference.hpp>
+#include <xlnt/cell/index_types.hpp>
+#include <detail/implementations/arena.hpp>
+#include <detail/implementations/cell_impl.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// A cell in a row of a cell_store.
+/// </summary>
+struct cell_entry
+{
+    column_t::index_t column;
+    cell_impl *cell;
+};
+
+/// <summary>
+/// The cells of a row of a cell_store sorted by column.
+/// </summary>
+using cell_row = std::vector<cell_entry, arena_allocator<cell_entry>>;
+
+/// <summary>
+/// The cells of a worksheet in row-major order. Rows are grouped into blocks of
+/// block_rows consecutive rows, held sorted by their first row, and each row is
+/// an array of its cells sorted by column. The cell_impls themselves are
+/// allocated from chunks owned by the store and never move, so pointers to them
+/// (e.g. in xlnt::cell) remain valid until the cell is erased.
+///
+/// Copies of a store share its blocks and cells until either side changes a
+/// block, which is then copied, with new cells, for the store changing it.
+/// A shared block and its cells are never written to again, so copies can be
+/// read and made from several threads. Whether a block is shared is decided
+/// only by the count of its references. Cells must be detached before they're
+/// changed through a pointer to them, which gives the pointer to the cell at the
+/// same position the store may change. Other pointers to the cell then still
+/// refer to the shared one and see its old contents.
+///
+/// If the store is given an arena, the cells, the rows and the extras of the
+/// cells are allocated from it. Erased cells and extras are reused by the store,
+/// and the buffers of outgrown rows by the arena, but their memory is only
+/// returned when the arena is destroyed. Destroying
+/// the store then only destroys the extras, the cells themselves are dropped
+/// with the arena. Stores with an arena are copied cell by cell.
+/// </summary>
+class cell_store
+{
+public:
+    /// <summary>
+    /// The number of rows in a block.
+    /// </summary>
+    static const row_t block_rows = 256;
+
+    /// <summary>
+    /// Destroys the size cells of a chunk and frees it.
+    /// </summary>
+    struct chunk_deleter
+    {
+        std::size_t size;
+
+        void operator()(cell_impl *cells) const;
+    };
+
+    /// <summary>
+    /// A chunk of cells allocated from the heap. It's shared by the copies of
+    /// the store whose blocks may hold its cells.
+    /// </summary>
+    using chunk_ptr = std::shared_ptr<cell_impl>;
+
+    /// <summary>
+    /// A block of block_rows rows starting at row index * block_rows + 1.
+    /// </summary>
+    struct row_block
+    {
+        row_t index;
+        std::vector<cell_row, arena_allocator<cell_row>> rows;
+
+        /// <summary>
+        /// The id of the store which created the block and its cells. Only
+        /// that store changes them, and only while no copy shares the block.
+        /// </summary>
+        std::size_t owner;
+    };
+
+    /// <summary>
+    /// A block, shared by the copies of a store until one of them changes it.
+    /// </summary>
+    using block_ptr = std::shared_ptr<row_block>;
+
+    /// <summary>
+    /// The smallest rectangle containing every cell of a store.
+    /// </summary>
+    struct bounds
+    {
+        row_t min_row;
+        row_t max_row;
+        column_t::index_t min_column;
+        column_t::index_t max_column;
+    };
+
+    /// <summary>
+    /// Iterates over the cells of a store in row-major order.
+    /// </summary>
+    template <typename Block_Iterator, typename Cell>
+    class basic_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = cell_impl;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Cell *;
+        using reference = Cell &;
+
+        basic_iterator(Block_Iterator block, Block_Iterator block_end)
+            : block_(block),
+              block_end_(block_end),
+              row_(0),
+              entry_(0)
+        {
+            settle();
+        }
+
+        reference operator*() const
+        {
+            return *(*block_)->rows[row_][entry_].cell;
+        }
+
+        pointer operator->() const
+        {
+            return (*block_)->rows[row_][entry_].cell;
+        }
+
+        basic_iterator &operator++()
+        {
+            ++entry_;
+            settle();
+
+            return *this;
+        }
+
+        basic_iterator operator++(int)
+        {
+            auto old = *this;
+            ++*this;
+
+            return old;
+        }
+
+        bool operator==(const basic_iterator &other) const
+        {
+            return block_ == other.block_
+                && (block_ == block_end_ || (row_ == other.row_ && entry_ == other.entry_));
+        }
+
+        bool operator!=(const basic_iterator &other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        /// <summary>
+        /// Moves forward to the next cell unless already on one.
+        /// </summary>
+        void settle()
+        {
+            while (block_ != block_end_)
+            {
+                while (row_ < (*block_)->rows.size())
+                {
+                    if (entry_ < (*block_)->rows[row_].size())
+                    {
+                        return;
+                    }
+
+                    ++row_;
+                    entry_ = 0;
+                }
+
+                ++block_;
+                row_ = 0;
+            }
+        }
+
+        Block_Iterator block_;
+        Block_Iterator block_end_;
+        std::size_t row_;
+        std::size_t entry_;
+    };
+
+    using iterator = basic_iterator<std::vector<block_ptr>::iterator, cell_impl>;
+    using const_iterator = basic_iterator<std::vector<block_ptr>::const_iterator, const cell_impl>;
+
+    cell_store();
+    cell_store(const cell_store &other);
+    cell_store(cell_store &&other);
+    ~cell_store();
+
+    /// <summary>
+    /// Makes this store a copy of other. Unless either of them has an arena,
+    /// the blocks of other are shared rather than copied.
+    /// </summary>
+    cell_store &operator=(const cell_store &other);
+    cell_store &operator=(cell_store &&other);
+
+    /// <summary>
+    /// Sets the worksheet the cells of the store belong to, cells the store
+    /// creates are given it as their parent. Cells shared with copies keep
+    /// the parent of the store which created them.
+    /// </summary>
+    void parent(worksheet_impl *parent);
+
+    /// <summary>
+    /// Allocates the cells added from now on from source, or from the heap if
+    /// it's null, after erasing every cell. Copies of the store don't share its arena.
+    /// </summary>
+    void use_arena(const std::shared_ptr<arena> &source);
+
+    /// <summary>
+    /// Returns the arena cells are allocated from or null if they're on the heap.
+    /// </summary>
+    const std::shared_ptr<arena> &arena_source() const;
+
+    /// <summary>
+    /// Returns the number of cells.
+    /// </summary>
+    std::size_t size() const;
+
+    /// <summary>
+    /// Returns true if there are no cells.
+    /// </summary>
+    bool empty() const;
+
+    /// <summary>
+    /// Returns the cell at reference or nullptr if there is none. Its block is
+    /// detached from copies of the store first.
+    /// </summary>
+    cell_impl *find(const cell_reference &reference);
+
+    /// <summary>
+    /// Returns the cell at reference or nullptr if there is none. The cell may
+    /// be shared with copies of the store.
+    /// </summary>
+    const cell_impl *find(const cell_reference &reference) const;
+
+    /// <summary>
+    /// Must be called before cell, which was found in this store, is changed
+    /// through a pointer to it, which is then replaced by the result. If
+    /// the cell may be shared with copies of the store, its block is copied
+    /// for this store and the copy of the cell is returned, otherwise cell.
+    /// </summary>
+    cell_impl *detach(cell_impl *cell)
+    {
+        if (shared_ || copies_.use_count() > 1)
+        {
+            return detach_cell(cell);
+        }
+
+        // copies release the token after their blocks, see copies_
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        return cell;
+    }
+
+    /// <summary>
+    /// Returns the cell at reference, creating an empty one at that position
+    /// if there was none, and whether it was created.
+    /// </summary>
+    std::pair<cell_impl *, bool> emplace(const cell_reference &reference);
+
+    /// <summary>
+    /// Stores the cells of row from first_column to first_column + count - 1 in
+    /// cells, creating those which don't exist. This is much faster than calling
+    /// emplace for each of them.
+    /// </summary>
+    void emplace_row(row_t row, column_t::index_t first_column, std::size_t count, cell_impl **cells);
+
+    /// <summary>
+    /// Erases the cell at reference if there is one and returns whether there was.
+    /// </summary>
+    bool erase(const cell_reference &reference);
+
+    /// <summary>
+    /// Erases every cell in the given row.
+    /// </summary>
+    void erase_row(row_t row);
+
+    /// <summary>
+    /// Moves the rows from row on down by amount rows. The rows are moved as a
+    /// whole, so this costs a step per row plus an update per moved cell.
+    /// </summary>
+    void insert_rows(row_t row, row_t amount);
+
+    /// <summary>
+    /// Erases the cells of the amount rows from row on and moves the rows below them up.
+    /// </summary>
+    void delete_rows(row_t row, row_t amount);
+
+    /// <summary>
+    /// Moves the cells from column on right by amount columns.
+    /// </summary>
+    void insert_columns(column_t::index_t column, column_t::index_t amount);
+
+    /// <summary>
+    /// Erases the cells of the amount columns from column on and moves the cells
+    /// right of them left.
+    /// </summary>
+    void delete_columns(column_t::index_t column, column_t::index_t amount);
+
+    /// <summary>
+    /// Erases every cell for which predicate returns true, visiting the cells
+    /// in row-major order.
+    /// </summary>
+    template <typename Predicate>
+    void erase_if(Predicate predicate)
+    {
+        for (auto &block : blocks_)
+        {
+            if (!owned(block))
+            {
+                // only blocks with cells to erase are detached
+                auto any = false;
+
+                for (const auto &row : block->rows)
+                {
+                    for (const auto &entry : row)
+                    {
+                        any = any || predicate(*entry.cell);
+                    }
+                }
+
+                if (!any)
+                {
+                    continue;
+                }
+            }
+
+            for (auto &row : own(block).rows)
+            {
+                auto kept = row.begin();
+
+                for (auto &entry : row)
+                {
+                    if (predicate(*entry.cell))
+                    {
+                        exclude(entry.cell->row_, entry.column);
+                        release(entry.cell);
+                        --size_;
+                    }
+                    else
+                    {
+                        *kept++ = entry;
+                    }
+                }
+
+                row.erase(kept, row.end());
+            }
+        }
+    }
+
+    /// <summary>
+    /// Erases every cell.
+    /// </summary>
+    void clear();
+
+    /// <summary>
+    /// Allocates room for count cells in total up front.
+    /// </summary>
+    void reserve(std::size_t count);
+
+    /// <summary>
+    /// Allocates room for count more cells in row up front so that adding them
+    /// one at a time doesn't reallocate the row.
+    /// </summary>
+    void reserve_row(row_t row, std::size_t count);
+
+    /// <summary>
+    /// Returns the bounding box of the cells, which mustn't be empty. It's
+    /// extended as cells are added and only recomputed, from the first and
+    /// last cell of each row, after a cell on its edge was erased. Like the
+    /// other const members, it's safe to call from several threads at once.
+    /// </summary>
+    const bounds &extent() const;
+
+    /// <summary>
+    /// Returns the cells of the given row sorted by column or nullptr if the
+    /// row has no cells.
+    /// </summary>
+    const cell_row *row(row_t row) const;
+
+    /// <summary>
+    /// Returns the rows which have at least one cell in ascending order.
+    /// </summary>
+    std::vector<row_t> rows() const;
+
+    /// <summary>
+    /// Calls visit(row, cells) with the cells of each row from first_row to
+    /// last_row, inclusive, which has at least one cell in ascending order.
+    /// </summary>
+    template <typename Visit>
+    void for_each_row(row_t first_row, row_t last_row, Visit visit) const
+    {
+        if (last_row < first_row)
+        {
+            return;
+        }
+
+        auto block = std::lower_bound(blocks_.begin(), blocks_.end(), (first_row - 1) / block_rows,
+            [](const block_ptr &b, row_t index) { return b->index < index; });
+
+        for (; block != blocks_.end() && (*block)->index <= (last_row - 1) / block_rows; ++block)
+        {
+            const auto &rows = (*block)->rows;
+            const auto block_first = (*block)->index * block_rows + 1;
+            const auto begin = first_row > block_first ? first_row - block_first : 0;
+            const auto end = std::min<row_t>(block_rows, last_row - block_first + 1);
+
+            for (auto i = begin; i < end; ++i)
+            {
+                if (!rows[i].empty())
+                {
+                    visit(block_first + i, rows[i]);
+                }
+            }
+        }
+    }
+
+    /// <summary>
+    /// Returns the first row from first_row to last_row, inclusive, with at
+    /// least one cell for whose cells predicate returns true, or 0 if there's none.
+    /// Only rows with cells are visited.
+    /// </summary>
+    template <typename Predicate>
+    row_t find_row(row_t first_row, row_t last_row, Predicate predicate) const
+    {
+        if (last_row < first_row)
+        {
+            return 0;
+        }
+
+        auto block = std::lower_bound(blocks_.begin(), blocks_.end(), (first_row - 1) / block_rows,
+            [](const block_ptr &b, row_t index) { return b->index < index; });
+
+        for (; block != blocks_.end() && (*block)->index <= (last_row - 1) / block_rows; ++block)
+        {
+            const auto &rows = (*block)->rows;
+            const auto block_first = (*block)->index * block_rows + 1;
+            const auto begin = first_row > block_first ? first_row - block_first : 0;
+            const auto end = std::min<row_t>(block_rows, last_row - block_first + 1);
+
+            for (auto i = begin; i < end; ++i)
+            {
+                if (!rows[i].empty() && predicate(rows[i]))
+                {
+                    return block_first + i;
+                }
+            }
+        }
+
+        return 0;
+    }
+
+    /// <summary>
+    /// Returns the last row from first_row to last_row, inclusive, with at
+    /// least one cell for whose cells predicate returns true, or 0 if there's none.
+    /// Only rows with cells are visited.
+    /// </summary>
+    template <typename Predicate>
+    row_t find_last_row(row_t first_row, row_t last_row, Predicate predicate) const
+    {
+        if (last_row < first_row)
+        {
+            return 0;
+        }
+
+        auto block = std::upper_bound(blocks_.begin(), blocks_.end(), (last_row - 1) / block_rows,
+            [](row_t index, const block_ptr &b) { return index < b->index; });
+
+        while (block != blocks_.begin())
+        {
+            --block;
+
+            if ((*block)->index < (first_row - 1) / block_rows)
+            {
+                break;
+            }
+
+            const auto &rows = (*block)->rows;
+            const auto block_first = (*block)->index * block_rows + 1;
+            const auto begin = first_row > block_first ? first_row - block_first : 0;
+            const auto end = std::min<row_t>(block_rows, last_row - block_first + 1);
+
+            for (auto i = end; i > begin; --i)
+            {
+                if (!rows[i - 1].empty() && predicate(rows[i - 1]))
+                {
+                    return block_first + i - 1;
+                }
+            }
+        }
+
+        return 0;
+    }
+
+    /// <summary>
+    /// Returns empty extras from the arena for a cell of this store or nullptr
+    /// if the store has no arena. They're owned by the store.
+    /// </summary>
+    cell_extras *allocate_extras();
+
+    /// <summary>
+    /// Resets extras returned by allocate_extras and makes them available for reuse.
+    /// </summary>
+    void release_extras(cell_extras *extras);
+
+    /// <summary>
+    /// Moves extras owned by cell, which must be in this store, into the arena.
+    /// Does nothing if the store has no arena. This is needed after copying
+    /// another cell into a cell of the store.
+    /// </summary>
+    void adopt(cell_impl *cell);
+
+    /// <summary>
+    /// Returns an iterator to the first cell, detaching every block from copies of the store.
+    /// </summary>
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    bool operator==(const cell_store &other) const;
+
+private:
+    /// <summary>
+    /// Returns the cells of row or nullptr if its block doesn't exist and create
+    /// is false. The block is detached from copies of the store.
+    /// </summary>
+    cell_row *row_entries(row_t row, bool create);
+
+    /// <summary>
+    /// Returns the block with the given index or nullptr if there's none.
+    /// </summary>
+    const row_block *find_block(row_t index) const;
+
+    /// <summary>
+    /// Returns a new block of empty rows with the given index owned by the store.
+    /// </summary>
+    block_ptr new_block(row_t index);
+
+    /// <summary>
+    /// Returns true if the store created block and no copy of it shares the
+    /// block, so that the block and its cells may be changed.
+    /// </summary>
+    bool owned(const block_ptr &block) const
+    {
+        if (block->owner != id_ || block.use_count() > 1)
+        {
+            return false;
+        }
+
+        // stores release their references after their last read of the block
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        return true;
+    }
+
+    /// <summary>
+    /// Makes block private to the store and returns it. Unless the store
+    /// owns it, it's replaced by a copy with copies of its cells, leaving
+    /// the block itself unchanged.
+    /// </summary>
+    row_block &own(block_ptr &block);
+
+    /// <summary>
+    /// Calls own for every block from the one containing row on.
+    /// </summary>
+    void own_from(row_t row);
+
+    /// <summary>
+    /// Calls own for the block containing row if the store has it.
+    /// </summary>
+    void detach_row(row_t row);
+
+    /// <summary>
+    /// Returns the cell of the store at the position of cell after making its
+    /// block private, see detach.
+    /// </summary>
+    cell_impl *detach_cell(const cell_impl *cell);
+
+    /// <summary>
+    /// Returns the rows from first_row to last_row, inclusive, which have at least one cell.
+    /// </summary>
+    std::vector<row_t> rows(row_t first_row, row_t last_row) const;
+
+    /// <summary>
+    /// Moves every row from first_row on up or down by amount rows into rows
+    /// which must be empty. The blocks of the target rows are created first so
+    /// that the rows can then be moved walking the blocks without lookups.
+    /// </summary>
+    void shift_rows(row_t first_row, row_t amount, bool up);
+
+    /// <summary>
+    /// Extends the bounding box to include the cells of row from first_column
+    /// to last_column. Must be called before size_ is updated.
+    /// </summary>
+    void include(row_t row, column_t::index_t first_column, column_t::index_t last_column);
+
+    /// <summary>
+    /// Marks the bounding box for recomputation if a cell at row and column
+    /// which is about to be erased lies on its edge.
+    /// </summary>
+    void exclude(row_t row, column_t::index_t column);
+
+    /// <summary>
+    /// Returns an empty cell from the free list or the last chunk, allocating
+    /// a new chunk if it's full.
+    /// </summary>
+    cell_impl *allocate();
+
+    /// <summary>
+    /// Stores count empty cells in cells like calling allocate count times,
+    /// but taking runs of them from the last chunk at once.
+    /// </summary>
+    void allocate(std::size_t count, cell_impl **cells);
+
+    /// <summary>
+    /// Resets cell and returns it to the free list.
+    /// </summary>
+    void release(cell_impl *cell);
+
+    /// <summary>
+    /// Adds a chunk of size cells after retiring the previous one.
+    /// </summary>
+    void add_chunk(std::size_t size);
+
+    /// <summary>
+    /// Constructs the cells left in the last chunk and moves them to the free
+    /// list, so that every cell of the chunks is constructed.
+    /// </summary>
+    void retire_chunk();
+
+    /// <summary>
+    /// Destroys the extras allocated from the arena.
+    /// </summary>
+    void destroy_extras();
+
+    std::shared_ptr<arena> arena_;
+    worksheet_impl *parent_;
+
+    /// <summary>
+    /// Identifies the store as the owner of the blocks it creates. A moved
+    /// store takes the id along with its blocks.
+    /// </summary>
+    std::size_t id_;
+
+    /// <summary>
+    /// Held by the store and every copy sharing its blocks, so that a use
+    /// count of 1 tells the store that nothing else refers to its blocks
+    /// without the store it was copied from being written to. It's declared
+    /// before blocks_ so that a store releases it after its blocks.
+    /// </summary>
+    std::shared_ptr<const char> copies_;
+
+    std::vector<block_ptr> blocks_;
+    std::size_t size_;
+
+    /// <summary>
+    /// Set once the store took blocks from another store or copied one of
+    /// its blocks, so its cells may have copies elsewhere. Together with
+    /// copies_, it keeps detach free for stores which were never copied.
+    /// </summary>
+    bool shared_;
+
+    /// <summary>
+    /// The bounds are recomputed by extent, under bounds_mutex_, once
+    /// bounds_stale_ is set.
+    /// </summary>
+    mutable bounds bounds_;
+    mutable std::atomic<bool> bounds_stale_;
+    mutable std::mutex bounds_mutex_;
+
+    /// <summary>
+    /// The chunks allocated from the heap and those shared with the store
+    /// this one was copied from, chunks in the arena aren't tracked. The
+    /// cells of the last chunk are only constructed as they're handed out,
+    /// so that its memory is written once rather than when it's allocated and
+    /// again when the cells are used, see retire_chunk. Cells of shared
+    /// blocks are never freed or reused.
+    /// </summary>
+    std::vector<chunk_ptr> chunks_;
+    cell_impl *chunk_;
+    std::size_t chunk_size_;
+    std::size_t chunk_used_;
+    std::vector<cell_impl *> free_cells_;
+
+    std::vector<cell_extras *> extras_;
+    std::vector<cell_extras *> free_extras_;
+};
+
+} // namespace detail
+} // namespace xlnt
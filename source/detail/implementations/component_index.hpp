@@ -0,0 +1,104 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// A hash index on one of the component vectors of a stylesheet, such as its
+/// fonts. Items appended to the vector are indexed the next time the index is
+/// used, so code filling the vector doesn't need to know about it. The index
+/// must be cleared when items are removed or changed in place.
+/// </summary>
+template <typename T>
+class component_index
+{
+public:
+    /// <summary>
+    /// Returns the position of the first item in items which is equal to item,
+    /// after appending item if there is none.
+    /// </summary>
+    std::size_t find_or_add(std::vector<T> &items, const T &item)
+    {
+        update(items);
+
+        auto result = items.size();
+        auto matches = positions_.equal_range(std::hash<T>()(item));
+
+        for (auto match = matches.first; match != matches.second; ++match)
+        {
+            if (match->second < result && items[match->second] == item)
+            {
+                result = match->second;
+            }
+        }
+
+        if (result == items.size())
+        {
+            items.push_back(item);
+            update(items);
+        }
+
+        return result;
+    }
+
+    /// <summary>
+    /// Forgets every item.
+    /// </summary>
+    void clear()
+    {
+        positions_.clear();
+        indexed_ = 0;
+    }
+
+private:
+    void update(const std::vector<T> &items)
+    {
+        if (indexed_ > items.size())
+        {
+            clear();
+        }
+
+        for (; indexed_ < items.size(); ++indexed_)
+        {
+            positions_.emplace(std::hash<T>()(items[indexed_]), indexed_);
+        }
+    }
+
+    /// <summary>
+    /// The position of each indexed item by its hash.
+    /// </summary>
+    std::unordered_multimap<std::size_t, std::size_t> positions_;
+
+    std::size_t indexed_ = 0;
+};
+
+} // namespace detail
+} // namespace xlnt
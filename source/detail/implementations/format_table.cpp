@@ -0,0 +1,211 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <algorithm>
+#include <functional>
+#include <string>
+
+#include <detail/hash_combine.hpp>
+#include <detail/implementations/format_table.hpp>
+#include <xlnt/utils/exceptions.hpp>
+
+namespace {
+
+// Hashes everything operator== compares except the stylesheet, which is the
+// same for every format in a table.
+std::size_t content_hash(const xlnt::detail::format_impl &impl)
+{
+    using xlnt::detail::hash_combine;
+    std::size_t seed = 0;
+
+    hash_combine(seed, impl.alignment_id);
+    hash_combine(seed, impl.alignment_applied);
+    hash_combine(seed, impl.border_id);
+    hash_combine(seed, impl.border_applied);
+    hash_combine(seed, impl.fill_id);
+    hash_combine(seed, impl.fill_applied);
+    hash_combine(seed, impl.font_id);
+    hash_combine(seed, impl.font_applied);
+    hash_combine(seed, impl.number_format_id);
+    hash_combine(seed, impl.number_format_applied);
+    hash_combine(seed, impl.protection_id);
+    hash_combine(seed, impl.protection_applied);
+    hash_combine(seed, static_cast<std::size_t>(impl.pivot_button_));
+    hash_combine(seed, static_cast<std::size_t>(impl.quote_prefix_));
+    hash_combine(seed, impl.style.is_set() ? std::hash<std::string>()(impl.style.get()) : std::size_t(0));
+
+    return seed;
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+format_table::format_table(const format_table &other)
+{
+    *this = other;
+}
+
+format_table &format_table::operator=(const format_table &other)
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    formats_.clear();
+    formats_.reserve(other.formats_.size());
+
+    for (const auto &impl : other.formats_)
+    {
+        formats_.emplace_back(new format_impl(*impl));
+    }
+
+    reindex();
+
+    return *this;
+}
+
+std::size_t format_table::size() const
+{
+    return formats_.size();
+}
+
+format_impl &format_table::at(std::size_t id)
+{
+    if (id >= formats_.size())
+    {
+        throw invalid_parameter();
+    }
+
+    return *formats_[id];
+}
+
+const format_impl &format_table::at(std::size_t id) const
+{
+    if (id >= formats_.size())
+    {
+        throw invalid_parameter();
+    }
+
+    return *formats_[id];
+}
+
+format_impl &format_table::push_back(const format_impl &impl)
+{
+    formats_.emplace_back(new format_impl(impl));
+    auto &result = *formats_.back();
+    result.id = formats_.size() - 1;
+    index(result);
+
+    return result;
+}
+
+void format_table::pop_back()
+{
+    unindex(*formats_.back());
+    formats_.pop_back();
+}
+
+format_impl *format_table::find(const format_impl &pattern) const
+{
+    format_impl *result = nullptr;
+    auto matches = index_.equal_range(content_hash(pattern));
+
+    for (auto match = matches.first; match != matches.second; ++match)
+    {
+        if (*match->second == pattern && (result == nullptr || match->second->id < result->id))
+        {
+            result = match->second;
+        }
+    }
+
+    return result;
+}
+
+void format_table::erase_unreferenced()
+{
+    for (const auto &impl : formats_)
+    {
+        if (impl->references == 0)
+        {
+            unindex(*impl);
+        }
+    }
+
+    auto unreferenced = [](const std::unique_ptr<format_impl> &impl) { return impl->references == 0; };
+    formats_.erase(std::remove_if(formats_.begin(), formats_.end(), unreferenced), formats_.end());
+
+    for (std::size_t id = 0; id < formats_.size(); ++id)
+    {
+        formats_[id]->id = id;
+    }
+}
+
+void format_table::reindex()
+{
+    index_.clear();
+    index_.reserve(formats_.size());
+
+    for (const auto &impl : formats_)
+    {
+        index(*impl);
+    }
+}
+
+void format_table::clear()
+{
+    formats_.clear();
+    index_.clear();
+}
+
+bool format_table::operator==(const format_table &other) const
+{
+    auto equal = [](const std::unique_ptr<format_impl> &lhs, const std::unique_ptr<format_impl> &rhs) { return *lhs == *rhs; };
+
+    return formats_.size() == other.formats_.size()
+        && std::equal(formats_.begin(), formats_.end(), other.formats_.begin(), equal);
+}
+
+void format_table::index(format_impl &impl)
+{
+    index_.emplace(content_hash(impl), &impl);
+}
+
+void format_table::unindex(format_impl &impl)
+{
+    auto matches = index_.equal_range(content_hash(impl));
+
+    for (auto match = matches.first; match != matches.second; ++match)
+    {
+        if (match->second == &impl)
+        {
+            index_.erase(match);
+            return;
+        }
+    }
+}
+
+} // namespace detail
+} // namespace xlnt
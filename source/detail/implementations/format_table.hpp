@@ -0,0 +1,131 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <detail/implementations/format_impl.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// The cell formats of a stylesheet. Each format is allocated on its own so
+/// its address, which cells keep, doesn't change as formats are added or
+/// removed, and formats are found by id and by content in constant time.
+/// A format must be unindexed before it's changed in place and indexed again
+/// afterwards, see modify.
+/// </summary>
+class format_table
+{
+public:
+    format_table() = default;
+    format_table(const format_table &other);
+    format_table(format_table &&other) = default;
+    format_table &operator=(const format_table &other);
+    format_table &operator=(format_table &&other) = default;
+
+    /// <summary>
+    /// Returns the number of formats.
+    /// </summary>
+    std::size_t size() const;
+
+    /// <summary>
+    /// Returns the format with the given id. Throws invalid_parameter if
+    /// there is none.
+    /// </summary>
+    format_impl &at(std::size_t id);
+
+    /// <summary>
+    /// Returns the format with the given id. Throws invalid_parameter if
+    /// there is none.
+    /// </summary>
+    const format_impl &at(std::size_t id) const;
+
+    /// <summary>
+    /// Appends a copy of impl with the next id and returns it.
+    /// </summary>
+    format_impl &push_back(const format_impl &impl);
+
+    /// <summary>
+    /// Removes the format with the highest id.
+    /// </summary>
+    void pop_back();
+
+    /// <summary>
+    /// Returns the format with the lowest id which is equal to pattern, or
+    /// nullptr if there is none.
+    /// </summary>
+    format_impl *find(const format_impl &pattern) const;
+
+    /// <summary>
+    /// Calls change with impl, which must be in this table, keeping the
+    /// index up to date.
+    /// </summary>
+    template <typename Change>
+    void modify(format_impl &impl, Change change)
+    {
+        unindex(impl);
+        change(impl);
+        index(impl);
+    }
+
+    /// <summary>
+    /// Removes the formats without references and gives those left the ids
+    /// 0 to size() - 1 in order.
+    /// </summary>
+    void erase_unreferenced();
+
+    /// <summary>
+    /// Rebuilds the index after the content of many formats has changed.
+    /// </summary>
+    void reindex();
+
+    /// <summary>
+    /// Removes every format.
+    /// </summary>
+    void clear();
+
+    /// <summary>
+    /// Returns true if each format is equal to the one with the same id in other.
+    /// </summary>
+    bool operator==(const format_table &other) const;
+
+private:
+    void index(format_impl &impl);
+    void unindex(format_impl &impl);
+
+    std::vector<std::unique_ptr<format_impl>> formats_;
+
+    /// <summary>
+    /// Every format by the hash of its content.
+    /// </summary>
+    std::unordered_multimap<std::size_t, format_impl *> index_;
+};
+
+} // namespace detail
+} // namespace xlnt
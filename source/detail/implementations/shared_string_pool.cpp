@@ -0,0 +1,415 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <detail/implementations/shared_string_pool.hpp>
+
+namespace {
+
+// plain strings longer than this are kept as rich_text
+const std::size_t max_plain_size = (std::size_t(1) << 29) - 1;
+const std::size_t first_slot_count = 16;
+
+// FNV-1a, which can be run over the text of several runs one after another
+const std::uint64_t fnv_offset_basis = 14695981039346656037ULL;
+const std::uint64_t fnv_prime = 1099511628211ULL;
+
+std::uint64_t hash_bytes(std::uint64_t hash, const char *data, std::size_t size)
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= fnv_prime;
+    }
+
+    return hash;
+}
+
+// mixes the high bits into the low ones, which pick the slot
+std::uint32_t finish_hash(std::uint64_t hash)
+{
+    hash ^= hash >> 32;
+    hash *= 0xd6e8feb86659fd93ULL;
+    hash ^= hash >> 32;
+
+    return static_cast<std::uint32_t>(hash);
+}
+
+std::uint32_t hash_text(const char *data, std::size_t size)
+{
+    return finish_hash(hash_bytes(fnv_offset_basis, data, size));
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+shared_string_pool::shared_string_pool()
+    : indexed_(0),
+      unpacked_(false)
+{
+}
+
+shared_string_pool::shared_string_pool(const shared_string_pool &other)
+    : chars_(other.chars_),
+      rich_(other.rich_),
+      entries_(other.entries_),
+      slots_(other.slots_),
+      indexed_(other.indexed_),
+      unpacked_(other.unpacked_)
+{
+}
+
+shared_string_pool &shared_string_pool::operator=(const shared_string_pool &other)
+{
+    if (this != &other)
+    {
+        chars_ = other.chars_;
+        rich_ = other.rich_;
+        entries_ = other.entries_;
+        slots_ = other.slots_;
+        indexed_ = other.indexed_;
+        unpacked_ = other.unpacked_;
+        std::vector<rich_text>().swap(values_);
+    }
+
+    return *this;
+}
+
+std::size_t shared_string_pool::size() const
+{
+    return unpacked_ ? rich_.size() : entries_.size();
+}
+
+std::size_t shared_string_pool::add(const rich_text &text, bool allow_duplicates)
+{
+    if (!unpacked_ && is_plain(text))
+    {
+        const auto &run = text.runs_.front();
+        return add(run.first.data(), run.first.size(), run.preserve_space, allow_duplicates);
+    }
+
+    return add_rich(text, hash(text), allow_duplicates);
+}
+
+std::size_t shared_string_pool::add(const char *data, std::size_t size, bool preserve_space, bool allow_duplicates)
+{
+    if (unpacked_ || size > max_plain_size)
+    {
+        return add_rich(rich_text(rich_text_run{std::string(data, size), optional<font>(), preserve_space}),
+            hash_text(data, size), allow_duplicates);
+    }
+
+    const auto text_hash = hash_text(data, size);
+    const auto existing = find(data, size, text_hash);
+    const auto found = existing != entries_.size();
+
+    if (found && !allow_duplicates)
+    {
+        return existing;
+    }
+
+    entry new_entry;
+    new_entry.offset = chars_.size();
+    new_entry.hash = text_hash;
+    new_entry.size = static_cast<std::uint32_t>(size);
+    new_entry.rich = 0;
+    new_entry.preserve_space = preserve_space ? 1 : 0;
+    new_entry.indexed = 0;
+
+    chars_.append(data, size);
+    entries_.push_back(new_entry);
+
+    if (!found)
+    {
+        index(entries_.size() - 1);
+    }
+
+    return entries_.size() - 1;
+}
+
+std::size_t shared_string_pool::add_rich(const rich_text &text, std::uint32_t text_hash, bool allow_duplicates)
+{
+    const auto result = size();
+    const auto existing = find(text, text_hash);
+    const auto found = existing != result;
+
+    if (found && !allow_duplicates)
+    {
+        return existing;
+    }
+
+    entry new_entry;
+    new_entry.offset = rich_.size();
+    new_entry.hash = text_hash;
+    new_entry.size = 0;
+    new_entry.rich = 1;
+    new_entry.preserve_space = 0;
+    new_entry.indexed = 0;
+
+    rich_.push_back(text);
+    entries_.push_back(new_entry);
+
+    if (!found)
+    {
+        index(entries_.size() - 1);
+    }
+
+    return result;
+}
+
+std::size_t shared_string_pool::find(const rich_text &text) const
+{
+    if (!unpacked_ && is_plain(text))
+    {
+        const auto &run = text.runs_.front();
+        return find(run.first.data(), run.first.size());
+    }
+
+    return find(text, hash(text));
+}
+
+std::size_t shared_string_pool::find(const char *data, std::size_t size) const
+{
+    if (unpacked_ || size > max_plain_size)
+    {
+        return find(rich_text(rich_text_run{std::string(data, size), optional<font>(), false}),
+            hash_text(data, size));
+    }
+
+    return find(data, size, hash_text(data, size));
+}
+
+std::size_t shared_string_pool::find(const char *data, std::size_t size, std::uint32_t text_hash) const
+{
+    if (slots_.empty())
+    {
+        return this->size();
+    }
+
+    const auto mask = slots_.size() - 1;
+
+    for (auto slot = text_hash & mask; slots_[slot] != 0; slot = (slot + 1) & mask)
+    {
+        const auto &candidate = entries_[slots_[slot] - 1];
+
+        if (candidate.hash == text_hash && !candidate.rich && candidate.size == size
+            && chars_.compare(candidate.offset, size, data, size) == 0)
+        {
+            return slots_[slot] - 1;
+        }
+    }
+
+    return this->size();
+}
+
+std::size_t shared_string_pool::find(const rich_text &text, std::uint32_t text_hash) const
+{
+    if (slots_.empty())
+    {
+        return size();
+    }
+
+    const auto mask = slots_.size() - 1;
+
+    for (auto slot = text_hash & mask; slots_[slot] != 0; slot = (slot + 1) & mask)
+    {
+        const auto &candidate = entries_[slots_[slot] - 1];
+
+        // strings changed through modifiable_values may have been removed
+        if (candidate.hash == text_hash && candidate.rich && candidate.offset < rich_.size()
+            && rich_[candidate.offset] == text)
+        {
+            return unpacked_ ? candidate.offset : slots_[slot] - 1;
+        }
+    }
+
+    return size();
+}
+
+bool shared_string_pool::is_plain(std::size_t index) const
+{
+    return !unpacked_ && !entries_[index].rich;
+}
+
+bool shared_string_pool::preserve_space(std::size_t index) const
+{
+    return entries_[index].preserve_space != 0;
+}
+
+const rich_text &shared_string_pool::rich(std::size_t index) const
+{
+    return unpacked_ ? rich_[index] : rich_[entries_[index].offset];
+}
+
+std::string shared_string_pool::plain_text(std::size_t index) const
+{
+    if (is_plain(index))
+    {
+        const auto &plain = entries_[index];
+        return chars_.substr(plain.offset, plain.size);
+    }
+
+    return rich(index).plain_text();
+}
+
+rich_text shared_string_pool::value(std::size_t index) const
+{
+    if (is_plain(index))
+    {
+        return rich_text(rich_text_run{plain_text(index), optional<font>(), preserve_space(index)});
+    }
+
+    return rich(index);
+}
+
+const std::vector<rich_text> &shared_string_pool::values() const
+{
+    if (unpacked_)
+    {
+        return rich_;
+    }
+
+    std::lock_guard<std::mutex> lock(values_mutex_);
+    values_.reserve(entries_.size());
+
+    for (auto index = values_.size(); index < entries_.size(); ++index)
+    {
+        values_.push_back(value(index));
+    }
+
+    return values_;
+}
+
+std::vector<rich_text> &shared_string_pool::modifiable_values()
+{
+    if (!unpacked_)
+    {
+        // converts the strings values() hasn't yet
+        values();
+        rich_.swap(values_);
+        std::vector<rich_text>().swap(values_);
+        std::string().swap(chars_);
+
+        for (std::size_t index = 0; index < entries_.size(); ++index)
+        {
+            entries_[index].offset = index;
+            entries_[index].rich = 1;
+        }
+
+        unpacked_ = true;
+    }
+
+    return rich_;
+}
+
+bool shared_string_pool::operator==(const shared_string_pool &other) const
+{
+    if (size() != other.size())
+    {
+        return false;
+    }
+
+    for (std::size_t index = 0; index < size(); ++index)
+    {
+        if (is_plain(index) && other.is_plain(index))
+        {
+            const auto &lhs = entries_[index];
+            const auto &rhs = other.entries_[index];
+
+            if (chars_.compare(lhs.offset, lhs.size, other.chars_, rhs.offset, rhs.size) != 0)
+            {
+                return false;
+            }
+        }
+        else if (value(index) != other.value(index))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool shared_string_pool::is_plain(const rich_text &text)
+{
+    return text.runs_.size() == 1 && !text.runs_.front().second.is_set()
+        && text.phonetic_runs_.empty() && !text.phonetic_properties_.is_set();
+}
+
+std::uint32_t shared_string_pool::hash(const rich_text &text)
+{
+    auto result = fnv_offset_basis;
+
+    for (const auto &run : text.runs_)
+    {
+        result = hash_bytes(result, run.first.data(), run.first.size());
+    }
+
+    return finish_hash(result);
+}
+
+void shared_string_pool::index(std::size_t entry_index)
+{
+    if ((indexed_ + 1) * 2 > slots_.size())
+    {
+        grow_slots();
+    }
+
+    const auto mask = slots_.size() - 1;
+    auto slot = entries_[entry_index].hash & mask;
+
+    while (slots_[slot] != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+
+    slots_[slot] = static_cast<std::uint32_t>(entry_index + 1);
+    entries_[entry_index].indexed = 1;
+    ++indexed_;
+}
+
+void shared_string_pool::grow_slots()
+{
+    std::vector<std::uint32_t> slots(slots_.empty() ? first_slot_count : slots_.size() * 2, 0);
+    const auto mask = slots.size() - 1;
+
+    for (std::size_t entry_index = 0; entry_index < entries_.size(); ++entry_index)
+    {
+        if (!entries_[entry_index].indexed) continue;
+
+        auto slot = entries_[entry_index].hash & mask;
+
+        while (slots[slot] != 0)
+        {
+            slot = (slot + 1) & mask;
+        }
+
+        slots[slot] = static_cast<std::uint32_t>(entry_index + 1);
+    }
+
+    slots_.swap(slots);
+}
+
+} // namespace detail
+} // namespace xlnt
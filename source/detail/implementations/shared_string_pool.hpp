@@ -0,0 +1,187 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <xlnt/cell/rich_text.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// The shared strings of a workbook. Most shared strings have no formatting,
+/// so these are kept as UTF-8 back to back in one buffer and only strings with
+/// formatted runs or phonetic text are kept as rich_text. Strings are found by
+/// their text through an open addressing hash table, so finding a plain string
+/// which is already in the pool doesn't allocate.
+/// </summary>
+class shared_string_pool
+{
+public:
+    shared_string_pool();
+
+    /// <summary>
+    /// Copies the strings of other, but not the rich_text converted by values().
+    /// </summary>
+    shared_string_pool(const shared_string_pool &other);
+
+    /// <summary>
+    /// Replaces the strings with those of other, see the copy constructor.
+    /// </summary>
+    shared_string_pool &operator=(const shared_string_pool &other);
+
+    /// <summary>
+    /// Returns the number of strings.
+    /// </summary>
+    std::size_t size() const;
+
+    /// <summary>
+    /// Appends text and returns its index. If allow_duplicates is false and an
+    /// equal string is already in the pool, returns the index of that instead.
+    /// </summary>
+    std::size_t add(const rich_text &text, bool allow_duplicates);
+
+    /// <summary>
+    /// Appends the unformatted text of size bytes at data like add(rich_text),
+    /// without constructing a rich_text.
+    /// </summary>
+    std::size_t add(const char *data, std::size_t size, bool preserve_space, bool allow_duplicates);
+
+    /// <summary>
+    /// Returns the index of the first string equal to text, or size() if
+    /// there is none.
+    /// </summary>
+    std::size_t find(const rich_text &text) const;
+
+    /// <summary>
+    /// Returns the index of the first unformatted string with the size bytes
+    /// at data as its text, or size() if there is none.
+    /// </summary>
+    std::size_t find(const char *data, std::size_t size) const;
+
+    /// <summary>
+    /// Returns true if the string at index is kept as plain text.
+    /// </summary>
+    bool is_plain(std::size_t index) const;
+
+    /// <summary>
+    /// Returns true if the spaces around the plain string at index must be
+    /// kept when it's written.
+    /// </summary>
+    bool preserve_space(std::size_t index) const;
+
+    /// <summary>
+    /// Returns the rich string at index, which must not be plain.
+    /// </summary>
+    const rich_text &rich(std::size_t index) const;
+
+    /// <summary>
+    /// Returns the text of the string at index without formatting.
+    /// </summary>
+    std::string plain_text(std::size_t index) const;
+
+    /// <summary>
+    /// Returns the string at index as rich_text.
+    /// </summary>
+    rich_text value(std::size_t index) const;
+
+    /// <summary>
+    /// Returns every string as rich_text. The strings are converted when this
+    /// is first called and kept along with the pool after that. Pools are shared
+    /// by copies of a workbook, so the conversion is done under a lock.
+    /// </summary>
+    const std::vector<rich_text> &values() const;
+
+    /// <summary>
+    /// Returns the strings for changing them in place. From then on every
+    /// string is kept as rich_text in the returned vector, as strings were
+    /// before the pool, and changed strings are no longer found by text.
+    /// </summary>
+    std::vector<rich_text> &modifiable_values();
+
+    /// <summary>
+    /// Returns true if each string is equal to the string at the same index
+    /// in other.
+    /// </summary>
+    bool operator==(const shared_string_pool &other) const;
+
+private:
+    /// <summary>
+    /// Where a string is kept. For plain strings offset is the position of
+    /// the first byte in chars_, otherwise the index in rich_.
+    /// </summary>
+    struct entry
+    {
+        std::size_t offset;
+        std::uint32_t hash;
+        std::uint32_t size : 29;
+        std::uint32_t rich : 1;
+        std::uint32_t preserve_space : 1;
+        std::uint32_t indexed : 1;
+    };
+
+    static bool is_plain(const rich_text &text);
+    static std::uint32_t hash(const rich_text &text);
+
+    std::size_t find(const char *data, std::size_t size, std::uint32_t hash) const;
+    std::size_t find(const rich_text &text, std::uint32_t hash) const;
+    std::size_t add_rich(const rich_text &text, std::uint32_t hash, bool allow_duplicates);
+    void index(std::size_t entry_index);
+    void grow_slots();
+
+    /// <summary>
+    /// The bytes of the plain strings.
+    /// </summary>
+    std::string chars_;
+
+    /// <summary>
+    /// The strings with formatting, or after modifiable_values every string.
+    /// </summary>
+    std::vector<rich_text> rich_;
+
+    std::vector<entry> entries_;
+
+    /// <summary>
+    /// The hash table, each slot is the index of an entry plus one or zero if
+    /// it's empty. The first of equal strings is the only one indexed.
+    /// </summary>
+    std::vector<std::uint32_t> slots_;
+    std::size_t indexed_;
+
+    /// <summary>
+    /// The strings converted to rich_text by values().
+    /// </summary>
+    mutable std::vector<rich_text> values_;
+    mutable std::mutex values_mutex_;
+
+    bool unpacked_;
+};
+
+} // namespace detail
+} // namespace xlnt
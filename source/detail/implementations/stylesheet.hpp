@@ -27,9 +27,13 @@
 #include <string>
 #include <vector>
 
+#include <detail/implementations/cell_impl.hpp>
+#include <detail/implementations/component_index.hpp>
 #include <detail/implementations/conditional_format_impl.hpp>
 #include <detail/implementations/format_impl.hpp>
+#include <detail/implementations/format_table.hpp>
 #include <detail/implementations/style_impl.hpp>
+#include <detail/number_format/number_format_cache.hpp>
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/styles/conditional_format.hpp>
 #include <xlnt/styles/format.hpp>
@@ -46,23 +50,16 @@ struct stylesheet
 {
     class format create_format(bool default_format)
     {
-		format_impls.push_back(format_impl());
-		auto &impl = format_impls.back();
+        format_impl new_format;
+        new_format.parent = this;
+        new_format.references = default_format ? 1 : 0;
 
-		impl.parent = this;
-		impl.id = format_impls.size() - 1;
-
-        impl.references = default_format ? 1 : 0;
-        
-        return xlnt::format(&impl);
+        return xlnt::format(&format_impls.push_back(new_format));
     }
 
     class xlnt::format format(std::size_t index)
     {
-        auto iter = format_impls.begin();
-        std::advance(iter, static_cast<std::list<format_impl>::difference_type>(index));
-
-        return xlnt::format(&*iter);
+        return xlnt::format(&format_impls.at(index));
     }
 
     class style create_style(const std::string &name)
@@ -172,21 +169,42 @@ struct stylesheet
 		return id;
 	}
     
-    template<typename T, typename C>
-    std::size_t find_or_add(C &container, const T &item)
+    template<typename T>
+    std::size_t find_or_add(std::vector<T> &container, const T &item)
     {
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wsign-conversion"
-        auto iter = std::find(container.begin(), container.end(), item);
-        if (iter != container.end())
-        {
-            return std::size_t(iter - container.begin());
-        }
-        iter = container.emplace(container.end(), item);
-        return std::size_t(iter - container.begin());
-#pragma GCC diagnostic pop
+        return component_index_for(container).find_or_add(container, item);
     }
-    
+
+    component_index<alignment> &component_index_for(const std::vector<alignment> &)
+    {
+        return alignment_index;
+    }
+
+    component_index<border> &component_index_for(const std::vector<border> &)
+    {
+        return border_index;
+    }
+
+    component_index<fill> &component_index_for(const std::vector<fill> &)
+    {
+        return fill_index;
+    }
+
+    component_index<font> &component_index_for(const std::vector<font> &)
+    {
+        return font_index;
+    }
+
+    component_index<number_format> &component_index_for(const std::vector<number_format> &)
+    {
+        return number_format_index;
+    }
+
+    component_index<protection> &component_index_for(const std::vector<protection> &)
+    {
+        return protection_index;
+    }
+
     template<typename T>
     std::unordered_map<std::size_t, std::size_t> garbage_collect(
         const std::unordered_map<std::size_t, std::size_t> &reference_counts,
@@ -207,29 +225,20 @@ struct stylesheet
             }
         }
 
+        if (unreferenced > 0)
+        {
+            component_index_for(container).clear();
+        }
+
         return id_map;
     }
     
     void garbage_collect()
     {
         if (!garbage_collection_enabled) return;
-        
-        auto format_iter = format_impls.begin();
-        while (format_iter != format_impls.end())
-        {
-            auto &impl = *format_iter;
 
-            if (impl.references != 0)
-            {
-                ++format_iter;
-            }
-            else
-            {
-                format_iter = format_impls.erase(format_iter);
-            }
-        }
-        
-        std::size_t new_id = 0;
+        garbage = false;
+        format_impls.erase_unreferenced();
 
         std::unordered_map<std::size_t, std::size_t> alignment_reference_counts;
         std::unordered_map<std::size_t, std::size_t> border_reference_counts;
@@ -241,10 +250,10 @@ struct stylesheet
         fill_reference_counts[0]++;
         fill_reference_counts[1]++;
         
-        for (auto &impl : format_impls)
+        for (std::size_t id = 0; id < format_impls.size(); ++id)
         {
-            impl.id = new_id++;
-            
+            const auto &impl = format_impls.at(id);
+
             if (impl.alignment_id.is_set())
             {
                 alignment_reference_counts[impl.alignment_id.get()]++;
@@ -317,8 +326,10 @@ struct stylesheet
         auto font_id_map = garbage_collect(font_reference_counts, fonts);
         auto protection_id_map = garbage_collect(protection_reference_counts, protections);
 
-        for (auto &impl : format_impls)
+        for (std::size_t id = 0; id < format_impls.size(); ++id)
         {
+            auto &impl = format_impls.at(id);
+
             if (impl.alignment_id.is_set())
             {
                 impl.alignment_id = alignment_id_map[impl.alignment_id.get()];
@@ -374,37 +385,81 @@ struct stylesheet
                 impl.protection_id = protection_id_map[impl.protection_id.get()];
             }
         }
+
+        // the component ids of the formats have changed
+        format_impls.reindex();
     }
 
+    /// <summary>
+    /// Returns the format equal to pattern, adding it if there's none. The
+    /// format pattern was made from is dropped if no cell uses it.
+    /// </summary>
     format_impl *find_or_create(format_impl &pattern)
     {
         pattern.references = 0;
-        std::size_t id = 0;
-        auto iter = format_impls.begin();
-        while (iter != format_impls.end() && !(*iter == pattern))
+        auto result = format_impls.find(pattern);
+
+        if (result == nullptr)
         {
-            ++id;
-            ++iter;
+            result = &format_impls.push_back(pattern);
         }
-        if (iter == format_impls.end())
+
+        result->parent = this;
+
+        if (result->id != pattern.id)
         {
-            iter = format_impls.emplace(format_impls.end(), pattern);
+            auto &replaced = format_impls.at(pattern.id);
+
+            if (replaced.references == 0 && garbage_collection_enabled)
+            {
+                // a format made by create_format for an unformatted cell is
+                // usually the last one and can go right away
+                if (replaced.id + 1 == format_impls.size())
+                {
+                    format_impls.pop_back();
+                }
+                else
+                {
+                    garbage = true;
+                }
+            }
         }
-        auto &result = *iter;
 
-        result.parent = this;
-        result.id = id;
-        result.references++;
-        
-        if (id != pattern.id)
+        return result;
+    }
+
+    /// <summary>
+    /// Gives cell the format target, or no format if target is null. Each
+    /// cell using a format holds one reference to it, counted here or, for
+    /// cells read from a file, once their worksheet is read. Default formats
+    /// and formats read from a file hold one more. Removed cells keep
+    /// theirs, so a format is never dropped while a cell uses it. A format
+    /// left without references is removed when the workbook is saved.
+    /// </summary>
+    static void restyle(cell_impl &cell, format_impl *target)
+    {
+        if (cell.format_ == target)
+        {
+            return;
+        }
+
+        if (cell.format_ != nullptr)
+        {
+            auto &source = *cell.format_;
+            source.references -= source.references > 0 ? 1 : 0;
+
+            if (source.references == 0)
+            {
+                source.parent->garbage = true;
+            }
+        }
+
+        if (target != nullptr)
         {
-            iter = format_impls.begin();
-            std::advance(iter, static_cast<std::list<format_impl>::difference_type>(pattern.id));
-            iter->references -= iter->references > 0 ? 1 : 0;
-            garbage_collect();
+            ++target->references;
         }
 
-        return &result;
+        cell.format_ = target;
     }
 
     format_impl *find_or_create_with(format_impl *pattern, const std::string &style_name)
@@ -413,7 +468,7 @@ struct stylesheet
         new_format.style = style_name;
         if (pattern->references == 0)
         {
-            *pattern = new_format;
+            format_impls.modify(*pattern, [&](format_impl &impl) { impl = new_format; });
         }
         return find_or_create(new_format);
     }
@@ -425,7 +480,7 @@ struct stylesheet
         new_format.alignment_applied = applied;
         if (pattern->references == 0)
         {
-            *pattern = new_format;
+            format_impls.modify(*pattern, [&](format_impl &impl) { impl = new_format; });
         }
         return find_or_create(new_format);
     }
@@ -437,7 +492,7 @@ struct stylesheet
         new_format.border_applied = applied;
         if (pattern->references == 0)
         {
-            *pattern = new_format;
+            format_impls.modify(*pattern, [&](format_impl &impl) { impl = new_format; });
         }
         return find_or_create(new_format);
     }
@@ -449,7 +504,7 @@ struct stylesheet
         new_format.fill_applied = applied;
         if (pattern->references == 0)
         {
-            *pattern = new_format;
+            format_impls.modify(*pattern, [&](format_impl &impl) { impl = new_format; });
         }
         return find_or_create(new_format);
     }
@@ -461,7 +516,7 @@ struct stylesheet
         new_format.font_applied = applied;
         if (pattern->references == 0)
         {
-            *pattern = new_format;
+            format_impls.modify(*pattern, [&](format_impl &impl) { impl = new_format; });
         }
         return find_or_create(new_format);
     }
@@ -477,7 +532,7 @@ struct stylesheet
         new_format.number_format_applied = applied;
         if (pattern->references == 0)
         {
-            *pattern = new_format;
+            format_impls.modify(*pattern, [&](format_impl &impl) { impl = new_format; });
         }
         return find_or_create(new_format);
     }
@@ -489,7 +544,7 @@ struct stylesheet
         new_format.protection_applied = applied;
         if (pattern->references == 0)
         {
-            *pattern = new_format;
+            format_impls.modify(*pattern, [&](format_impl &impl) { impl = new_format; });
         }
         return find_or_create(new_format);
     }
@@ -514,6 +569,15 @@ struct stylesheet
         fonts.clear();
         number_formats.clear();
         protections.clear();
+
+        alignment_index.clear();
+        border_index.clear();
+        fill_index.clear();
+        font_index.clear();
+        number_format_index.clear();
+        protection_index.clear();
+
+        compiled_number_formats.clear();
         
         colors.clear();
     }
@@ -556,8 +620,17 @@ struct stylesheet
     bool garbage_collection_enabled = true;
     bool known_fonts_enabled = false;
 
+    /// <summary>
+    /// Set when restyling a cell leaves a format without references. Such
+    /// formats and the components only they use are removed by
+    /// garbage_collect when the workbook is saved or compact_styles is
+    /// called rather than after each change, which would make restyling
+    /// n cells take O(n * formats).
+    /// </summary>
+    bool garbage = false;
+
 	std::list<conditional_format_impl> conditional_format_impls;
-    std::list<format_impl> format_impls;
+    format_table format_impls;
     std::unordered_map<std::string, style_impl> style_impls;
     std::vector<std::string> style_names;
     optional<std::string> default_slicer_style;
@@ -568,6 +641,21 @@ struct stylesheet
     std::vector<font> fonts;
     std::vector<number_format> number_formats;
 	std::vector<protection> protections;
+
+    /// <summary>
+    /// Hash indices on the component vectors above, see find_or_add.
+    /// </summary>
+    component_index<alignment> alignment_index;
+    component_index<border> border_index;
+    component_index<fill> fill_index;
+    component_index<font> font_index;
+    component_index<number_format> number_format_index;
+    component_index<protection> protection_index;
+
+    /// <summary>
+    /// The number formats used to display cells, compiled once by id.
+    /// </summary>
+    number_format_cache compiled_number_formats;
     
     std::vector<color> colors;
 };
@@ -22,11 +22,16 @@
 // @author: see AUTHORS file
 #pragma once
 
+#include <atomic>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include <detail/implementations/arena.hpp>
+#include <detail/implementations/shared_string_pool.hpp>
 #include <detail/implementations/stylesheet.hpp>
 #include <detail/implementations/worksheet_impl.hpp>
 #include <xlnt/packaging/ext_list.hpp>
@@ -47,15 +52,18 @@ struct worksheet_impl;
 
 struct workbook_impl
 {
-    workbook_impl() : base_date_(calendar::windows_1900)
+    workbook_impl()
+        : cell_arenas_(false),
+          shared_strings_(std::make_shared<shared_string_pool>()),
+          base_date_(calendar::windows_1900)
     {
     }
 
     workbook_impl(const workbook_impl &other)
         : active_sheet_index_(other.active_sheet_index_),
+          cell_arenas_(false),
           worksheets_(other.worksheets_),
-          shared_strings_ids_(other.shared_strings_ids_),
-          shared_strings_values_(other.shared_strings_values_),
+          shared_strings_(other.shared_strings_),
           stylesheet_(other.stylesheet_),
           manifest_(other.manifest_),
           theme_(other.theme_),
@@ -73,8 +81,9 @@ struct workbook_impl
         active_sheet_index_ = other.active_sheet_index_;
         worksheets_.clear();
         std::copy(other.worksheets_.begin(), other.worksheets_.end(), back_inserter(worksheets_));
-        shared_strings_ids_ = other.shared_strings_ids_;
-        shared_strings_values_ = other.shared_strings_values_;
+        // the copied cells are on the heap
+        cell_arenas_ = false;
+        shared_strings_ = other.shared_strings_;
         theme_ = other.theme_;
         manifest_ = other.manifest_;
 
@@ -95,7 +104,7 @@ struct workbook_impl
     {
         return active_sheet_index_ == other.active_sheet_index_
             && worksheets_ == other.worksheets_
-            && shared_strings_ids_ == other.shared_strings_ids_
+            && *shared_strings_ == *other.shared_strings_
             && stylesheet_ == other.stylesheet_
             && base_date_ == other.base_date_
             && title_ == other.title_
@@ -119,9 +128,46 @@ struct workbook_impl
 
     optional<std::size_t> active_sheet_index_;
 
+    /// <summary>
+    /// True if the cells of new worksheets are allocated from an arena. Each
+    /// worksheet has its own so that they can be built on different threads.
+    /// </summary>
+    bool cell_arenas_;
+
+    /// <summary>
+    /// Serializes reading the worksheets of a workbook loaded with
+    /// load_options::lazy_worksheets, which may be accessed from several
+    /// threads through the const accessors. It's recursive since reading a
+    /// worksheet may look up others. Not copied.
+    /// </summary>
+    std::recursive_mutex deferred_mutex_;
+
     std::list<worksheet_impl> worksheets_;
-    std::unordered_map<rich_text, std::size_t, rich_text_hash> shared_strings_ids_;
-    std::vector<rich_text> shared_strings_values_;
+
+    /// <summary>
+    /// Shared by copies of the workbook until one of them changes it, see
+    /// modifiable_shared_strings.
+    /// </summary>
+    std::shared_ptr<shared_string_pool> shared_strings_;
+
+    /// <summary>
+    /// Returns the shared strings after copying them if they're shared with
+    /// a copy of the workbook.
+    /// </summary>
+    shared_string_pool &modifiable_shared_strings()
+    {
+        if (shared_strings_.use_count() > 1)
+        {
+            shared_strings_ = std::make_shared<shared_string_pool>(*shared_strings_);
+        }
+        else
+        {
+            // copies release the strings after their last read of them
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+
+        return *shared_strings_;
+    }
 
     optional<stylesheet> stylesheet_;
 
@@ -23,6 +23,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -40,7 +43,7 @@
 #include <xlnt/worksheet/sheet_view.hpp>
 #include <xlnt/worksheet/print_options.hpp>
 #include <xlnt/worksheet/sheet_pr.hpp>
-#include <detail/implementations/cell_impl.hpp>
+#include <detail/implementations/cell_store.hpp>
 
 namespace xlnt {
 
@@ -48,17 +51,23 @@ class workbook;
 
 namespace detail {
 
+struct deferred_worksheet;
+
 struct worksheet_impl
 {
     worksheet_impl(workbook *parent_workbook, std::size_t id, const std::string &title)
         : parent_(parent_workbook),
           id_(id),
-          title_(title)
+          title_(title),
+          deferred_pending_(false)
     {
+        cells_.parent(this);
     }
 
     worksheet_impl(const worksheet_impl &other)
+        : deferred_pending_(false)
     {
+        cells_.parent(this);
         *this = other;
     }
 
@@ -71,11 +80,12 @@ struct worksheet_impl
         format_properties_ = other.format_properties_;
         column_properties_ = other.column_properties_;
         row_properties_ = other.row_properties_;
-        cell_map_ = other.cell_map_;
+        cells_ = other.cells_;
         page_setup_ = other.page_setup_;
         auto_filter_ = other.auto_filter_;
         page_margins_ = other.page_margins_;
         merged_cells_ = other.merged_cells_;
+        comments_ = other.comments_;
         named_ranges_ = other.named_ranges_;
         phonetic_properties_ = other.phonetic_properties_;
         header_footer_ = other.header_footer_;
@@ -89,10 +99,9 @@ struct worksheet_impl
         sheet_properties_ = other.sheet_properties_;
         print_options_ = other.print_options_;
 
-        for (auto &cell : cell_map_)
-        {
-            cell.second.parent_ = this;
-        }
+        // worksheets are read before they're copied, see workbook::workbook(const workbook &)
+        deferred_.reset();
+        deferred_pending_.store(false, std::memory_order_relaxed);
     }
 
     workbook *parent_;
@@ -104,7 +113,7 @@ struct worksheet_impl
             && format_properties_ == rhs.format_properties_
             && column_properties_ == rhs.column_properties_
             && row_properties_ == rhs.row_properties_
-            && cell_map_ == rhs.cell_map_
+            && cells_ == rhs.cells_
             && page_setup_ == rhs.page_setup_
             && auto_filter_ == rhs.auto_filter_
             && page_margins_ == rhs.page_margins_
@@ -129,10 +138,11 @@ struct worksheet_impl
 
     sheet_format_properties format_properties_;
 
-    std::unordered_map<column_t, column_properties> column_properties_;
-    std::unordered_map<row_t, row_properties> row_properties_;
+    // ordered so that the first and last rows and columns with properties are at hand
+    std::map<column_t, column_properties> column_properties_;
+    std::map<row_t, row_properties> row_properties_;
 
-    std::unordered_map<cell_reference, cell_impl> cell_map_;
+    cell_store cells_;
 
     optional<page_setup> page_setup_;
     optional<range_reference> auto_filter_;
@@ -160,6 +170,19 @@ struct worksheet_impl
 
     std::string drawing_rel_id_;
     optional<drawing::spreadsheet_drawing> drawing_;
+
+    /// <summary>
+    /// Set until the worksheet part of a workbook loaded with
+    /// load_options::lazy_worksheets is read. Only accessed under the
+    /// deferred_mutex_ of the workbook.
+    /// </summary>
+    std::shared_ptr<deferred_worksheet> deferred_;
+
+    /// <summary>
+    /// Set along with deferred_ and cleared once the worksheet has been read,
+    /// so that accessing it afterwards doesn't take the lock.
+    /// </summary>
+    std::atomic<bool> deferred_pending_;
 };
 
 } // namespace detail
@@ -0,0 +1,141 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <detail/number_format/number_format_cache.hpp>
+#include <xlnt/styles/number_format.hpp>
+
+namespace {
+
+// Formats without an id are usually made on the fly, so the cache of them is
+// emptied rather than let grow past this.
+const std::size_t max_cached_strings = 256;
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+const std::size_t number_format_cache::published_ids;
+
+number_format_cache::number_format_cache()
+{
+    for (auto &published : published_)
+    {
+        published.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+number_format_cache::number_format_cache(const number_format_cache &)
+    : number_format_cache()
+{
+}
+
+number_format_cache &number_format_cache::operator=(const number_format_cache &other)
+{
+    if (this != &other)
+    {
+        clear();
+    }
+
+    return *this;
+}
+
+number_format_cache::~number_format_cache()
+{
+    for (auto &published : published_)
+    {
+        delete published.load(std::memory_order_relaxed);
+    }
+}
+
+std::shared_ptr<const compiled_number_format> number_format_cache::get(const number_format &format)
+{
+    const auto publishable = format.has_id() && format.id() < published_ids;
+    // published formats are owned by the cache, so no count is shared between threads
+    auto unowned = [](const compiled_number_format *compiled) {
+        return std::shared_ptr<const compiled_number_format>(std::shared_ptr<const compiled_number_format>(), compiled);
+    };
+
+    if (publishable)
+    {
+        const auto published = published_[format.id()].load(std::memory_order_acquire);
+
+        if (published != nullptr && published->format_string() == format.format_string())
+        {
+            return unowned(published);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (publishable && published_[format.id()].load(std::memory_order_relaxed) == nullptr)
+    {
+        const auto published = new compiled_number_format(format.format_string());
+        published_[format.id()].store(published, std::memory_order_release);
+
+        return unowned(published);
+    }
+
+    if (format.has_id())
+    {
+        auto &compiled = by_id_[format.id()];
+
+        if (!compiled || compiled->format_string() != format.format_string())
+        {
+            compiled = std::make_shared<compiled_number_format>(format.format_string());
+        }
+
+        return compiled;
+    }
+
+    auto match = by_string_.find(format.format_string());
+
+    if (match != by_string_.end())
+    {
+        return match->second;
+    }
+
+    if (by_string_.size() >= max_cached_strings)
+    {
+        by_string_.clear();
+    }
+
+    auto compiled = std::make_shared<compiled_number_format>(format.format_string());
+    by_string_.emplace(format.format_string(), compiled);
+
+    return compiled;
+}
+
+void number_format_cache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // readers may have found the published formats without the lock and
+    // still be using them, so they're kept until the cache is destroyed.
+    // They're only found for their own format string, so they can't be stale.
+    by_id_.clear();
+    by_string_.clear();
+}
+
+} // namespace detail
+} // namespace xlnt
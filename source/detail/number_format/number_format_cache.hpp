@@ -0,0 +1,96 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <detail/number_format/number_formatter.hpp>
+
+namespace xlnt {
+
+class number_format;
+
+namespace detail {
+
+/// <summary>
+/// Number formats compiled once for number_formatter, by id for formats
+/// with one and by format string for others. Lookups may come from several
+/// threads at once since formatting doesn't change a workbook otherwise.
+/// The first format compiled for an id below published_ids is published
+/// and found again without taking the lock, the rest are found under it.
+/// Published formats are never freed before the cache is destroyed.
+/// </summary>
+class number_format_cache
+{
+public:
+    number_format_cache();
+
+    /// <summary>
+    /// Copies nothing, the copy compiles formats again as they're used.
+    /// </summary>
+    number_format_cache(const number_format_cache &other);
+
+    /// <summary>
+    /// Clears this cache, see the copy constructor.
+    /// </summary>
+    number_format_cache &operator=(const number_format_cache &other);
+
+    ~number_format_cache();
+
+    /// <summary>
+    /// Returns format compiled, compiling it if it isn't cached yet or its id
+    /// was cached with another format string. Throws if format isn't valid.
+    /// Published formats are owned by the cache rather than reference counted,
+    /// so the result mustn't be kept past the end of the cache.
+    /// </summary>
+    std::shared_ptr<const compiled_number_format> get(const number_format &format);
+
+    /// <summary>
+    /// Removes every compiled format except the published ones, which are
+    /// kept as they may be in use.
+    /// </summary>
+    void clear();
+
+private:
+    static const std::size_t published_ids = 512;
+
+    /// <summary>
+    /// The published formats by id, written once under mutex_ and read
+    /// without it.
+    /// </summary>
+    std::array<std::atomic<const compiled_number_format *>, published_ids> published_;
+
+    std::mutex mutex_;
+    std::unordered_map<std::size_t, std::shared_ptr<const compiled_number_format>> by_id_;
+    std::unordered_map<std::string, std::shared_ptr<const compiled_number_format>> by_string_;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -1477,11 +1477,34 @@ std::pair<format_locale, std::string> number_format_parser::locale_from_string(c
     throw xlnt::exception("unknown country code: " + country_code_string);
 }
 
+compiled_number_format::compiled_number_format(const std::string &format_string)
+    : format_string_(format_string)
+{
+    number_format_parser parser(format_string);
+    parser.parse();
+    sections_ = parser.result();
+}
+
+const std::string &compiled_number_format::format_string() const
+{
+    return format_string_;
+}
+
+const std::vector<format_code> &compiled_number_format::sections() const
+{
+    return sections_;
+}
+
 number_formatter::number_formatter(const std::string &format_string, xlnt::calendar calendar)
-    : parser_(format_string), calendar_(calendar)
+    : number_formatter(std::make_shared<compiled_number_format>(format_string), calendar)
+{
+}
+
+number_formatter::number_formatter(std::shared_ptr<const compiled_number_format> format, xlnt::calendar calendar)
+    : compiled_(std::move(format)),
+      format_(compiled_->sections()),
+      calendar_(calendar)
 {
-    parser_.parse();
-    format_ = parser_.result();
 }
 
 std::string number_formatter::format_number(double number)
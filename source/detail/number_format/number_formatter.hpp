@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -674,10 +675,38 @@ private:
     std::vector<format_code> codes_;
 };
 
+/// <summary>
+/// A number format string parsed once into its sections, with their
+/// conditions and template parts, which number_formatter then only executes.
+/// </summary>
+class XLNT_API compiled_number_format
+{
+public:
+    /// <summary>
+    /// Parses format_string. Throws if it isn't a valid number format.
+    /// </summary>
+    explicit compiled_number_format(const std::string &format_string);
+
+    /// <summary>
+    /// Returns the format string this was compiled from.
+    /// </summary>
+    const std::string &format_string() const;
+
+    /// <summary>
+    /// Returns the sections of the format.
+    /// </summary>
+    const std::vector<format_code> &sections() const;
+
+private:
+    std::string format_string_;
+    std::vector<format_code> sections_;
+};
+
 class XLNT_API number_formatter
 {
 public:
     number_formatter(const std::string &format_string, xlnt::calendar calendar);
+    number_formatter(std::shared_ptr<const compiled_number_format> format, xlnt::calendar calendar);
     std::string format_number(double number);
     std::string format_text(const std::string &text);
 
@@ -691,8 +720,8 @@ private:
     std::string format_number(const format_code &format, double number);
     std::string format_text(const format_code &format, const std::string &text);
 
-    number_format_parser parser_;
-    std::vector<format_code> format_;
+    std::shared_ptr<const compiled_number_format> compiled_;
+    const std::vector<format_code> &format_;
     xlnt::calendar calendar_;
     xlnt::detail::number_serialiser serialiser_;
 };
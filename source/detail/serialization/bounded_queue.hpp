@@ -0,0 +1,143 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// A blocking FIFO queue holding at most a fixed number of items. Used to hand
+/// work from a producer thread to a consumer thread while bounding the memory
+/// held between them.
+/// </summary>
+template <typename T>
+class bounded_queue
+{
+public:
+    /// <summary>
+    /// Constructs an empty queue which holds at most capacity items.
+    /// </summary>
+    explicit bounded_queue(std::size_t capacity)
+        : capacity_(capacity == 0 ? 1 : capacity)
+    {
+    }
+
+    bounded_queue(const bounded_queue &) = delete;
+    bounded_queue &operator=(const bounded_queue &) = delete;
+
+    /// <summary>
+    /// Waits until there is room in the queue and appends item. Returns false
+    /// without appending if the queue has been closed.
+    /// </summary>
+    bool push(T &&item)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this]() { return closed_ || items_.size() < capacity_; });
+
+        if (closed_)
+        {
+            return false;
+        }
+
+        items_.push_back(std::move(item));
+        lock.unlock();
+        not_empty_.notify_one();
+
+        return true;
+    }
+
+    /// <summary>
+    /// Waits until an item is available and moves it into item. Returns false
+    /// once the queue has been closed and every remaining item has been popped.
+    /// </summary>
+    bool pop(T &item)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this]() { return closed_ || !items_.empty(); });
+
+        if (items_.empty())
+        {
+            return false;
+        }
+
+        item = std::move(items_.front());
+        items_.pop_front();
+        lock.unlock();
+        not_full_.notify_one();
+
+        return true;
+    }
+
+    /// <summary>
+    /// Moves the first item into item if there is one without waiting and
+    /// returns whether it did.
+    /// </summary>
+    bool try_pop(T &item)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        if (items_.empty())
+        {
+            return false;
+        }
+
+        item = std::move(items_.front());
+        items_.pop_front();
+        lock.unlock();
+        not_full_.notify_one();
+
+        return true;
+    }
+
+    /// <summary>
+    /// Marks the end of the input. Blocked and future calls to push return false
+    /// and pop returns false after the items already queued have been consumed.
+    /// </summary>
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+private:
+    std::size_t capacity_;
+    std::deque<T> items_;
+    bool closed_ = false;
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+};
+
+} // namespace detail
+} // namespace xlnt
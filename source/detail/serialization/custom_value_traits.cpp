@@ -406,6 +406,8 @@ std::string to_string(variant::type type)
         return "date";
     case variant::type::i4:
         return "i4";
+    case variant::type::r8:
+        return "r8";
     case variant::type::lpstr:
         return "lpstr";
     case variant::type::null:
@@ -361,6 +361,7 @@ variant::type from_string(const std::string &string)
     if (string == "bool") return variant::type::boolean;
     else if (string == "date") return variant::type::date;
     else if (string == "i4") return variant::type::i4;
+    else if (string == "r8") return variant::type::r8;
     else if (string == "lpstr") return variant::type::lpstr;
     else if (string == "null") return variant::type::null;
     else if (string == "vector") return variant::type::vector;
@@ -0,0 +1,165 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <xlnt/utils/exceptions.hpp>
+#include <xlnt/utils/path.hpp>
+#include <detail/serialization/mapped_file.hpp>
+
+#if defined(_MSC_VER)
+#include <detail/external/include_windows.hpp>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace xlnt {
+namespace detail {
+
+unmappable_file::unmappable_file(const path &filename)
+    : xlnt::exception("couldn't map file " + filename.string())
+{
+}
+
+#if defined(_MSC_VER)
+mapped_file::mapped_file(const path &filename)
+    : data_(nullptr),
+      size_(0)
+{
+    auto file = CreateFileW(filename.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throw xlnt::exception("file not found " + filename.string());
+    }
+
+    LARGE_INTEGER file_size;
+
+    if (!GetFileSizeEx(file, &file_size))
+    {
+        CloseHandle(file);
+        throw xlnt::exception("couldn't map file " + filename.string());
+    }
+
+    if (file_size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        throw unmappable_file(filename);
+    }
+
+    // the view keeps the file and the mapping open after their handles are closed
+    auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+
+    if (mapping == nullptr)
+    {
+        throw xlnt::exception("couldn't map file " + filename.string());
+    }
+
+    auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+
+    if (view == nullptr)
+    {
+        throw xlnt::exception("couldn't map file " + filename.string());
+    }
+
+    data_ = static_cast<const std::uint8_t *>(view);
+    size_ = static_cast<std::size_t>(file_size.QuadPart);
+}
+
+mapped_file::~mapped_file()
+{
+    UnmapViewOfFile(data_);
+}
+#elif defined(__unix__) || defined(__APPLE__)
+mapped_file::mapped_file(const path &filename)
+    : data_(nullptr),
+      size_(0)
+{
+    auto file = ::open(filename.string().c_str(), O_RDONLY);
+
+    if (file == -1)
+    {
+        throw xlnt::exception("file not found " + filename.string());
+    }
+
+    struct stat file_status;
+
+    if (fstat(file, &file_status) != 0)
+    {
+        ::close(file);
+        throw xlnt::exception("couldn't map file " + filename.string());
+    }
+
+    if (!S_ISREG(file_status.st_mode) || file_status.st_size == 0)
+    {
+        ::close(file);
+        throw unmappable_file(filename);
+    }
+
+    // the mapping keeps the file open after its descriptor is closed
+    auto view = mmap(nullptr, static_cast<std::size_t>(file_status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+
+    if (view == MAP_FAILED)
+    {
+        throw xlnt::exception("couldn't map file " + filename.string());
+    }
+
+    data_ = static_cast<const std::uint8_t *>(view);
+    size_ = static_cast<std::size_t>(file_status.st_size);
+}
+
+mapped_file::~mapped_file()
+{
+    munmap(const_cast<std::uint8_t *>(data_), size_);
+}
+#else
+mapped_file::mapped_file(const path &filename)
+    : data_(nullptr),
+      size_(0)
+{
+    // memory mapped files aren't supported
+    throw unmappable_file(filename);
+}
+
+mapped_file::~mapped_file()
+{
+}
+#endif
+
+const std::uint8_t *mapped_file::data() const
+{
+    return data_;
+}
+
+std::size_t mapped_file::size() const
+{
+    return size_;
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,86 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/utils/exceptions.hpp>
+
+namespace xlnt {
+
+class path;
+
+namespace detail {
+
+/// <summary>
+/// Thrown by mapped_file if the file exists but can't be mapped because it's
+/// empty or not a regular file, or because the platform doesn't support
+/// mappings. Callers should then fall back to reading it through a stream.
+/// </summary>
+class unmappable_file : public xlnt::exception
+{
+public:
+    explicit unmappable_file(const path &filename);
+};
+
+/// <summary>
+/// A read-only memory mapping of a whole file. The constructor throws
+/// unmappable_file if the file can be read but not mapped and
+/// xlnt::exception if it can't be opened or mapping it fails.
+/// </summary>
+class mapped_file
+{
+public:
+    /// <summary>
+    /// Maps the file at filename.
+    /// </summary>
+    explicit mapped_file(const path &filename);
+
+    /// <summary>
+    /// Unmaps the file.
+    /// </summary>
+    ~mapped_file();
+
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    /// <summary>
+    /// Returns the first byte of the file.
+    /// </summary>
+    const std::uint8_t *data() const;
+
+    /// <summary>
+    /// Returns the size of the file in bytes.
+    /// </summary>
+    std::size_t size() const;
+
+private:
+    const std::uint8_t *data_;
+    std::size_t size_;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,832 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+#include <xlnt/utils/exceptions.hpp>
+#include <detail/serialization/sheet_data_tokenizer.hpp>
+
+namespace {
+
+const std::size_t initial_buffer_size = 64 * 1024;
+
+bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// returns the part of a qualified name after the prefix
+xlnt::detail::text_view local_name(const char *begin, const char *end)
+{
+    auto colon = static_cast<const char *>(std::memchr(begin, ':', static_cast<std::size_t>(end - begin)));
+
+    if (colon != nullptr)
+    {
+        begin = colon + 1;
+    }
+
+    xlnt::detail::text_view name;
+    name.data = begin;
+    name.size = static_cast<std::size_t>(end - begin);
+
+    return name;
+}
+
+void append_utf8(std::string &out, unsigned long code_point)
+{
+    if (code_point < 0x80)
+    {
+        out.push_back(static_cast<char>(code_point));
+    }
+    else if (code_point < 0x800)
+    {
+        out.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else if (code_point < 0x10000)
+    {
+        out.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else if (code_point < 0x110000)
+    {
+        out.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else
+    {
+        throw xlnt::exception("invalid character reference in sheetData");
+    }
+}
+
+bool starts_with(const char *data, std::size_t size, const char *prefix)
+{
+    auto prefix_size = std::strlen(prefix);
+    return size >= prefix_size && std::memcmp(data, prefix, prefix_size) == 0;
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+sheet_data_tokenizer::sheet_data_tokenizer(std::istream &source)
+    : source_(source),
+      buffer_(initial_buffer_size)
+{
+}
+
+void sheet_data_tokenizer::rebase(const char *old_base, std::size_t discarded)
+{
+    const auto old_end = old_base + end_ + discarded;
+    const auto new_base = buffer_.data();
+
+    auto move = [&](text_view &view) {
+        if (view.data >= old_base + discarded && view.data < old_end)
+        {
+            view.data = new_base + (view.data - old_base) - discarded;
+        }
+    };
+
+    move(name_);
+
+    for (auto &attr : attributes_)
+    {
+        move(attr.name);
+        move(attr.value);
+    }
+}
+
+bool sheet_data_tokenizer::fill()
+{
+    if (!source_)
+    {
+        return false;
+    }
+
+    auto keep_from = std::min(position_, anchor_);
+
+    if (keep_from > 0)
+    {
+        std::memmove(buffer_.data(), buffer_.data() + keep_from, end_ - keep_from);
+        position_ -= keep_from;
+        end_ -= keep_from;
+
+        if (anchor_ != std::string::npos)
+        {
+            anchor_ -= keep_from;
+        }
+
+        rebase(buffer_.data(), keep_from);
+    }
+
+    if (end_ == buffer_.size())
+    {
+        const auto old_base = buffer_.data();
+        buffer_.resize(buffer_.size() * 2);
+        rebase(old_base, 0);
+    }
+
+    source_.read(buffer_.data() + end_, static_cast<std::streamsize>(buffer_.size() - end_));
+    const auto count = static_cast<std::size_t>(source_.gcount());
+    end_ += count;
+
+    return count > 0;
+}
+
+std::size_t sheet_data_tokenizer::find(const char *terminator, std::size_t from)
+{
+    const auto length = std::strlen(terminator);
+
+    while (true)
+    {
+        auto search_begin = buffer_.data() + position_ + from;
+        auto search_end = buffer_.data() + end_;
+
+        if (search_begin < search_end)
+        {
+            auto match = std::search(search_begin, search_end, terminator, terminator + length);
+
+            if (match != search_end)
+            {
+                return static_cast<std::size_t>(match - (buffer_.data() + position_));
+            }
+
+            // the terminator may straddle the end of the buffer
+            const auto searched = end_ - position_;
+            from = searched >= length ? std::max(from, searched - length + 1) : from;
+        }
+
+        if (!fill())
+        {
+            return std::string::npos;
+        }
+    }
+}
+
+std::size_t sheet_data_tokenizer::find_tag_end()
+{
+    auto offset = std::size_t(1);
+    char quote = 0;
+
+    while (true)
+    {
+        if (position_ + offset >= end_ && !fill())
+        {
+            throw xlnt::exception("unexpected end of worksheet in tag");
+        }
+
+        const auto data = buffer_.data() + position_;
+        const auto size = end_ - position_;
+
+        for (; offset < size; ++offset)
+        {
+            const auto c = data[offset];
+
+            if (quote != 0)
+            {
+                if (c == quote)
+                {
+                    quote = 0;
+                }
+            }
+            else if (c == '"' || c == '\'')
+            {
+                quote = c;
+            }
+            else if (c == '>')
+            {
+                return offset;
+            }
+        }
+    }
+}
+
+text_view sheet_data_tokenizer::decode(const char *begin, const char *end, std::string &scratch, bool attribute_value)
+{
+    text_view result;
+    result.data = begin;
+    result.size = static_cast<std::size_t>(end - begin);
+
+    auto needs_decoding = false;
+
+    for (auto c = begin; c != end; ++c)
+    {
+        if (*c == '&' || *c == '\r' || (attribute_value && (*c == '\n' || *c == '\t')))
+        {
+            needs_decoding = true;
+            break;
+        }
+    }
+
+    if (!needs_decoding)
+    {
+        return result;
+    }
+
+    scratch.clear();
+
+    for (auto c = begin; c != end; ++c)
+    {
+        if (*c == '&')
+        {
+            auto semicolon = static_cast<const char *>(std::memchr(c, ';', static_cast<std::size_t>(end - c)));
+
+            if (semicolon == nullptr)
+            {
+                throw xlnt::exception("unterminated entity reference in sheetData");
+            }
+
+            const auto entity = std::string(c + 1, semicolon);
+
+            if (entity == "lt")
+            {
+                scratch.push_back('<');
+            }
+            else if (entity == "gt")
+            {
+                scratch.push_back('>');
+            }
+            else if (entity == "amp")
+            {
+                scratch.push_back('&');
+            }
+            else if (entity == "quot")
+            {
+                scratch.push_back('"');
+            }
+            else if (entity == "apos")
+            {
+                scratch.push_back('\'');
+            }
+            else if (entity.size() > 1 && entity[0] == '#')
+            {
+                const auto hex = entity[1] == 'x';
+                append_utf8(scratch, std::strtoul(entity.c_str() + (hex ? 2 : 1), nullptr, hex ? 16 : 10));
+            }
+            else
+            {
+                throw xlnt::exception("unsupported entity reference in sheetData: " + entity);
+            }
+
+            c = semicolon;
+        }
+        else if (*c == '\r')
+        {
+            // line endings are normalized to \n and then to a space in attribute values
+            if (c + 1 != end && c[1] == '\n')
+            {
+                ++c;
+            }
+
+            scratch.push_back(attribute_value ? ' ' : '\n');
+        }
+        else if (attribute_value && (*c == '\n' || *c == '\t'))
+        {
+            scratch.push_back(' ');
+        }
+        else
+        {
+            scratch.push_back(*c);
+        }
+    }
+
+    result.data = scratch.c_str();
+    result.size = scratch.size();
+
+    return result;
+}
+
+bool sheet_data_tokenizer::read_to_sheet_data(std::string &document)
+{
+    if (end_ - position_ < 4 && !fill())
+    {
+        return false;
+    }
+
+    const auto data = buffer_.data() + position_;
+    const auto size = end_ - position_;
+
+    // UTF-16 with a byte order mark
+    if (size >= 2 && ((data[0] == '\xFE' && data[1] == '\xFF') || (data[0] == '\xFF' && data[1] == '\xFE')))
+    {
+        return false;
+    }
+
+    while (true)
+    {
+        if (position_ == end_ && !fill())
+        {
+            return false;
+        }
+
+        auto begin = buffer_.data() + position_;
+        auto open = static_cast<const char *>(std::memchr(begin, '<', end_ - position_));
+
+        if (open == nullptr)
+        {
+            document.append(begin, end_ - position_);
+            position_ = end_;
+            continue;
+        }
+
+        document.append(begin, static_cast<std::size_t>(open - begin));
+        position_ += static_cast<std::size_t>(open - begin);
+
+        if (end_ - position_ < 9)
+        {
+            fill();
+        }
+
+        const auto tag = buffer_.data() + position_;
+        const auto available = end_ - position_;
+        auto length = std::string::npos;
+
+        if (starts_with(tag, available, "<!--"))
+        {
+            auto close = find("-->", 4);
+            length = close == std::string::npos ? close : close + 3;
+        }
+        else if (starts_with(tag, available, "<![CDATA["))
+        {
+            auto close = find("]]>", 9);
+            length = close == std::string::npos ? close : close + 3;
+        }
+        else if (starts_with(tag, available, "<?"))
+        {
+            const auto is_declaration = starts_with(tag, available, "<?xml");
+            auto close = find("?>", 2);
+            length = close == std::string::npos ? close : close + 2;
+
+            if (length != std::string::npos && is_declaration)
+            {
+                // only UTF-8 (the default) is tokenized
+                auto declaration = std::string(buffer_.data() + position_, length);
+                auto encoding = declaration.find("encoding");
+
+                if (encoding != std::string::npos)
+                {
+                    auto quote = declaration.find_first_of("\"'", encoding);
+                    auto name = quote == std::string::npos ? std::string() : declaration.substr(quote + 1, 5);
+                    std::transform(name.begin(), name.end(), name.begin(), [](char c) {
+                        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+                    });
+
+                    if (name != "utf-8")
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+        else if (starts_with(tag, available, "<!"))
+        {
+            // a document type declaration may define entities which aren't handled here
+            return false;
+        }
+        else
+        {
+            length = find_tag_end() + 1;
+            const auto tag_begin = buffer_.data() + position_;
+            const auto is_end_tag = tag_begin[1] == '/';
+            auto name_end = tag_begin + 1;
+
+            while (name_end < tag_begin + length - 1 && !is_space(*name_end) && *name_end != '/')
+            {
+                ++name_end;
+            }
+
+            if (!is_end_tag && local_name(tag_begin + 1, name_end) == "sheetData")
+            {
+                const auto self_closing = tag_begin[length - 2] == '/';
+
+                if (self_closing)
+                {
+                    document.append(tag_begin, length);
+                    position_ += length;
+
+                    return false;
+                }
+
+                document.append(tag_begin, length - 1);
+                document.append("/>");
+                position_ += length;
+                depth_ = 0;
+
+                return true;
+            }
+        }
+
+        if (length == std::string::npos)
+        {
+            throw xlnt::exception("unexpected end of worksheet");
+        }
+
+        document.append(buffer_.data() + position_, length);
+        position_ += length;
+    }
+}
+
+void sheet_data_tokenizer::read_remainder(std::string &document)
+{
+    anchor_ = std::string::npos;
+
+    do
+    {
+        document.append(buffer_.data() + position_, end_ - position_);
+        position_ = end_;
+    } while (fill());
+}
+
+bool sheet_data_tokenizer::attribute_present(const char *name) const
+{
+    const auto length = std::strlen(name);
+
+    for (const auto &attr : attributes_)
+    {
+        if (attr.name.size == length && std::memcmp(attr.name.data, name, length) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+text_view sheet_data_tokenizer::attribute_value(const char *name) const
+{
+    const auto length = std::strlen(name);
+
+    for (const auto &attr : attributes_)
+    {
+        if (attr.name.size == length && std::memcmp(attr.name.data, name, length) == 0)
+        {
+            return attr.value;
+        }
+    }
+
+    return text_view();
+}
+
+sheet_data_tokenizer::event sheet_data_tokenizer::next()
+{
+    if (pending_end_)
+    {
+        pending_end_ = false;
+        return event::end_element;
+    }
+
+    if (finished_)
+    {
+        return event::end_of_sheet_data;
+    }
+
+    while (true)
+    {
+        if (position_ == end_ && !fill())
+        {
+            throw xlnt::exception("unexpected end of worksheet in sheetData");
+        }
+
+        if (buffer_[position_] != '<')
+        {
+            const auto length = find("<", 0);
+
+            if (length == std::string::npos)
+            {
+                throw xlnt::exception("unexpected end of worksheet in sheetData");
+            }
+
+            const auto begin = buffer_.data() + position_;
+            value_ = decode(begin, begin + length, value_scratch_, false);
+            position_ += length;
+
+            return event::characters;
+        }
+
+        if (end_ - position_ < 9)
+        {
+            fill();
+        }
+
+        const auto tag = buffer_.data() + position_;
+        const auto available = end_ - position_;
+
+        if (starts_with(tag, available, "<!--"))
+        {
+            const auto close = find("-->", 4);
+
+            if (close == std::string::npos)
+            {
+                throw xlnt::exception("unterminated comment in sheetData");
+            }
+
+            position_ += close + 3;
+            continue;
+        }
+
+        if (starts_with(tag, available, "<?"))
+        {
+            const auto close = find("?>", 2);
+
+            if (close == std::string::npos)
+            {
+                throw xlnt::exception("unterminated processing instruction in sheetData");
+            }
+
+            position_ += close + 2;
+            continue;
+        }
+
+        if (starts_with(tag, available, "<![CDATA["))
+        {
+            const auto close = find("]]>", 9);
+
+            if (close == std::string::npos)
+            {
+                throw xlnt::exception("unterminated CDATA section in sheetData");
+            }
+
+            value_.data = buffer_.data() + position_ + 9;
+            value_.size = close - 9;
+            position_ += close + 3;
+
+            return event::characters;
+        }
+
+        return read_tag(find_tag_end());
+    }
+}
+
+void sheet_data_tokenizer::skip_element()
+{
+    if (pending_end_)
+    {
+        // the element was self-closing
+        pending_end_ = false;
+        return;
+    }
+
+    skip_to_depth(depth_ - 1);
+}
+
+void sheet_data_tokenizer::skip_sheet_data()
+{
+    pending_end_ = false;
+
+    if (!finished_)
+    {
+        skip_to_depth(std::string::npos);
+    }
+}
+
+void sheet_data_tokenizer::skip_to_depth(std::size_t depth)
+{
+    // nothing read while skipping needs to stay in the buffer
+    anchor_ = std::string::npos;
+
+    while (true)
+    {
+        if (position_ == end_ && !fill())
+        {
+            throw xlnt::exception("unexpected end of worksheet in sheetData");
+        }
+
+        if (buffer_[position_] != '<')
+        {
+            const auto length = find("<", 0);
+
+            if (length == std::string::npos)
+            {
+                throw xlnt::exception("unexpected end of worksheet in sheetData");
+            }
+
+            position_ += length;
+            continue;
+        }
+
+        if (end_ - position_ < 9)
+        {
+            fill();
+        }
+
+        const auto tag = buffer_.data() + position_;
+        const auto available = end_ - position_;
+        auto length = std::string::npos;
+
+        if (starts_with(tag, available, "<!--"))
+        {
+            const auto close = find("-->", 4);
+            length = close == std::string::npos ? close : close + 3;
+        }
+        else if (starts_with(tag, available, "<?"))
+        {
+            const auto close = find("?>", 2);
+            length = close == std::string::npos ? close : close + 2;
+        }
+        else if (starts_with(tag, available, "<![CDATA["))
+        {
+            const auto close = find("]]>", 9);
+            length = close == std::string::npos ? close : close + 3;
+        }
+        else
+        {
+            const auto tag_length = find_tag_end();
+            const auto is_end_tag = buffer_[position_ + 1] == '/';
+            const auto self_closing = buffer_[position_ + tag_length - 1] == '/';
+
+            position_ += tag_length + 1;
+
+            if (!is_end_tag)
+            {
+                depth_ += self_closing ? 0 : 1;
+                continue;
+            }
+
+            if (depth_ == 0)
+            {
+                finished_ = true;
+                return;
+            }
+
+            if (--depth_ == depth)
+            {
+                return;
+            }
+
+            continue;
+        }
+
+        if (length == std::string::npos)
+        {
+            throw xlnt::exception("unexpected end of worksheet in sheetData");
+        }
+
+        position_ += length;
+    }
+}
+
+sheet_data_tokenizer::event sheet_data_tokenizer::read_tag(std::size_t length)
+{
+    const auto tag_begin = buffer_.data() + position_;
+    const auto tag_end = tag_begin + length;
+
+    if (tag_begin[1] == '/')
+    {
+        auto name_begin = tag_begin + 2;
+        auto name_end = tag_end;
+
+        while (name_end > name_begin && is_space(name_end[-1]))
+        {
+            --name_end;
+        }
+
+        position_ += length + 1;
+
+        if (depth_ == 0)
+        {
+            finished_ = true;
+            return event::end_of_sheet_data;
+        }
+
+        --depth_;
+        name_ = local_name(name_begin, name_end);
+
+        return event::end_element;
+    }
+
+    anchor_ = position_;
+    attributes_.clear();
+
+    const auto self_closing = tag_end[-1] == '/';
+    const auto content_end = self_closing ? tag_end - 1 : tag_end;
+
+    auto c = tag_begin + 1;
+
+    while (c < content_end && !is_space(*c))
+    {
+        ++c;
+    }
+
+    name_ = local_name(tag_begin + 1, c);
+
+    while (true)
+    {
+        while (c < content_end && is_space(*c))
+        {
+            ++c;
+        }
+
+        if (c == content_end)
+        {
+            break;
+        }
+
+        const auto attr_name_begin = c;
+
+        while (c < content_end && *c != '=' && !is_space(*c))
+        {
+            ++c;
+        }
+
+        const auto attr_name_end = c;
+
+        while (c < content_end && is_space(*c))
+        {
+            ++c;
+        }
+
+        if (c == content_end || *c != '=')
+        {
+            throw xlnt::exception("malformed attribute in sheetData");
+        }
+
+        ++c;
+
+        while (c < content_end && is_space(*c))
+        {
+            ++c;
+        }
+
+        if (c == content_end || (*c != '"' && *c != '\''))
+        {
+            throw xlnt::exception("malformed attribute in sheetData");
+        }
+
+        const auto quote = *c++;
+        const auto value_begin = c;
+
+        while (c < content_end && *c != quote)
+        {
+            ++c;
+        }
+
+        if (c == content_end)
+        {
+            throw xlnt::exception("malformed attribute in sheetData");
+        }
+
+        const auto value_end = c++;
+
+        // namespace declarations aren't attributes
+        const auto qualified_size = static_cast<std::size_t>(attr_name_end - attr_name_begin);
+        if ((qualified_size == 5 || (qualified_size > 5 && attr_name_begin[5] == ':'))
+            && std::memcmp(attr_name_begin, "xmlns", 5) == 0)
+        {
+            continue;
+        }
+
+        const auto index = attributes_.size();
+
+        if (attribute_scratch_.size() <= index)
+        {
+            attribute_scratch_.emplace_back();
+        }
+
+        attribute attr;
+        attr.name = local_name(attr_name_begin, attr_name_end);
+        attr.value = decode(value_begin, value_end, attribute_scratch_[index], true);
+        attributes_.push_back(attr);
+    }
+
+    position_ += length + 1;
+
+    if (self_closing)
+    {
+        pending_end_ = true;
+    }
+    else
+    {
+        ++depth_;
+    }
+
+    return event::start_element;
+}
+
+} // namespace detail
+} // namespace xlnt
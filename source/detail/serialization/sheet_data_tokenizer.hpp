@@ -0,0 +1,245 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <xlnt/xlnt_config.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// A non-owning reference to a run of characters inside a sheet_data_tokenizer.
+/// The characters are always followed by a character which can't continue a
+/// number (a quote, '<' or a null terminator) so they may be passed directly
+/// to strtol/strtod. A view is only valid until the next call to next().
+/// </summary>
+struct XLNT_API text_view
+{
+    const char *data = nullptr;
+    std::size_t size = 0;
+
+    bool empty() const
+    {
+        return size == 0;
+    }
+
+    std::string to_string() const
+    {
+        return std::string(data, size);
+    }
+
+    template <std::size_t N>
+    bool operator==(const char (&rhs)[N]) const
+    {
+        return size == N - 1 && std::memcmp(data, rhs, N - 1) == 0;
+    }
+
+    template <std::size_t N>
+    bool operator!=(const char (&rhs)[N]) const
+    {
+        return !(*this == rhs);
+    }
+};
+
+/// <summary>
+/// A special-purpose XML tokenizer for the contents of a worksheet's sheetData
+/// element, which is where almost all of the time loading a worksheet is spent.
+/// It reads the inflated part through a sliding buffer and hands out views
+/// into it instead of allocating strings for every name, attribute and value.
+/// Element and attribute names are reported without namespace prefixes.
+/// Everything outside of sheetData is left for xml::parser by splitting the
+/// part around it with read_to_sheet_data and read_remainder.
+/// </summary>
+class XLNT_API sheet_data_tokenizer
+{
+public:
+    /// <summary>
+    /// The events reported by next().
+    /// </summary>
+    enum class event
+    {
+        start_element,
+        end_element,
+        characters,
+        end_of_sheet_data
+    };
+
+    /// <summary>
+    /// An attribute of the current element.
+    /// </summary>
+    struct attribute
+    {
+        text_view name;
+        text_view value;
+    };
+
+    /// <summary>
+    /// Constructs a tokenizer reading a worksheet part from source.
+    /// </summary>
+    explicit sheet_data_tokenizer(std::istream &source);
+
+    sheet_data_tokenizer(const sheet_data_tokenizer &) = delete;
+    sheet_data_tokenizer &operator=(const sheet_data_tokenizer &) = delete;
+
+    /// <summary>
+    /// Reads the part up to and including the start tag of sheetData, appending
+    /// what was read to document with the start tag made self-closing. Returns
+    /// true if the element has content to be read with next(). Returns false if
+    /// there is no such element or the part isn't UTF-8 encoded, in which case
+    /// the whole part should be left to xml::parser.
+    /// </summary>
+    bool read_to_sheet_data(std::string &document);
+
+    /// <summary>
+    /// Appends the unread remainder of the part to document.
+    /// </summary>
+    void read_remainder(std::string &document);
+
+    /// <summary>
+    /// Advances to the next event inside sheetData. end_of_sheet_data is
+    /// returned once the closing tag of sheetData has been consumed.
+    /// Throws xlnt::exception if the XML is malformed.
+    /// </summary>
+    event next();
+
+    /// <summary>
+    /// Skips the rest of the element of the last start_element event, including
+    /// its end tag, without decoding its content. The next event is the one
+    /// following the end tag. name() and attributes() are invalid afterwards.
+    /// </summary>
+    void skip_element();
+
+    /// <summary>
+    /// Skips the rest of sheetData without decoding it. The next call to
+    /// next() returns end_of_sheet_data.
+    /// </summary>
+    void skip_sheet_data();
+
+    /// <summary>
+    /// The local name of the element of the last start_element or end_element
+    /// event. Like xml::parser, this is left unchanged by characters events.
+    /// </summary>
+    const text_view &name() const
+    {
+        return name_;
+    }
+
+    /// <summary>
+    /// The text of the last characters event with entities decoded.
+    /// </summary>
+    const text_view &value() const
+    {
+        return value_;
+    }
+
+    /// <summary>
+    /// The attributes of the element of the last start_element event.
+    /// </summary>
+    const std::vector<attribute> &attributes() const
+    {
+        return attributes_;
+    }
+
+    /// <summary>
+    /// Returns true if the element of the last start_element event has an
+    /// attribute with the given name.
+    /// </summary>
+    bool attribute_present(const char *name) const;
+
+    /// <summary>
+    /// Returns the value of the named attribute of the element of the last
+    /// start_element event or an empty view if it isn't present.
+    /// </summary>
+    text_view attribute_value(const char *name) const;
+
+private:
+    /// <summary>
+    /// Moves unread bytes to the front of the buffer and reads more from source.
+    /// Returns false at the end of the stream.
+    /// </summary>
+    bool fill();
+
+    /// <summary>
+    /// Returns the offset from position_ of the first occurrence of terminator at
+    /// or after offset from, reading more of the stream as needed. Returns
+    /// std::string::npos if the stream ends first.
+    /// </summary>
+    std::size_t find(const char *terminator, std::size_t from);
+
+    /// <summary>
+    /// Returns the offset from position_ of the '>' closing the tag which starts
+    /// at position_, skipping over quoted attribute values.
+    /// </summary>
+    std::size_t find_tag_end();
+
+    /// <summary>
+    /// Moves past markup without reporting it until an end tag brings the
+    /// nesting depth down to depth or the end of sheetData has been read.
+    /// </summary>
+    void skip_to_depth(std::size_t depth);
+
+    /// <summary>
+    /// Parses the start or end tag at position_ whose '>' is at position_ + length.
+    /// </summary>
+    event read_tag(std::size_t length);
+
+    /// <summary>
+    /// Updates the views into buffer_ after its contents moved from old_base,
+    /// dropping the first discarded bytes.
+    /// </summary>
+    void rebase(const char *old_base, std::size_t discarded);
+
+    /// <summary>
+    /// Decodes entity and character references and normalizes line endings in
+    /// the given range, returning a view into scratch if anything changed.
+    /// </summary>
+    text_view decode(const char *begin, const char *end, std::string &scratch, bool attribute_value);
+
+    std::istream &source_;
+    std::vector<char> buffer_;
+    std::size_t position_ = 0;
+    std::size_t end_ = 0;
+    // offset of the last start tag which is kept in the buffer so that name_
+    // and attributes_ stay valid until the next start tag
+    std::size_t anchor_ = std::string::npos;
+    std::size_t depth_ = 0;
+    bool pending_end_ = false;
+    bool finished_ = false;
+
+    text_view name_;
+    text_view value_;
+    std::string value_scratch_;
+    std::vector<attribute> attributes_;
+    std::deque<std::string> attribute_scratch_;
+};
+
+} // namespace detail
+} // namespace xlnt
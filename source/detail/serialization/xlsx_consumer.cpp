@@ -22,9 +22,14 @@
 // @author: see AUTHORS file
 
 #include <cassert>
+#include <atomic>
 #include <cctype>
+#include <exception>
+#include <functional>
+#include <mutex>
 #include <numeric> // for std::accumulate
 #include <sstream>
+#include <thread>
 #include <unordered_map>
 
 #include <xlnt/cell/cell.hpp>
@@ -40,9 +45,11 @@
 #include <detail/constants.hpp>
 #include <detail/header_footer/header_footer_code.hpp>
 #include <detail/implementations/workbook_impl.hpp>
+#include <detail/serialization/bounded_queue.hpp>
 #include <detail/serialization/custom_value_traits.hpp>
 #include <detail/serialization/defined_name.hpp>
 #include <detail/serialization/serialisation_helpers.hpp>
+#include <detail/serialization/sheet_data_tokenizer.hpp>
 #include <detail/serialization/vector_streambuf.hpp>
 #include <detail/serialization/xlsx_consumer.hpp>
 #include <detail/serialization/zstream.hpp>
@@ -78,7 +85,8 @@ inline bool string_equal(const std::string &lhs, const char (&rhs)[N])
 xml::qname &qn(const std::string &namespace_, const std::string &name)
 {
     using qname_map = std::unordered_map<std::string, xml::qname>;
-    static auto memo = std::unordered_map<std::string, qname_map>();
+    // each thread reading worksheets in parallel keeps its own cache
+    static thread_local auto memo = std::unordered_map<std::string, qname_map>();
 
     auto &ns_memo = memo[namespace_];
 
@@ -166,9 +174,11 @@ xlnt::cell_type type_from_string(const std::string &str)
     return xlnt::cell::type::shared_string;
 }
 
-xlnt::detail::Cell parse_cell(xlnt::row_t row_arg, xml::parser *parser, std::unordered_map<std::string, std::string> &array_formulae, std::unordered_map<int, std::string> &shared_formulae)
+// column_arg is used if the cell has no r attribute, i.e. it follows the previous cell
+xlnt::detail::Cell parse_cell(xlnt::row_t row_arg, xlnt::column_t::index_t column_arg, xml::parser *parser, std::unordered_map<std::string, std::string> &array_formulae, std::unordered_map<int, std::string> &shared_formulae)
 {
     xlnt::detail::Cell c;
+    c.ref = xlnt::detail::Cell_Reference(row_arg, column_arg);
     for (auto &attr : parser->attribute_map())
     {
         if (string_equal(attr.first.name(), "r"))
@@ -277,9 +287,11 @@ xlnt::detail::Cell parse_cell(xlnt::row_t row_arg, xml::parser *parser, std::uno
 }
 
 // <row> inside <sheetData> element
-std::pair<xlnt::row_properties, int> parse_row(xml::parser *parser, xlnt::detail::number_serialiser &converter, std::vector<xlnt::detail::Cell> &parsed_cells, std::unordered_map<std::string, std::string> &array_formulae, std::unordered_map<int, std::string> &shared_formulae)
+// row_arg is used if the row has no r attribute, i.e. it follows the previous row
+std::pair<xlnt::row_properties, int> parse_row(xlnt::row_t row_arg, xml::parser *parser, xlnt::detail::number_serialiser &converter, std::vector<xlnt::detail::Cell> &parsed_cells, std::unordered_map<std::string, std::string> &array_formulae, std::unordered_map<int, std::string> &shared_formulae)
 {
     std::pair<xlnt::row_properties, int> props;
+    props.second = static_cast<int>(row_arg);
     for (auto &attr : parser->attribute_map())
     {
         if (string_equal(attr.first.name(), "dyDescent"))
@@ -320,6 +332,7 @@ std::pair<xlnt::row_properties, int> parse_row(xml::parser *parser, xlnt::detail
         }
     }
 
+    xlnt::column_t::index_t next_column = 1;
     int level = 1;
     while (level > 0)
     {
@@ -327,7 +340,8 @@ std::pair<xlnt::row_properties, int> parse_row(xml::parser *parser, xlnt::detail
         switch (e)
         {
         case xml::parser::start_element: {
-            parsed_cells.push_back(parse_cell(static_cast<xlnt::row_t>(props.second), parser, array_formulae, shared_formulae));
+            parsed_cells.push_back(parse_cell(static_cast<xlnt::row_t>(props.second), next_column, parser, array_formulae, shared_formulae));
+            next_column = parsed_cells.back().ref.column + 1;
             break;
         }
         case xml::parser::end_element: {
@@ -351,10 +365,39 @@ std::pair<xlnt::row_properties, int> parse_row(xml::parser *parser, xlnt::detail
     return props;
 }
 
+// Removes the last row parsed into sheet_data, whose cells start at first_cell,
+// if it's outside projection or otherwise its cells which are outside projection
+void apply_projection(Sheet_Data &sheet_data, std::size_t first_cell, const xlnt::range_reference &projection)
+{
+    auto &cells = sheet_data.parsed_cells;
+    const auto row = static_cast<xlnt::row_t>(sheet_data.parsed_rows.back().second);
+
+    if (row < projection.top_left().row() || row > projection.bottom_right().row())
+    {
+        cells.erase(cells.begin() + static_cast<std::ptrdiff_t>(first_cell), cells.end());
+        sheet_data.parsed_rows.pop_back();
+
+        return;
+    }
+
+    const auto first_column = projection.top_left().column_index();
+    const auto last_column = projection.bottom_right().column_index();
+
+    cells.erase(std::remove_if(cells.begin() + static_cast<std::ptrdiff_t>(first_cell), cells.end(),
+                    [=](const xlnt::detail::Cell &cell) {
+                        return cell.ref.column < first_column || cell.ref.column > last_column;
+                    }),
+        cells.end());
+}
+
 // <sheetData> inside <worksheet> element
-Sheet_Data parse_sheet_data(xml::parser *parser, xlnt::detail::number_serialiser &converter, std::unordered_map<std::string, std::string> &array_formulae, std::unordered_map<int, std::string> &shared_formulae)
+// Rows are handed to on_batch as soon as at least batch_size cells have been parsed
+// Rows and cells outside projection, if it isn't null, are dropped
+template <typename Callback>
+void parse_sheet_data(xml::parser *parser, xlnt::detail::number_serialiser &converter, std::unordered_map<std::string, std::string> &array_formulae, std::unordered_map<int, std::string> &shared_formulae, const xlnt::range_reference *projection, std::size_t batch_size, Callback on_batch)
 {
     Sheet_Data sheet_data;
+    xlnt::row_t next_row = 1;
     int level = 1; // nesting level
         // 1 == <sheetData>
         // 2 == <row>
@@ -365,7 +408,18 @@ Sheet_Data parse_sheet_data(xml::parser *parser, xlnt::detail::number_serialiser
         switch (e)
         {
         case xml::parser::start_element: {
-            sheet_data.parsed_rows.push_back(parse_row(parser, converter, sheet_data.parsed_cells, array_formulae, shared_formulae));
+            const auto first_cell = sheet_data.parsed_cells.size();
+            sheet_data.parsed_rows.push_back(parse_row(next_row, parser, converter, sheet_data.parsed_cells, array_formulae, shared_formulae));
+            next_row = static_cast<xlnt::row_t>(sheet_data.parsed_rows.back().second) + 1;
+            if (projection != nullptr)
+            {
+                apply_projection(sheet_data, first_cell, *projection);
+            }
+            if (sheet_data.parsed_cells.size() >= batch_size)
+            {
+                on_batch(std::move(sheet_data));
+                sheet_data = Sheet_Data();
+            }
             break;
         }
         case xml::parser::end_element: {
@@ -386,7 +440,518 @@ Sheet_Data parse_sheet_data(xml::parser *parser, xlnt::detail::number_serialiser
         }
         }
     }
-    return sheet_data;
+    if (!sheet_data.parsed_rows.empty())
+    {
+        on_batch(std::move(sheet_data));
+    }
+}
+
+bool is_true(const xlnt::detail::text_view &bool_string)
+{
+    if (bool_string == "1" || bool_string == "true")
+    {
+        return true;
+    }
+
+#ifdef THROW_ON_INVALID_XML
+    if (bool_string == "0" || bool_string == "false")
+    {
+        return false;
+    }
+
+    throw xlnt::exception("xsd:boolean should be one of: 0, 1, true, or false, found " + bool_string.to_string());
+#else
+
+    return false;
+#endif
+}
+
+xlnt::cell_type type_from_string(const xlnt::detail::text_view &str)
+{
+    if (str == "s")
+    {
+        return xlnt::cell::type::shared_string;
+    }
+    else if (str == "n")
+    {
+        return xlnt::cell::type::number;
+    }
+    else if (str == "b")
+    {
+        return xlnt::cell::type::boolean;
+    }
+    else if (str == "e")
+    {
+        return xlnt::cell::type::error;
+    }
+    else if (str == "inlineStr")
+    {
+        return xlnt::cell::type::inline_string;
+    }
+    else if (str == "str")
+    {
+        return xlnt::cell::type::formula_string;
+    }
+    return xlnt::cell::type::shared_string;
+}
+
+// The functions below mirror parse_cell, parse_row and parse_sheet_data above
+// but read from the sheetData tokenizer instead of xml::parser
+
+xlnt::detail::Cell parse_cell(xlnt::row_t row_arg, xlnt::column_t::index_t column_arg, xlnt::detail::sheet_data_tokenizer &tokenizer, std::unordered_map<std::string, std::string> &array_formulae, std::unordered_map<int, std::string> &shared_formulae)
+{
+    using event = xlnt::detail::sheet_data_tokenizer::event;
+
+    xlnt::detail::Cell c;
+    c.ref = xlnt::detail::Cell_Reference(row_arg, column_arg);
+    for (auto &attr : tokenizer.attributes())
+    {
+        if (attr.name == "r")
+        {
+            c.ref = xlnt::detail::Cell_Reference(row_arg, attr.value.data);
+        }
+        else if (attr.name == "t")
+        {
+            c.type = type_from_string(attr.value);
+        }
+        else if (attr.name == "s")
+        {
+            c.style_index = static_cast<int>(strtol(attr.value.data, nullptr, 10));
+        }
+        else if (attr.name == "ph")
+        {
+            c.is_phonetic = is_true(attr.value);
+        }
+        else if (attr.name == "cm")
+        {
+            c.cell_metatdata_idx = static_cast<int>(strtol(attr.value.data, nullptr, 10));
+        }
+    }
+    int level = 1; // nesting level
+        // 1 == <c>
+        // 2 == <v>/<f>
+        // 3 == <is><t>
+        // exit loop at </c>
+    while (level > 0)
+    {
+        switch (tokenizer.next())
+        {
+        case event::start_element: {
+            if (tokenizer.name() == "f" && tokenizer.attribute_present("t"))
+            {
+                // Skip shared formulas with a ref attribute because it indicates that this
+                // is the master cell which will be handled in the characters case.
+                if (tokenizer.attribute_value("t") == "shared" && !tokenizer.attribute_present("ref"))
+                {
+                    auto shared_index = static_cast<int>(strtol(tokenizer.attribute_value("si").data, nullptr, 10));
+                    c.formula_string = shared_formulae[shared_index];
+                }
+            }
+            ++level;
+            break;
+        }
+        case event::end_element: {
+            --level;
+            break;
+        }
+        case event::characters: {
+            // only want the characters inside one of the nested tags
+            // without this a lot of formatting whitespace can get added
+            const auto &value = tokenizer.value();
+            if (level == 2)
+            {
+                // <v> -> numeric values
+                if (tokenizer.name() == "v")
+                {
+                    c.value.append(value.data, value.size);
+                }
+                // <f> formula
+                else if (tokenizer.name() == "f")
+                {
+                    c.formula_string.append(value.data, value.size);
+
+                    if (tokenizer.attribute_present("t"))
+                    {
+                        auto formula_type = tokenizer.attribute_value("t");
+                        if (formula_type == "shared")
+                        {
+                            auto shared_index = static_cast<int>(strtol(tokenizer.attribute_value("si").data, nullptr, 10));
+                            shared_formulae[shared_index] = c.formula_string;
+                        }
+                        else if (formula_type == "array")
+                        {
+                            array_formulae[tokenizer.attribute_value("ref").to_string()] = c.formula_string;
+                        }
+                    }
+                }
+            }
+            else if (level == 3)
+            {
+                // <is><t> -> inline string
+                if (tokenizer.name() == "t")
+                {
+                    c.value.append(value.data, value.size);
+                }
+            }
+            break;
+        }
+        case event::end_of_sheet_data:
+        default: {
+            throw xlnt::exception("unexcpected XML parsing event");
+        }
+        }
+    }
+    return c;
+}
+
+// <row> inside <sheetData> element
+// cells in columns outside projection, if it isn't null, are skipped unparsed
+std::pair<xlnt::row_properties, int> parse_row(xlnt::row_t row_arg, xlnt::detail::sheet_data_tokenizer &tokenizer, xlnt::detail::number_serialiser &converter, std::vector<xlnt::detail::Cell> &parsed_cells, std::unordered_map<std::string, std::string> &array_formulae, std::unordered_map<int, std::string> &shared_formulae, const xlnt::range_reference *projection)
+{
+    using event = xlnt::detail::sheet_data_tokenizer::event;
+
+    std::pair<xlnt::row_properties, int> props;
+    props.second = static_cast<int>(row_arg);
+    for (auto &attr : tokenizer.attributes())
+    {
+        if (attr.name == "dyDescent")
+        {
+            props.first.dy_descent = converter.deserialise(attr.value.to_string());
+        }
+        else if (attr.name == "spans")
+        {
+            props.first.spans = attr.value.to_string();
+        }
+        else if (attr.name == "ht")
+        {
+            props.first.height = converter.deserialise(attr.value.to_string());
+        }
+        else if (attr.name == "s")
+        {
+            props.first.style = strtoul(attr.value.data, nullptr, 10);
+        }
+        else if (attr.name == "hidden")
+        {
+            props.first.hidden = is_true(attr.value);
+        }
+        else if (attr.name == "customFormat")
+        {
+            props.first.custom_format = is_true(attr.value);
+        }
+        else if (attr.name == "ph")
+        {
+            is_true(attr.value);
+        }
+        else if (attr.name == "r")
+        {
+            props.second = static_cast<int>(strtol(attr.value.data, nullptr, 10));
+        }
+        else if (attr.name == "customHeight")
+        {
+            props.first.custom_height = is_true(attr.value);
+        }
+    }
+
+    xlnt::column_t::index_t next_column = 1;
+    int level = 1;
+    while (level > 0)
+    {
+        switch (tokenizer.next())
+        {
+        case event::start_element: {
+            if (projection != nullptr)
+            {
+                const auto reference = tokenizer.attribute_value("r");
+                const auto column = reference.empty() ? next_column : xlnt::detail::Cell_Reference(0, reference.data).column;
+
+                if (column < projection->top_left().column_index()
+                    || column > projection->bottom_right().column_index())
+                {
+                    tokenizer.skip_element();
+                    next_column = column + 1;
+                    break;
+                }
+            }
+
+            parsed_cells.push_back(parse_cell(static_cast<xlnt::row_t>(props.second), next_column, tokenizer, array_formulae, shared_formulae));
+            next_column = parsed_cells.back().ref.column + 1;
+            break;
+        }
+        case event::end_element: {
+            --level;
+            break;
+        }
+        case event::characters: {
+            // ignore whitespace
+            break;
+        }
+        case event::end_of_sheet_data:
+        default: {
+            throw xlnt::exception("unexcpected XML parsing event");
+        }
+        }
+    }
+    return props;
+}
+
+// <sheetData> inside <worksheet> element
+// rows outside projection, if it isn't null, are skipped unparsed and reading
+// stops at the first row below it since rows are stored in ascending order
+template <typename Callback>
+void parse_sheet_data(xlnt::detail::sheet_data_tokenizer &tokenizer, xlnt::detail::number_serialiser &converter, std::unordered_map<std::string, std::string> &array_formulae, std::unordered_map<int, std::string> &shared_formulae, const xlnt::range_reference *projection, std::size_t batch_size, Callback on_batch)
+{
+    using event = xlnt::detail::sheet_data_tokenizer::event;
+
+    Sheet_Data sheet_data;
+    xlnt::row_t next_row = 1;
+
+    while (true)
+    {
+        auto e = tokenizer.next();
+
+        if (e == event::end_of_sheet_data)
+        {
+            break;
+        }
+        else if (e == event::start_element)
+        {
+            if (projection != nullptr)
+            {
+                const auto row_attribute = tokenizer.attribute_value("r");
+                const auto row = row_attribute.empty() ? next_row : static_cast<xlnt::row_t>(strtoul(row_attribute.data, nullptr, 10));
+
+                if (row < projection->top_left().row())
+                {
+                    tokenizer.skip_element();
+                    next_row = row + 1;
+                    continue;
+                }
+                else if (row > projection->bottom_right().row())
+                {
+                    tokenizer.skip_sheet_data();
+                    break;
+                }
+            }
+
+            sheet_data.parsed_rows.push_back(parse_row(next_row, tokenizer, converter, sheet_data.parsed_cells, array_formulae, shared_formulae, projection));
+            next_row = static_cast<xlnt::row_t>(sheet_data.parsed_rows.back().second) + 1;
+            if (sheet_data.parsed_cells.size() >= batch_size)
+            {
+                on_batch(std::move(sheet_data));
+                sheet_data = Sheet_Data();
+            }
+        }
+        else if (e == event::end_element)
+        {
+            throw xlnt::exception("unexcpected XML parsing event");
+        }
+        // characters are ignored, whitespace formatting normally
+    }
+    if (!sheet_data.parsed_rows.empty())
+    {
+        on_batch(std::move(sheet_data));
+    }
+}
+
+// Builds the cells of ws from a batch of parsed rows
+// format_lookup maps a cellXfs index to the workbook's format_impl and counts
+// the cell's reference to it
+// formulae are dropped if values_only is true
+template <typename Format_Lookup>
+void construct_sheet_data(Sheet_Data &sheet_data, xlnt::detail::worksheet_impl *ws, Format_Lookup format_lookup, const xlnt::detail::number_serialiser &converter, bool values_only)
+{
+    for (auto &row : sheet_data.parsed_rows)
+    {
+        ws->row_properties_.emplace(row.second, std::move(row.first));
+    }
+    ws->cells_.reserve(ws->cells_.size() + sheet_data.parsed_cells.size());
+    // cells are parsed in row order so each row is sized once
+    for (auto first = sheet_data.parsed_cells.begin(); first != sheet_data.parsed_cells.end();)
+    {
+        const auto row = first->ref.row;
+        auto last = std::find_if(first, sheet_data.parsed_cells.end(), [row](const xlnt::detail::Cell &cell) {
+            return cell.ref.row != row;
+        });
+        ws->cells_.reserve_row(row, static_cast<std::size_t>(last - first));
+        first = last;
+    }
+    for (xlnt::detail::Cell &cell : sheet_data.parsed_cells)
+    {
+        xlnt::detail::cell_impl *ws_cell_impl = ws->cells_.emplace(xlnt::cell_reference(cell.ref.column, cell.ref.row)).first;
+        ws_cell_impl->parent_ = ws;
+        if (cell.style_index != -1)
+        {
+            ws_cell_impl->format_ = format_lookup(static_cast<size_t>(cell.style_index));
+        }
+        if (cell.cell_metatdata_idx != -1)
+        {
+        }
+        ws_cell_impl->phonetics_visible_ = cell.is_phonetic;
+        if (!values_only && !cell.formula_string.empty())
+        {
+            ws_cell_impl->extras().formula = cell.formula_string[0] == '=' ? cell.formula_string.substr(1) : std::move(cell.formula_string);
+        }
+        if (!cell.value.empty())
+        {
+            ws_cell_impl->type_ = cell.type;
+            switch (cell.type)
+            {
+            case xlnt::cell::type::boolean: {
+                ws_cell_impl->value_numeric_ = is_true(cell.value) ? 1.0 : 0.0;
+                break;
+            }
+            case xlnt::cell::type::empty:
+            case xlnt::cell::type::number:
+            case xlnt::cell::type::date: {
+                ws_cell_impl->value_numeric_ = converter.deserialise(cell.value);
+                break;
+            }
+            case xlnt::cell::type::shared_string: {
+                ws_cell_impl->value_numeric_ = static_cast<double>(strtol(cell.value.c_str(), nullptr, 10));
+                break;
+            }
+            case xlnt::cell::type::inline_string: {
+                ws_cell_impl->extras().value_text = std::move(cell.value);
+                break;
+            }
+            case xlnt::cell::type::formula_string: {
+                ws_cell_impl->extras().value_text = std::move(cell.value);
+                break;
+            }
+            case xlnt::cell::type::error: {
+                ws_cell_impl->extras().value_text.plain_text(cell.value, false);
+                break;
+            }
+            }
+        }
+    }
+}
+
+const std::size_t sheet_data_batch_size = 4096;
+const std::size_t sheet_data_queued_batches = 4;
+
+using sheet_data_callback = std::function<void(Sheet_Data &&)>;
+
+// Parsing and constructing cells are pipelined. parse runs on the calling
+// thread and passes rows in batches to its callback. The batches are handed
+// through a bounded queue to a second thread which calls construct on them,
+// so only a few batches are ever held in memory. The second thread is only
+// started once a sheet needs more than one batch.
+template <typename Construct>
+void parse_and_construct_sheet_data(const std::function<void(const sheet_data_callback &)> &parse, Construct construct)
+{
+    xlnt::detail::bounded_queue<Sheet_Data> batches(sheet_data_queued_batches);
+    std::thread builder;
+    std::exception_ptr builder_error;
+    Sheet_Data first_batch;
+    bool has_first_batch = false;
+
+    // Ensures the builder has stopped before leaving this scope, including
+    // when parsing throws.
+    struct builder_guard
+    {
+        xlnt::detail::bounded_queue<Sheet_Data> &batches;
+        std::thread &builder;
+
+        ~builder_guard()
+        {
+            batches.close();
+
+            if (builder.joinable())
+            {
+                builder.join();
+            }
+        }
+    } guard{batches, builder};
+
+    parse([&](Sheet_Data &&batch) {
+        if (!has_first_batch)
+        {
+            first_batch = std::move(batch);
+            has_first_batch = true;
+
+            return;
+        }
+
+        if (!builder.joinable())
+        {
+            batches.push(std::move(first_batch));
+            builder = std::thread([&]() {
+                try
+                {
+                    Sheet_Data queued;
+
+                    while (batches.pop(queued))
+                    {
+                        construct(queued);
+                    }
+                }
+                catch (...)
+                {
+                    builder_error = std::current_exception();
+                    batches.close();
+                }
+            });
+        }
+
+        batches.push(std::move(batch));
+    });
+
+    if (builder.joinable())
+    {
+        batches.close();
+        builder.join();
+
+        if (builder_error)
+        {
+            std::rethrow_exception(builder_error);
+        }
+    }
+    else if (has_first_batch)
+    {
+        construct(first_batch);
+    }
+}
+
+// An archive read from data which stays valid as long as the archive since
+// owner, which must hold data, is kept alive along with it
+std::shared_ptr<xlnt::detail::izstream> owning_archive(const std::uint8_t *data, std::size_t size, std::shared_ptr<const void> owner)
+{
+    struct archive_owner
+    {
+        archive_owner(const std::uint8_t *data, std::size_t size, std::shared_ptr<const void> owner)
+            : owner(std::move(owner)),
+              archive(data, size)
+        {
+        }
+
+        std::shared_ptr<const void> owner;
+        xlnt::detail::izstream archive;
+    };
+
+    auto holder = std::make_shared<archive_owner>(data, size, std::move(owner));
+
+    return std::shared_ptr<xlnt::detail::izstream>(holder, &holder->archive);
+}
+
+// An archive read from an in-memory copy of data, so it stays readable
+// after data is gone
+std::shared_ptr<xlnt::detail::izstream> buffered_archive(const std::uint8_t *data, std::size_t size)
+{
+    auto copy = std::make_shared<std::vector<std::uint8_t>>(data, data + size);
+
+    return owning_archive(copy->data(), copy->size(), copy);
+}
+
+// Like buffered_archive(data, size) but the archive is read from source
+std::shared_ptr<xlnt::detail::izstream> buffered_archive(std::istream &source)
+{
+    source.seekg(0, std::ios::end);
+    auto copy = std::make_shared<std::vector<std::uint8_t>>(static_cast<std::size_t>(source.tellg()));
+    source.seekg(0, std::ios::beg);
+    source.read(reinterpret_cast<char *>(copy->data()), static_cast<std::streamsize>(copy->size()));
+
+    return owning_archive(copy->data(), copy->size(), copy);
 }
 
 } // namespace
@@ -411,6 +976,18 @@ private:
 namespace xlnt {
 namespace detail {
 
+/// <summary>
+/// What's needed to read a worksheet of a workbook loaded with
+/// load_options::lazy_worksheets after load has returned. This is shared
+/// by all worksheets of the workbook.
+/// </summary>
+struct deferred_worksheet
+{
+    std::shared_ptr<izstream> archive;
+    load_options options;
+    std::vector<defined_name> defined_names;
+};
+
 xlsx_consumer::xlsx_consumer(workbook &target)
     : target_(target),
       parser_(nullptr)
@@ -423,10 +1000,74 @@ xlsx_consumer::~xlsx_consumer()
 
 void xlsx_consumer::read(std::istream &source)
 {
-    archive_.reset(new izstream(source));
+    if (options_.lazy_worksheets())
+    {
+        archive_ = buffered_archive(source);
+    }
+    else
+    {
+        archive_.reset(new izstream(source));
+    }
+
     populate_workbook(false);
 }
 
+void xlsx_consumer::read(const std::uint8_t *data, std::size_t size, const load_options &options, std::shared_ptr<const void> owner)
+{
+    options_ = options;
+
+    if (options_.lazy_worksheets())
+    {
+        archive_ = owner ? owning_archive(data, size, std::move(owner)) : buffered_archive(data, size);
+    }
+    else
+    {
+        archive_.reset(new izstream(data, size));
+    }
+
+    populate_workbook(false);
+}
+
+void xlsx_consumer::read_deferred_worksheet(worksheet_impl &ws)
+{
+    if (!ws.deferred_pending_.load(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    auto &wb = *ws.parent_;
+    std::lock_guard<std::recursive_mutex> lock(wb.d_->deferred_mutex_);
+
+    if (!ws.deferred_)
+    {
+        // read by another thread while waiting for the lock or being read by this one
+        return;
+    }
+
+    // cleared first so accessing the worksheet while it's read doesn't read it again
+    auto deferred = std::move(ws.deferred_);
+
+    xlsx_consumer consumer(wb);
+    consumer.archive_ = deferred->archive;
+    consumer.options_ = deferred->options;
+    consumer.defined_names_ = deferred->defined_names;
+    consumer.current_worksheet_ = &ws;
+
+    // the relationship ID is looked up now since removing other worksheets renumbers them
+    const auto workbook_rel = wb.manifest().relationship(path("/"), relationship_type::office_document);
+    const auto worksheet_rel = wb.manifest().relationship(workbook_rel.target().path(),
+        wb.d_->sheet_title_rel_id_map_.at(ws.title_));
+
+    consumer.read_worksheet_part({workbook_rel, worksheet_rel}, false);
+    ws.deferred_pending_.store(false, std::memory_order_release);
+}
+
+void xlsx_consumer::read(std::istream &source, const load_options &options)
+{
+    options_ = options;
+    read(source);
+}
+
 void xlsx_consumer::open(std::istream &source)
 {
     archive_.reset(new izstream(source));
@@ -435,7 +1076,7 @@ void xlsx_consumer::open(std::istream &source)
 
 cell xlsx_consumer::read_cell()
 {
-    return cell(streaming_cell_.get());
+    return cell(streaming_cell_.get(), streaming_cell_->parent_);
 }
 
 void xlsx_consumer::read_worksheet(const std::string &rel_id)
@@ -522,6 +1163,9 @@ std::string xlsx_consumer::read_worksheet_begin(const std::string &rel_id)
     
     array_formulae_.clear();
     shared_formulae_.clear();
+    pending_hyperlinks_.clear();
+    pending_merged_cells_.clear();
+    tab_selected_ = false;
 
     auto title = std::find_if(target_.d_->sheet_title_rel_id_map_.begin(),
         target_.d_->sheet_title_rel_id_map_.end(),
@@ -646,7 +1290,7 @@ std::string xlsx_consumer::read_worksheet_begin(const std::string &rel_id)
                 if (parser().attribute_present("tabSelected")
                     && is_true(parser().attribute("tabSelected")))
                 {
-                    target_.d_->view_.get().active_tab = ws.id() - 1;
+                    tab_selected_ = true;
                 }
 
                 skip_attributes({"windowProtection", "showFormulas", "showRowColHeaders", "showZeros", "rightToLeft", "showRuler", "showOutlineSymbols", "showWhiteSpace",
@@ -838,74 +1482,56 @@ void xlsx_consumer::read_worksheet_sheetdata()
         return;
     }
 
-    auto ws_data = parse_sheet_data(parser_, converter_, array_formulae_, shared_formulae_);
-    // NOTE: parse->construct are seperated here and could easily be threaded
-    // with a SPSC queue for what is likely to be an easy performance win
-    for (auto &row : ws_data.parsed_rows)
-    {
-        current_worksheet_->row_properties_.emplace(row.second, std::move(row.first));
-    }
-    auto impl = detail::cell_impl();
-    for (Cell &cell : ws_data.parsed_cells)
-    {
-        impl.parent_ = current_worksheet_;
-        impl.column_ = cell.ref.column;
-        impl.row_ = cell.ref.row;
-        detail::cell_impl *ws_cell_impl = &current_worksheet_->cell_map_.emplace(cell_reference(impl.column_, impl.row_), std::move(impl)).first->second;
-        if (cell.style_index != -1)
+    auto format_lookup = [this](std::size_t index) {
+        if (index >= pending_format_references_.size())
         {
-            ws_cell_impl->format_ = target_.format(static_cast<size_t>(cell.style_index)).d_;
+            pending_format_references_.resize(index + 1, 0);
         }
-        if (cell.cell_metatdata_idx != -1)
-        {
-        }
-        ws_cell_impl->phonetics_visible_ = cell.is_phonetic;
-        if (!cell.formula_string.empty())
-        {
-            ws_cell_impl->formula_ = cell.formula_string[0] == '=' ? cell.formula_string.substr(1) : std::move(cell.formula_string);
-        }
-        if (!cell.value.empty())
+        ++pending_format_references_[index];
+        return target_.format(index).d_;
+    };
+
+    parse_and_construct_sheet_data(
+        [&](const sheet_data_callback &on_batch) {
+            parse_sheet_data(parser_, converter_, array_formulae_, shared_formulae_, projection(), sheet_data_batch_size, on_batch);
+        },
+        [&](Sheet_Data &batch) {
+            construct_sheet_data(batch, current_worksheet_, format_lookup, converter_, options_.values_only());
+        });
+
+    stack_.pop_back();
+}
+
+void xlsx_consumer::read_worksheet_sheetdata(sheet_data_tokenizer &tokenizer)
+{
+    auto format_lookup = [this](std::size_t index) {
+        if (index >= pending_format_references_.size())
         {
-            ws_cell_impl->type_ = cell.type;
-            switch (cell.type)
-            {
-            case cell::type::boolean: {
-                ws_cell_impl->value_numeric_ = is_true(cell.value) ? 1.0 : 0.0;
-                break;
-            }
-            case cell::type::empty:
-            case cell::type::number:
-            case cell::type::date: {
-                ws_cell_impl->value_numeric_ = converter_.deserialise(cell.value);
-                break;
-            }
-            case cell::type::shared_string: {
-                ws_cell_impl->value_numeric_ = static_cast<double>(strtol(cell.value.c_str(), nullptr, 10));
-                break;
-            }
-            case cell::type::inline_string: {
-                ws_cell_impl->value_text_ = std::move(cell.value);
-                break;
-            }
-            case cell::type::formula_string: {
-                ws_cell_impl->value_text_ = std::move(cell.value);
-                break;
-            }
-            case cell::type::error: {
-                ws_cell_impl->value_text_.plain_text(cell.value, false);
-                break;
-            }
-            }
+            pending_format_references_.resize(index + 1, 0);
         }
-    }
-    stack_.pop_back();
-    
-    
+        ++pending_format_references_[index];
+        return target_.format(index).d_;
+    };
+
+    parse_and_construct_sheet_data(
+        [&](const sheet_data_callback &on_batch) {
+            parse_sheet_data(tokenizer, converter_, array_formulae_, shared_formulae_, projection(), sheet_data_batch_size, on_batch);
+        },
+        [&](Sheet_Data &batch) {
+            construct_sheet_data(batch, current_worksheet_, format_lookup, converter_, options_.values_only());
+        });
 }
 
 worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
 {
-    auto &manifest = target_.manifest();
+    read_worksheet_trailer(rel_id);
+
+    return read_worksheet_related_parts(rel_id);
+}
+
+void xlsx_consumer::read_worksheet_trailer(const std::string &rel_id)
+{
+    const auto &manifest = target_.manifest();
 
     const auto workbook_rel = manifest.relationship(path("/"), relationship_type::office_document);
     const auto sheet_rel = manifest.relationship(workbook_rel.target().path(), rel_id);
@@ -959,7 +1585,7 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
             while (in_element(qn("spreadsheetml", "mergeCells")))
             {
                 expect_start_element(qn("spreadsheetml", "mergeCell"), xml::content::simple);
-                ws.merge_cells(range_reference(parser().attribute("ref")));
+                pending_merged_cells_.push_back(range_reference(parser().attribute("ref")));
                 expect_end_element(qn("spreadsheetml", "mergeCell"));
             }
         }
@@ -986,6 +1612,11 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
         }
         else if (current_worksheet_element == qn("spreadsheetml", "hyperlinks")) // CT_Hyperlinks 0-1
         {
+            if (options_.values_only())
+            {
+                skip_remaining_content(current_worksheet_element);
+            }
+
             while (in_element(current_worksheet_element))
             {
                 // CT_Hyperlink
@@ -1001,16 +1632,7 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
 
                     if (hyperlink_rel != hyperlinks.end())
                     {
-                        auto url = hyperlink_rel->target().path().string();
-
-                        if (cell.has_value())
-                        {
-                            cell.hyperlink(url, cell.value<std::string>());
-                        }
-                        else
-                        {
-                            cell.hyperlink(url);
-                        }
+                        pending_hyperlinks_.emplace_back(cell.reference(), hyperlink_rel->target().path().string());
                     }
                 }
                 else if (parser().attribute_present("location"))
@@ -1031,7 +1653,7 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
                         hyperlink.tooltip = parser().attribute("tooltip");
                     }
 
-                    cell.d_->hyperlink_ = hyperlink;
+                    cell.d_->extras().hyperlink = hyperlink;
                 }
 
                 expect_end_element(qn("spreadsheetml", "hyperlink"));
@@ -1289,19 +1911,62 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
         }
         else if (current_worksheet_element == qn("spreadsheetml", "extLst"))
         {
-            ext_list extensions(parser(), current_worksheet_element.namespace_());
-            ws.d_->extension_list_.set(extensions);
+            ext_list extensions(parser(), current_worksheet_element.namespace_());
+            ws.d_->extension_list_.set(extensions);
+        }
+        else
+        {
+            unexpected_element(current_worksheet_element);
+        }
+
+        expect_end_element(current_worksheet_element);
+    }
+
+    expect_end_element(qn("spreadsheetml", "worksheet"));
+}
+
+worksheet xlsx_consumer::read_worksheet_related_parts(const std::string &rel_id)
+{
+    auto &manifest = target_.manifest();
+
+    const auto workbook_rel = manifest.relationship(path("/"), relationship_type::office_document);
+    const auto sheet_rel = manifest.relationship(workbook_rel.target().path(), rel_id);
+    path sheet_path(sheet_rel.source().path().parent().append(sheet_rel.target().path()));
+
+    auto ws = worksheet(current_worksheet_);
+    unregister_skipped_parts(sheet_path);
+
+    for (std::size_t index = 0; index < pending_format_references_.size(); ++index)
+    {
+        target_.format(index).d_->references += pending_format_references_[index];
+    }
+
+    pending_format_references_.clear();
+
+    if (tab_selected_)
+    {
+        target_.d_->view_.get().active_tab = ws.id() - 1;
+    }
+
+    for (const auto &merged_range : pending_merged_cells_)
+    {
+        ws.merge_cells(merged_range);
+    }
+
+    for (const auto &link : pending_hyperlinks_)
+    {
+        auto cell = ws.cell(link.first);
+
+        if (cell.has_value())
+        {
+            cell.hyperlink(link.second, cell.value<std::string>());
         }
         else
         {
-            unexpected_element(current_worksheet_element);
+            cell.hyperlink(link.second);
         }
-
-        expect_end_element(current_worksheet_element);
     }
 
-    expect_end_element(qn("spreadsheetml", "worksheet"));
-
     if (manifest.has_relationship(sheet_path, xlnt::relationship_type::comments))
     {
         auto comments_part = manifest.canonicalize({workbook_rel, sheet_rel,
@@ -1350,13 +2015,16 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
                 relationship_type::printer_settings)});
     }
     
-    for (auto array_formula : array_formulae_)
+    if (!options_.values_only())
     {
-        for (auto row : ws.range(array_formula.first))
+        for (auto array_formula : array_formulae_)
         {
-            for (auto cell : row)
+            for (auto row : ws.range(array_formula.first))
             {
-                cell.formula(array_formula.second);
+                for (auto cell : row)
+                {
+                    cell.formula(array_formula.second);
+                }
             }
         }
     }
@@ -1372,72 +2040,106 @@ xml::parser &xlsx_consumer::parser()
 bool xlsx_consumer::has_cell()
 {
     auto ws = worksheet(current_worksheet_);
+    const auto cell_range = projection();
 
-    while (streaming_cell_ // we're not at the end of the file
-           && !in_element(qn("spreadsheetml", "row"))) // we're at the end of a row, or between rows
+    // cells outside the projection, if any, are skipped until one inside it is found
+    while (true)
     {
-        if (parser().peek() == xml::parser::event_type::end_element
-            && stack_.back() == qn("spreadsheetml", "row"))
+        while (streaming_cell_ // we're not at the end of the file
+               && !in_element(qn("spreadsheetml", "row"))) // we're at the end of a row, or between rows
         {
-            // We're at the end of a row.
-            expect_end_element(qn("spreadsheetml", "row"));
-            // ... and keep parsing.
-        }
+            if (parser().peek() == xml::parser::event_type::end_element
+                && stack_.back() == qn("spreadsheetml", "row"))
+            {
+                // We're at the end of a row.
+                expect_end_element(qn("spreadsheetml", "row"));
+                // ... and keep parsing.
+            }
 
-        if (parser().peek() == xml::parser::event_type::end_element
-            && stack_.back() == qn("spreadsheetml", "sheetData"))
-        {
-            // End of sheet. Mark it by setting streaming_cell_ to nullptr, so we never get here again.
-            expect_end_element(qn("spreadsheetml", "sheetData"));
-            streaming_cell_.reset(nullptr);
-            break;
-        }
+            if (parser().peek() == xml::parser::event_type::end_element
+                && stack_.back() == qn("spreadsheetml", "sheetData"))
+            {
+                // End of sheet. Mark it by setting streaming_cell_ to nullptr, so we never get here again.
+                expect_end_element(qn("spreadsheetml", "sheetData"));
+                streaming_cell_.reset(nullptr);
+                break;
+            }
 
-        expect_start_element(qn("spreadsheetml", "row"), xml::content::complex); // CT_Row
-        auto row_index = static_cast<row_t>(std::stoul(parser().attribute("r")));
-        auto &row_properties = ws.row_properties(row_index);
+            expect_start_element(qn("spreadsheetml", "row"), xml::content::complex); // CT_Row
+            auto row_index = static_cast<row_t>(std::stoul(parser().attribute("r")));
 
-        if (parser().attribute_present("ht"))
-        {
-            row_properties.height = converter_.deserialise(parser().attribute("ht"));
-        }
+            if (cell_range != nullptr
+                && (row_index < cell_range->top_left().row() || row_index > cell_range->bottom_right().row()))
+            {
+                skip_remaining_content(qn("spreadsheetml", "row"));
+                expect_end_element(qn("spreadsheetml", "row"));
 
-        if (parser().attribute_present("customHeight"))
-        {
-            row_properties.custom_height = is_true(parser().attribute("customHeight"));
-        }
+                // rows are in ascending order so nothing else is in the range
+                while (row_index > cell_range->bottom_right().row()
+                    && in_element(qn("spreadsheetml", "sheetData")))
+                {
+                    expect_start_element(qn("spreadsheetml", "row"), xml::content::complex);
+                    skip_remaining_content(qn("spreadsheetml", "row"));
+                    expect_end_element(qn("spreadsheetml", "row"));
+                }
 
-        if (parser().attribute_present("hidden") && is_true(parser().attribute("hidden")))
-        {
-            row_properties.hidden = true;
+                continue;
+            }
+
+            auto &row_properties = ws.row_properties(row_index);
+
+            if (parser().attribute_present("ht"))
+            {
+                row_properties.height = converter_.deserialise(parser().attribute("ht"));
+            }
+
+            if (parser().attribute_present("customHeight"))
+            {
+                row_properties.custom_height = is_true(parser().attribute("customHeight"));
+            }
+
+            if (parser().attribute_present("hidden") && is_true(parser().attribute("hidden")))
+            {
+                row_properties.hidden = true;
+            }
+
+            if (parser().attribute_present(qn("x14ac", "dyDescent")))
+            {
+                row_properties.dy_descent = converter_.deserialise(parser().attribute(qn("x14ac", "dyDescent")));
+            }
+
+            if (parser().attribute_present("spans"))
+            {
+                row_properties.spans = parser().attribute("spans");
+            }
+
+            skip_attributes({"customFormat", "s", "customFont",
+                "outlineLevel", "collapsed", "thickTop", "thickBot",
+                "ph"});
         }
 
-        if (parser().attribute_present(qn("x14ac", "dyDescent")))
+        if (!streaming_cell_)
         {
-            row_properties.dy_descent = converter_.deserialise(parser().attribute(qn("x14ac", "dyDescent")));
+            // We're at the end of the worksheet
+            return false;
         }
 
-        if (parser().attribute_present("spans"))
+        expect_start_element(qn("spreadsheetml", "c"), xml::content::complex);
+
+        if (cell_range != nullptr && !cell_range->contains(cell_reference(parser().attribute("r"))))
         {
-            row_properties.spans = parser().attribute("spans");
-        }
+            skip_remaining_content(qn("spreadsheetml", "c"));
+            expect_end_element(qn("spreadsheetml", "c"));
 
-        skip_attributes({"customFormat", "s", "customFont",
-            "outlineLevel", "collapsed", "thickTop", "thickBot",
-            "ph"});
-    }
+            continue;
+        }
 
-    if (!streaming_cell_)
-    {
-        // We're at the end of the worksheet
-        return false;
+        break;
     }
 
-    expect_start_element(qn("spreadsheetml", "c"), xml::content::complex);
-
     assert(streaming_);
     streaming_cell_.reset(new detail::cell_impl()); // Clean cell state - otherwise it might contain information from the previously streamed cell.
-    auto cell = xlnt::cell(streaming_cell_.get());
+    auto cell = xlnt::cell(streaming_cell_.get(), current_worksheet_);
     auto reference = cell_reference(parser().attribute("r"));
     cell.d_->parent_ = current_worksheet_;
     cell.d_->column_ = reference.column_index();
@@ -1548,12 +2250,12 @@ bool xlsx_consumer::has_cell()
     {
         if (type == "str")
         {
-            cell.d_->value_text_ = value_string;
+            cell.d_->extras().value_text = value_string;
             cell.data_type(cell::type::formula_string);
         }
         else if (type == "inlineStr")
         {
-            cell.d_->value_text_ = value_string;
+            cell.d_->extras().value_text = value_string;
             cell.data_type(cell::type::inline_string);
         }
         else if (type == "s")
@@ -1763,6 +2465,7 @@ void xlsx_consumer::read_part(const std::vector<relationship> &rel_chain)
 void xlsx_consumer::populate_workbook(bool streaming)
 {
     streaming_ = streaming;
+    archive_->inflate_buffer_size(options_.inflate_buffer_size());
 
     target_.clear();
 
@@ -1774,6 +2477,8 @@ void xlsx_consumer::populate_workbook(bool streaming)
         manifest().register_relationship(package_rel);
     }
 
+    unregister_skipped_parts(root_path);
+
     for (auto package_rel : manifest().relationships(root_path))
     {
         if (package_rel.type() == relationship_type::office_document)
@@ -2179,6 +2884,11 @@ void xlsx_consumer::read_office_document(const std::string &content_type) // CT_
     auto workbook_rel = manifest().relationship(path("/"), relationship_type::office_document);
     auto workbook_path = workbook_rel.target().path();
 
+    if (!streaming_)
+    {
+        unregister_skipped_parts(workbook_path);
+    }
+
     const auto rel_types = {
         relationship_type::shared_string_table,
         relationship_type::stylesheet,
@@ -2186,6 +2896,26 @@ void xlsx_consumer::read_office_document(const std::string &content_type) // CT_
         relationship_type::vbaproject,
     };
 
+    struct prefetch_guard
+    {
+        ~prefetch_guard()
+        {
+            archive.stop_prefetch();
+        }
+
+        izstream &archive;
+    } prefetch{*archive_};
+
+    if (!streaming_ && options_.prefetch_threads() > 0)
+    {
+        archive_->prefetch(prefetched_parts(workbook_rel, rel_types), options_.prefetch_threads());
+    }
+
+    if (!streaming_ && options_.cell_arena())
+    {
+        target_.d_->cell_arenas_ = true;
+    }
+
     for (auto rel_type : rel_types)
     {
         if (manifest().has_relationship(workbook_path, rel_type))
@@ -2195,6 +2925,26 @@ void xlsx_consumer::read_office_document(const std::string &content_type) // CT_
         }
     }
 
+    for (const auto &title : options_.sheet_titles())
+    {
+        if (sheet_title_index_map_.find(title) == sheet_title_index_map_.end())
+        {
+            throw key_not_found();
+        }
+    }
+
+    for (auto index : options_.sheet_indices())
+    {
+        if (index >= sheet_title_index_map_.size())
+        {
+            throw key_not_found();
+        }
+    }
+
+    std::vector<std::vector<relationship>> worksheet_rel_chains;
+    std::vector<worksheet_impl *> worksheets;
+    std::vector<worksheet_impl *> skipped_worksheets;
+
     for (auto worksheet_rel : manifest().relationships(workbook_path, relationship_type::worksheet))
     {
         auto title = std::find_if(target_.d_->sheet_title_rel_id_map_.begin(),
@@ -2214,12 +2964,303 @@ void xlsx_consumer::read_office_document(const std::string &content_type) // CT_
         }
 
         current_worksheet_ = &*target_.d_->worksheets_.emplace(insertion_iter, &target_, id, title);
+        if (target_.d_->cell_arenas_)
+        {
+            current_worksheet_->cells_.use_arena(std::make_shared<detail::arena>());
+        }
+
+        if (!streaming_ && !options_.loads_sheet(index, title))
+        {
+            skipped_worksheets.push_back(current_worksheet_);
+            continue;
+        }
+
+        worksheet_rel_chains.push_back({workbook_rel, worksheet_rel});
+        worksheets.push_back(current_worksheet_);
+    }
+
+    if (!streaming_ && options_.lazy_worksheets())
+    {
+        auto deferred = std::make_shared<deferred_worksheet>();
+        deferred->archive = archive_;
+        deferred->options = options_;
+        deferred->defined_names = defined_names_;
+
+        for (auto ws : worksheets)
+        {
+            ws->deferred_ = deferred;
+            ws->deferred_pending_.store(true, std::memory_order_relaxed);
+        }
+
+        remove_worksheets(skipped_worksheets);
+    }
+    else if (!streaming_)
+    {
+        read_worksheets(worksheet_rel_chains, worksheets);
+        remove_worksheets(skipped_worksheets);
+    }
+}
+
+std::vector<path> xlsx_consumer::prefetched_parts(const relationship &workbook_rel,
+    const std::vector<relationship_type> &rel_types)
+{
+    const auto workbook_path = workbook_rel.target().path();
+    std::vector<path> parts;
+
+    for (auto rel_type : rel_types)
+    {
+        if (manifest().has_relationship(workbook_path, rel_type))
+        {
+            parts.push_back(manifest().canonicalize({workbook_rel,
+                manifest().relationship(workbook_path, rel_type)}));
+        }
+    }
+
+    // worksheets read concurrently are inflated by the threads reading them
+    auto thread_count = options_.worker_threads();
+
+    if (options_.lazy_worksheets() || thread_count != 1)
+    {
+        return parts;
+    }
+
+    for (auto worksheet_rel : manifest().relationships(workbook_path, relationship_type::worksheet))
+    {
+        auto title = std::find_if(target_.d_->sheet_title_rel_id_map_.begin(),
+            target_.d_->sheet_title_rel_id_map_.end(),
+            [&](const std::pair<std::string, std::string> &p) {
+                return p.second == worksheet_rel.id();
+            })->first;
+
+        if (options_.loads_sheet(sheet_title_index_map_[title], title))
+        {
+            parts.push_back(manifest().canonicalize({workbook_rel, worksheet_rel}));
+        }
+    }
+
+    return parts;
+}
+
+void xlsx_consumer::remove_worksheets(const std::vector<worksheet_impl *> &skipped_worksheets)
+{
+    auto &active_index = target_.d_->active_sheet_index_;
+    auto &hidden = target_.d_->sheet_hidden_;
+
+    for (auto skipped : skipped_worksheets)
+    {
+        auto ws = worksheet(skipped);
+        auto index = target_.index(ws);
+
+        if (index < hidden.size())
+        {
+            hidden.erase(hidden.begin() + static_cast<std::ptrdiff_t>(index));
+        }
+
+        if (active_index.is_set() && active_index.get() >= index)
+        {
+            // The active sheet moves down with the sheets after it. If it's
+            // the one being removed, the first remaining sheet becomes active.
+            active_index.set(active_index.get() == index ? 0 : active_index.get() - 1);
+
+            if (target_.has_view())
+            {
+                target_.d_->view_.get().active_tab = active_index.get();
+            }
+        }
+
+        target_.remove_sheet(ws);
+    }
+}
+
+void xlsx_consumer::unregister_skipped_parts(const path &source)
+{
+    const auto workbook_path = manifest().relationship(path("/"), relationship_type::office_document).target().path();
+    auto &sheet_rel_ids = target_.d_->sheet_title_rel_id_map_;
+
+    while (true)
+    {
+        auto rels = manifest().relationships(source);
+        auto skipped = std::find_if(rels.begin(), rels.end(),
+            [this](const relationship &r) { return skips_part(r.type()); });
+
+        if (skipped == rels.end())
+        {
+            break;
+        }
+
+        if (skipped->target_mode() == target_mode::internal)
+        {
+            manifest().unregister_override_type(skipped->target().path().resolve(source.parent()).resolve(path("/")));
+        }
+
+        // Later relationships of source are renumbered, which affects the
+        // worksheet relationship IDs read from the workbook part
+        auto rel_id_map = manifest().unregister_relationship(skipped->source(), skipped->id());
+
+        if (source != workbook_path)
+        {
+            continue;
+        }
+
+        for (auto &title_rel_id_pair : sheet_rel_ids)
+        {
+            if (rel_id_map.count(title_rel_id_pair.second) > 0)
+            {
+                title_rel_id_pair.second = rel_id_map[title_rel_id_pair.second];
+            }
+        }
+    }
+}
+
+const range_reference *xlsx_consumer::projection() const
+{
+    return options_.projection().is_set() ? &options_.projection().get() : nullptr;
+}
+
+bool xlsx_consumer::skips_part(relationship_type type) const
+{
+    switch (type)
+    {
+    case relationship_type::comments:
+    case relationship_type::vml_drawing:
+        return options_.skip_comments();
+
+    case relationship_type::drawings:
+    case relationship_type::image:
+    case relationship_type::thumbnail:
+        return options_.skip_drawings();
+
+    case relationship_type::core_properties:
+    case relationship_type::extended_properties:
+    case relationship_type::custom_properties:
+        return options_.skip_properties();
 
-        if (!streaming_)
+    case relationship_type::theme:
+        return options_.skip_themes();
+
+    default:
+        return false;
+    }
+}
+
+void xlsx_consumer::read_worksheets(const std::vector<std::vector<relationship>> &rel_chains,
+    const std::vector<worksheet_impl *> &current_worksheets)
+{
+    auto thread_count = options_.worker_threads();
+
+    if (thread_count == 0)
+    {
+        thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    thread_count = std::min(thread_count, rel_chains.size());
+
+    if (thread_count <= 1)
+    {
+        for (std::size_t i = 0; i < rel_chains.size(); ++i)
+        {
+            current_worksheet_ = current_worksheets[i];
+            read_worksheet_part(rel_chains[i], false);
+        }
+
+        return;
+    }
+
+    // Each worksheet part is parsed by its own consumer on one of the worker threads.
+    // Anything which touches the workbook rather than the worksheet being read is
+    // deferred and applied below on this thread in sheet order, so the result
+    // is identical to reading the worksheets one after another.
+    std::vector<std::unique_ptr<xlsx_consumer>> sheet_consumers;
+    std::vector<std::exception_ptr> errors(rel_chains.size());
+
+    for (auto ws : current_worksheets)
+    {
+        sheet_consumers.emplace_back(new xlsx_consumer(target_));
+        auto &sheet_consumer = *sheet_consumers.back();
+        sheet_consumer.archive_ = archive_;
+        sheet_consumer.options_ = options_;
+        sheet_consumer.defined_names_ = defined_names_;
+        sheet_consumer.current_worksheet_ = ws;
+    }
+
+    std::atomic<std::size_t> next_sheet(0);
+
+    auto work = [&]() {
+        for (auto i = next_sheet++; i < rel_chains.size(); i = next_sheet++)
+        {
+            try
+            {
+                sheet_consumers[i]->read_worksheet_part(rel_chains[i], true);
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+
+    for (std::size_t i = 1; i < thread_count; ++i)
+    {
+        threads.emplace_back(work);
+    }
+
+    work();
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    for (std::size_t i = 0; i < rel_chains.size(); ++i)
+    {
+        if (errors[i])
         {
-            read_part({workbook_rel, worksheet_rel});
+            std::rethrow_exception(errors[i]);
         }
+
+        sheet_consumers[i]->read_worksheet_related_parts(rel_chains[i].back().id());
+    }
+}
+
+void xlsx_consumer::read_worksheet_part(const std::vector<relationship> &rel_chain, bool detached)
+{
+    const auto part_path = target_.manifest().canonicalize(rel_chain);
+    auto part_streambuf = detached ? archive_->open_detached(part_path) : archive_->open(part_path);
+    std::istream part_stream(part_streambuf.get());
+
+    // sheetData is read straight from the part by the tokenizer and the rest of
+    // the worksheet, with an empty sheetData in its place, by xml::parser
+    sheet_data_tokenizer tokenizer(part_stream);
+    std::string document;
+    std::unordered_map<std::string, std::string> tokenized_array_formulae;
+
+    if (tokenizer.read_to_sheet_data(document))
+    {
+        array_formulae_.clear();
+        shared_formulae_.clear();
+        read_worksheet_sheetdata(tokenizer);
+        tokenized_array_formulae.swap(array_formulae_);
+    }
+
+    tokenizer.read_remainder(document);
+
+    xml::parser parser(document.data(), document.size(), part_path.string());
+    parser_ = &parser;
+
+    const auto &rel_id = rel_chain.back().id();
+    read_worksheet_begin(rel_id);
+    array_formulae_.insert(tokenized_array_formulae.begin(), tokenized_array_formulae.end());
+    read_worksheet_sheetdata();
+    read_worksheet_trailer(rel_id);
+
+    if (!detached)
+    {
+        read_worksheet_related_parts(rel_id);
     }
+
+    parser_ = nullptr;
 }
 
 // Write Workbook Relationship Target Parts
@@ -2280,7 +3321,7 @@ void xlsx_consumer::read_shared_string_table()
 
     expect_end_element(qn("spreadsheetml", "sst"));
 
-    if (has_unique_count && unique_count != target_.shared_strings().size())
+    if (has_unique_count && unique_count != target_.d_->shared_strings_->size())
     {
         throw invalid_file("sizes don't match");
     }
@@ -2940,14 +3981,9 @@ void xlsx_consumer::read_stylesheet()
         new_style.d_->number_format_id = record.first.number_format_id;
     }
 
-    std::size_t record_index = 0;
-
     for (const auto &record : format_records)
     {
-        stylesheet.format_impls.push_back(format_impl());
-        auto &new_format = stylesheet.format_impls.back();
-
-        new_format.id = record_index++;
+        format_impl new_format;
         new_format.parent = &stylesheet;
 
         ++new_format.references;
@@ -2968,6 +4004,7 @@ void xlsx_consumer::read_stylesheet()
         new_format.quote_prefix_ = record.first.quote_prefix_;
 
         set_style_by_xfid(styles, record.second, new_format.style);
+        stylesheet.format_impls.push_back(new_format);
     }
 }
 
@@ -3124,6 +4161,10 @@ variant xlsx_consumer::read_variant()
         {
             value = variant(std::stoi(text));
         }
+        if (element == qn("vt", "r8"))
+        {
+            value = variant(converter_.deserialise(text));
+        }
         if (element == qn("vt", "bool"))
         {
             value = variant(is_true(text));
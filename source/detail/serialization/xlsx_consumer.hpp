@@ -34,7 +34,11 @@
 
 #include <detail/external/include_libstudxml.hpp>
 #include <detail/serialization/zstream.hpp>
+#include <xlnt/cell/cell_reference.hpp>
+#include <xlnt/packaging/relationship.hpp>
 #include <xlnt/utils/numeric.hpp>
+#include <xlnt/workbook/load_options.hpp>
+#include <xlnt/worksheet/range_reference.hpp>
 
 namespace xlnt {
 
@@ -45,8 +49,6 @@ class manifest;
 template<typename T>
 class optional;
 class path;
-class range_reference;
-class relationship;
 class streaming_workbook_reader;
 class variant;
 class workbook;
@@ -55,6 +57,7 @@ class worksheet;
 namespace detail {
 
 class izstream;
+class sheet_data_tokenizer;
 struct cell_impl;
 struct defined_name;
 struct worksheet_impl;
@@ -73,6 +76,24 @@ public:
 
 	void read(std::istream &source, const std::string &password);
 
+	void read(std::istream &source, const load_options &options);
+
+    /// <summary>
+    /// Reads the archive of size bytes at data. With load_options::lazy_worksheets
+    /// the archive has to outlive this call, so it's kept alive by holding owner,
+    /// or copied if owner is null.
+    /// </summary>
+    void read(const std::uint8_t *data, std::size_t size, const load_options &options,
+        std::shared_ptr<const void> owner = nullptr);
+
+    /// <summary>
+    /// Reads the worksheet part of ws if it was deferred because its workbook
+    /// was loaded with load_options::lazy_worksheets. Does nothing otherwise.
+    /// Worksheets of the same workbook may be read from several threads, the
+    /// reads are serialized by the workbook.
+    /// </summary>
+    static void read_deferred_worksheet(worksheet_impl &ws);
+
 private:
     friend class xlnt::streaming_workbook_reader;
 
@@ -215,11 +236,76 @@ private:
     /// </summary>
     void read_worksheet_sheetdata();
 
+    /// <summary>
+    /// Reads the rows of sheetData from the tokenizer into the current worksheet.
+    /// </summary>
+    void read_worksheet_sheetdata(sheet_data_tokenizer &tokenizer);
+
     /// <summary>
     /// xl/sheets/*.xml
     /// </summary>
     worksheet read_worksheet_end(const std::string &rel_id);
 
+    /// <summary>
+    /// Reads the elements of a worksheet following sheetData. Changes that
+    /// touch workbook-level state are recorded and applied later by
+    /// read_worksheet_related_parts so that this can run on a worker thread.
+    /// </summary>
+    void read_worksheet_trailer(const std::string &rel_id);
+
+    /// <summary>
+    /// Applies the changes deferred by read_worksheet_trailer and reads the
+    /// parts related to the worksheet (comments, drawings, printer settings).
+    /// </summary>
+    worksheet read_worksheet_related_parts(const std::string &rel_id);
+
+    /// <summary>
+    /// Reads every worksheet in the given relationship chains, parsing the
+    /// worksheet parts concurrently when options_ allows more than one thread.
+    /// current_worksheets holds the already created worksheet for each chain.
+    /// </summary>
+    void read_worksheets(const std::vector<std::vector<relationship>> &rel_chains,
+        const std::vector<worksheet_impl *> &current_worksheets);
+
+    /// <summary>
+    /// Returns the parts of the given types related to the workbook followed by
+    /// the worksheet parts read on this thread, in the order they're read.
+    /// </summary>
+    std::vector<path> prefetched_parts(const relationship &workbook_rel,
+        const std::vector<relationship_type> &rel_types);
+
+    /// <summary>
+    /// Removes the worksheets which load_options excluded from the workbook
+    /// after the others have been read.
+    /// </summary>
+    void remove_worksheets(const std::vector<worksheet_impl *> &skipped_worksheets);
+
+    /// <summary>
+    /// Removes the relationships of source which target parts excluded by
+    /// load_options from the manifest, so those parts are never opened and
+    /// aren't referred to when the workbook is saved.
+    /// </summary>
+    void unregister_skipped_parts(const path &source);
+
+    /// <summary>
+    /// Returns the range of cells load_options restricts reading to or
+    /// nullptr if every cell should be read.
+    /// </summary>
+    const range_reference *projection() const;
+
+    /// <summary>
+    /// Returns true if load_options excludes parts of the given type.
+    /// </summary>
+    bool skips_part(relationship_type type) const;
+
+    /// <summary>
+    /// Reads the worksheet part at the end of rel_chain into current_worksheet_.
+    /// If detached is true, the part is inflated from a private copy of its
+    /// compressed data and read_worksheet_related_parts is left to the caller.
+    /// This is what the worker threads of read_worksheets use.
+    /// </summary>
+    void read_worksheet_part(const std::vector<relationship> &rel_chain, bool detached);
+
 	// Sheet Relationship Target Parts
 
 	/// <summary>
@@ -387,7 +473,12 @@ private:
 	/// <summary>
 	/// The ZIP file containing the files that make up the OOXML package.
 	/// </summary>
-	std::unique_ptr<izstream> archive_;
+	std::shared_ptr<izstream> archive_;
+
+	/// <summary>
+	/// The options passed to read.
+	/// </summary>
+	load_options options_;
 
 	/// <summary>
 	/// Map of sheet titles to relationship IDs.
@@ -427,6 +518,29 @@ private:
     number_serialiser converter_;
     
     std::vector<defined_name> defined_names_;
+
+    /// <summary>
+    /// External hyperlinks found in the current worksheet. Setting these may
+    /// add shared strings so they are applied by read_worksheet_related_parts.
+    /// </summary>
+    std::vector<std::pair<cell_reference, std::string>> pending_hyperlinks_;
+
+    /// <summary>
+    /// Merged ranges found in the current worksheet. Merging may clear shared
+    /// string values so these are also applied by read_worksheet_related_parts.
+    /// </summary>
+    std::vector<range_reference> pending_merged_cells_;
+
+    /// <summary>
+    /// The number of cells read with each format, by index. Formats belong to
+    /// the workbook, so read_worksheet_related_parts counts these references.
+    /// </summary>
+    std::vector<std::size_t> pending_format_references_;
+
+    /// <summary>
+    /// True if the current worksheet's view is marked as tabSelected.
+    /// </summary>
+    bool tab_selected_ = false;
 };
 
 } // namespace detail
@@ -43,6 +43,7 @@
 #include <detail/serialization/custom_value_traits.hpp>
 #include <detail/serialization/defined_name.hpp>
 #include <detail/serialization/vector_streambuf.hpp>
+#include <detail/serialization/xlsx_consumer.hpp>
 #include <detail/serialization/xlsx_producer.hpp>
 #include <detail/serialization/zstream.hpp>
 
@@ -108,10 +109,10 @@ void xlsx_producer::open(std::ostream &destination)
 
 cell xlsx_producer::add_cell(const cell_reference &ref)
 {
-    current_cell_->column_ = ref.column();
+    current_cell_->column_ = ref.column_index();
     current_cell_->row_ = ref.row();
 
-    return cell(current_cell_);
+    return cell(current_cell_, current_worksheet_);
 }
 
 worksheet xlsx_producer::add_worksheet(const std::string &title)
@@ -126,6 +127,20 @@ void xlsx_producer::populate_archive(bool streaming)
 {
     streaming_ = streaming;
 
+    // Worksheets of a lazily loaded workbook which haven't been accessed yet are
+    // read first since reading them can change the manifest
+    for (auto &ws : source_.d_->worksheets_)
+    {
+        xlsx_consumer::read_deferred_worksheet(ws);
+    }
+
+    // Formats left unreferenced by restyling cells are removed once here
+    // instead of after each change
+    if (source_.d_->stylesheet_.is_set() && source_.d_->stylesheet_.get().garbage)
+    {
+        source_.d_->stylesheet_.get().garbage_collect();
+    }
+
     write_content_types();
 
     const auto root_rels = source_.manifest().relationships(path("/"));
@@ -275,6 +290,24 @@ void xlsx_producer::write_property(const std::string &name, const variant &value
         break;
     }
 
+    case variant::type::r8: {
+        if (custom)
+        {
+            write_attribute("fmtid", "{D5CDD505-2E9C-101B-9397-08002B2CF9AE}");
+            write_attribute("pid", pid);
+            write_start_element(constants::ns("vt"), "r8");
+        }
+
+        write_characters(converter_.serialise(value.get<double>()));
+
+        if (custom)
+        {
+            write_end_element(constants::ns("vt"), "r8");
+        }
+
+        break;
+    }
+
     case variant::type::lpstr: {
         if (custom)
         {
@@ -339,6 +372,10 @@ void xlsx_producer::write_property(const std::string &name, const variant &value
             {
                 write_element(constants::ns("vt"), "i4", vector_element.get<std::int32_t>());
             }
+            else if (vector_element.value_type() == variant::type::r8)
+            {
+                write_element(constants::ns("vt"), "r8", converter_.serialise(vector_element.get<double>()));
+            }
 
             if (is_mixed)
             {
@@ -996,34 +1033,37 @@ void xlsx_producer::write_shared_string_table(const relationship & /*rel*/)
 
     for (const auto ws : source_)
     {
-        auto dimension = ws.calculate_dimension();
-        auto current_cell = dimension.top_left();
+        const auto &cells = ws.d_->cells_;
 
-        while (current_cell.row() <= dimension.bottom_right().row())
+        for (const auto &cell : cells)
         {
-            while (current_cell.column() <= dimension.bottom_right().column())
+            if (cell.type_ == cell_type::shared_string)
             {
-                auto c_iter = ws.d_->cell_map_.find(current_cell);
-                if (c_iter != ws.d_->cell_map_.end() && c_iter->second.type_ == cell_type::shared_string)
-                {
-                    ++string_count;
-                }
-
-                current_cell.column_index(current_cell.column_index() + 1);
+                ++string_count;
             }
-
-            current_cell.row(current_cell.row() + 1);
-            current_cell.column_index(dimension.top_left().column_index());
         }
     }
 
+    const auto &strings = *source_.d_->shared_strings_;
+
     write_attribute("count", string_count);
-    write_attribute("uniqueCount", source_.shared_strings().size());
+    write_attribute("uniqueCount", strings.size());
 
-    for (const auto &text : source_.shared_strings())
+    for (std::size_t index = 0; index < strings.size(); ++index)
     {
         write_start_element(xmlns, "si");
-        write_rich_text(xmlns, text);
+
+        if (strings.is_plain(index))
+        {
+            write_start_element(xmlns, "t");
+            write_characters(strings.plain_text(index), strings.preserve_space(index));
+            write_end_element(xmlns, "t");
+        }
+        else
+        {
+            write_rich_text(xmlns, strings.rich(index));
+        }
+
         write_end_element(xmlns, "si");
     }
 
@@ -1528,8 +1568,10 @@ void xlsx_producer::write_styles(const relationship & /*rel*/)
     write_start_element(xmlns, "cellXfs");
     write_attribute("count", stylesheet.format_impls.size());
 
-    for (auto &current_format_impl : stylesheet.format_impls)
+    for (std::size_t id = 0; id < stylesheet.format_impls.size(); ++id)
     {
+        const auto &current_format_impl = stylesheet.format_impls.at(id);
+
         write_start_element(xmlns, "xf");
 
         if (current_format_impl.number_format_id.is_set())
@@ -2533,55 +2575,67 @@ void xlsx_producer::write_worksheet(const relationship &rel)
     std::vector<cell_reference> cells_with_comments;
 
     write_start_element(xmlns, "sheetData");
+    const auto &cells = ws.d_->cells_;
     auto first_row = ws.lowest_row_or_props();
-    auto last_row = ws.highest_row_or_props();
     auto first_block_column = constants::max_column();
     auto last_block_column = constants::min_column();
+    row_t span_block = 0;
+
+    // only rows with cells or properties are visited, in ascending order
+    auto rows = cells.rows();
 
-    for (auto row = first_row; row <= last_row; ++row)
+    for (const auto &props : ws.d_->row_properties_)
     {
-        bool any_non_null = false;
-        auto first_check_row = row;
-        auto last_check_row = row;
-        auto first_row_in_block = row == first_row || row % 16 == 1;
+        rows.push_back(props.first);
+    }
+
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
 
+    for (auto row : rows)
+    {
         // See note for CT_Row, span attribute about block optimization
-        if (first_row_in_block)
+        // A block starts at the first row and at each row 16n + 1.
+        const auto block_start = std::max(first_row, row - (row - 1) % 16);
+
+        if (block_start != span_block)
         {
+            span_block = block_start;
+
             // reset block column range
             first_block_column = constants::max_column();
             last_block_column = constants::min_column();
 
-            first_check_row = row;
             // round up to the next multiple of 16
-            last_check_row = ((row / 16) + 1) * 16;
-        }
+            const auto last_check_row = ((block_start / 16) + 1) * 16;
 
-        for (auto check_row = first_check_row; check_row <= last_check_row; ++check_row)
-        {
-            for (auto column = dimension.top_left().column(); column <= dimension.bottom_right().column(); ++column)
+            for (auto check_row = block_start; check_row <= last_check_row; ++check_row)
             {
-                auto ref = cell_reference(column, check_row);
-                auto cell = ws.d_->cell_map_.find(ref);
-                if (cell == ws.d_->cell_map_.end())
-                {
-                    continue;
-                }
-                if (cell->second.is_garbage_collectible())
+                auto check_cells = cells.row(check_row);
+
+                if (check_cells == nullptr)
                 {
                     continue;
                 }
 
-                first_block_column = std::min(first_block_column, cell->second.column_);
-                last_block_column = std::max(last_block_column, cell->second.column_);
-
-                if (row == check_row)
+                for (const auto &entry : *check_cells)
                 {
-                    any_non_null = true;
+                    if (entry.cell->is_garbage_collectible())
+                    {
+                        continue;
+                    }
+
+                    first_block_column = std::min(first_block_column, column_t(entry.cell->column_));
+                    last_block_column = std::max(last_block_column, column_t(entry.cell->column_));
                 }
             }
         }
 
+        auto row_cells = cells.row(row);
+        auto any_non_null = row_cells != nullptr
+            && std::any_of(row_cells->begin(), row_cells->end(),
+                [](const detail::cell_entry &entry) { return !entry.cell->is_garbage_collectible(); });
+
         if (!any_non_null && !ws.has_row_properties(row)) continue;
 
         write_start_element(xmlns, "row");
@@ -2628,11 +2682,9 @@ void xlsx_producer::write_worksheet(const relationship &rel)
 
         if (any_non_null)
         {
-            for (auto column = dimension.top_left().column(); column <= dimension.bottom_right().column(); ++column)
+            for (const auto &entry : *row_cells)
             {
-                if (!ws.has_cell(cell_reference(column, row))) continue;
-
-                auto cell = ws.cell(cell_reference(column, row));
+                auto cell = xlnt::cell(entry.cell, ws.d_);
 
                 if (cell.garbage_collectible()) continue;
 
@@ -37,22 +37,67 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
 #include <array>
 #include <cassert>
 #include <cstring>
+#include <deque>
+#include <exception>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <iterator> // for std::back_inserter
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <unordered_set>
 #include <miniz.h>
 
 #include <xlnt/utils/exceptions.hpp>
+#include <detail/serialization/bounded_queue.hpp>
 #include <detail/serialization/vector_streambuf.hpp>
 #include <detail/serialization/zstream.hpp>
 
 namespace {
 
-template <class T>
-T read_int(std::istream &stream)
+/// <summary>
+/// Reads consecutive bytes from a block of memory with the same read() call
+/// as std::istream so the header readers below also work on archives in memory.
+/// </summary>
+class memory_reader
+{
+public:
+    memory_reader(const std::uint8_t *data, std::size_t size)
+        : position_(data), end_(data + size)
+    {
+    }
+
+    void read(char *destination, std::size_t count)
+    {
+        // destination is null for empty extra fields and comments
+        if (count == 0)
+        {
+            return;
+        }
+
+        if (count > static_cast<std::size_t>(end_ - position_))
+        {
+            throw xlnt::exception("unexpected end of zip file");
+        }
+
+        std::memcpy(destination, position_, count);
+        position_ += count;
+    }
+
+    const std::uint8_t *position() const
+    {
+        return position_;
+    }
+
+private:
+    const std::uint8_t *position_;
+    const std::uint8_t *end_;
+};
+
+template <class T, class Source>
+T read_int(Source &stream)
 {
     T value;
     stream.read(reinterpret_cast<char *>(&value), sizeof(T));
@@ -66,7 +111,8 @@ void write_int(std::ostream &stream, T value)
     stream.write(reinterpret_cast<char *>(&value), sizeof(T));
 }
 
-xlnt::detail::zheader read_header(std::istream &istream, const bool global)
+template <class Source>
+xlnt::detail::zheader read_header(Source &istream, const bool global)
 {
     xlnt::detail::zheader header;
 
@@ -171,13 +217,17 @@ namespace detail {
 
 static const std::size_t buffer_size = 512;
 
+// bytes kept in front of the get area of zip_streambuf_decompress for putback
+static const std::size_t put_back_size = 4;
+
 class zip_streambuf_decompress : public std::streambuf
 {
-    std::istream &istream;
+    std::istream *istream;
+    const std::uint8_t *source; // the compressed data when the archive is in memory
 
     z_stream strm;
-    std::array<char, buffer_size> in;
-    std::array<char, buffer_size> out;
+    std::vector<char> in;
+    std::vector<char> out;
     zheader header;
     std::size_t total_read;
     std::size_t total_uncompressed;
@@ -188,11 +238,44 @@ class zip_streambuf_decompress : public std::streambuf
     static const unsigned short UNCOMPRESSED = 0;
 
 public:
-    zip_streambuf_decompress(std::istream &stream, zheader central_header)
-        : istream(stream), header(central_header), total_read(0), total_uncompressed(0), valid(true)
+    /// <summary>
+    /// Inflates the file whose local header is next in stream through buffers of
+    /// inflate_buffer_size bytes, or into a single buffer if its uncompressed size
+    /// is at most contiguous_limit.
+    /// </summary>
+    zip_streambuf_decompress(std::istream &stream, zheader central_header,
+        std::size_t inflate_buffer_size, std::size_t contiguous_limit)
+        : istream(&stream), source(nullptr), header(central_header), total_read(0), total_uncompressed(0), valid(true)
     {
-        in.fill(0);
-        out.fill(0);
+        // skip the header
+        read_header(*istream, false);
+        initialize(central_header, inflate_buffer_size, contiguous_limit);
+    }
+
+    /// <summary>
+    /// Like the above but the file's local header starts at data. The archive in
+    /// memory must contain at least size bytes from there. Files which are stored
+    /// uncompressed are read in place.
+    /// </summary>
+    zip_streambuf_decompress(const std::uint8_t *data, std::size_t size, zheader central_header,
+        std::size_t inflate_buffer_size, std::size_t contiguous_limit)
+        : istream(nullptr), source(nullptr), header(central_header), total_read(0), total_uncompressed(0), valid(true)
+    {
+        memory_reader reader(data, size);
+        read_header(reader, false);
+        source = reader.position();
+
+        if (central_header.compressed_size > size - static_cast<std::size_t>(source - data))
+        {
+            throw xlnt::exception("unexpected end of zip file");
+        }
+
+        initialize(central_header, inflate_buffer_size, contiguous_limit);
+    }
+
+    void initialize(const zheader &central_header, std::size_t inflate_buffer_size, std::size_t contiguous_limit)
+    {
+        header = central_header;
 
         strm.zalloc = nullptr;
         strm.zfree = nullptr;
@@ -200,12 +283,9 @@ public:
         strm.avail_in = 0;
         strm.next_in = nullptr;
 
-        setg(in.data(), in.data(), in.data());
+        setg(nullptr, nullptr, nullptr);
         setp(nullptr, nullptr);
 
-        // skip the header
-        read_header(istream, false);
-
         if (header.compression_type == DEFLATE)
         {
             compressed_data = true;
@@ -220,6 +300,26 @@ public:
             throw xlnt::exception("unsupported compression type, should be DEFLATE or uncompressed");
         }
 
+        if (!compressed_data && source != nullptr)
+        {
+            // the whole file is already in memory so it becomes the get area
+            auto begin = reinterpret_cast<char *>(const_cast<std::uint8_t *>(source));
+            total_read = std::min(header.compressed_size, header.uncompressed_size);
+            setg(begin, begin, begin + total_read);
+
+            return;
+        }
+
+        // small files are inflated all at once so they can be read as a single block
+        const auto contiguous = compressed_data && header.uncompressed_size > 0
+            && header.uncompressed_size <= contiguous_limit;
+        out.resize(put_back_size + (contiguous ? header.uncompressed_size : inflate_buffer_size));
+
+        if (compressed_data && source == nullptr)
+        {
+            in.resize(inflate_buffer_size);
+        }
+
         // initialize the inflate
         if (compressed_data && valid)
         {
@@ -233,8 +333,6 @@ public:
                 throw xlnt::exception("couldn't inflate ZIP, possibly corrupted");
             }
         }
-
-        header = central_header;
     }
 
     ~zip_streambuf_decompress() override
@@ -249,19 +347,28 @@ public:
     {
         if (!valid) return -1;
 
+        const auto capacity = out.size() - put_back_size;
+
         if (compressed_data)
         {
-            strm.avail_out = buffer_size - 4;
-            strm.next_out = reinterpret_cast<Bytef *>(out.data() + 4);
+            strm.avail_out = static_cast<unsigned int>(capacity);
+            strm.next_out = reinterpret_cast<Bytef *>(out.data() + put_back_size);
 
             while (strm.avail_out != 0)
             {
-                if (strm.avail_in == 0)
+                if (strm.avail_in == 0 && source != nullptr)
+                {
+                    // the whole of the compressed data is already in memory
+                    strm.avail_in = static_cast<unsigned int>(header.compressed_size - total_read);
+                    strm.next_in = const_cast<Bytef *>(source + total_read);
+                    total_read = header.compressed_size;
+                }
+                else if (strm.avail_in == 0)
                 {
                     // buffer empty, read some more from file
-                    istream.read(in.data(),
-                        static_cast<std::streamsize>(std::min(buffer_size, header.compressed_size - total_read)));
-                    strm.avail_in = static_cast<unsigned int>(istream.gcount());
+                    istream->read(in.data(),
+                        static_cast<std::streamsize>(std::min(in.size(), header.compressed_size - total_read)));
+                    strm.avail_in = static_cast<unsigned int>(istream->gcount());
                     total_read += strm.avail_in;
                     strm.next_in = reinterpret_cast<Bytef *>(in.data());
                 }
@@ -273,18 +380,21 @@ public:
                     throw xlnt::exception("couldn't inflate ZIP, possibly corrupted");
                 }
 
+                // no progress is possible once the input is exhausted, the data is truncated
+                if (ret == Z_BUF_ERROR && strm.avail_in == 0) break;
+
                 if (ret == Z_STREAM_END) break;
             }
 
-            auto unzip_count = buffer_size - strm.avail_out - 4;
+            auto unzip_count = capacity - strm.avail_out;
             total_uncompressed += unzip_count;
             return static_cast<int>(unzip_count);
         }
 
         // uncompressed, so just read
-        istream.read(out.data() + 4,
-            static_cast<std::streamsize>(std::min(buffer_size - 4, header.uncompressed_size - total_read)));
-        auto count = istream.gcount();
+        istream->read(out.data() + put_back_size,
+            static_cast<std::streamsize>(std::min(capacity, header.uncompressed_size - total_read)));
+        auto count = istream->gcount();
         total_read += static_cast<std::size_t>(count);
         return static_cast<int>(count);
     }
@@ -293,12 +403,13 @@ public:
     {
         if (gptr() && (gptr() < egptr()))
             return traits_type::to_int_type(*gptr()); // if we already have data just use it
+        if (out.empty()) return EOF; // the get area was the whole file
         auto put_back_count = gptr() - eback();
-        if (put_back_count > 4) put_back_count = 4;
-        std::memmove(
-            out.data() + (4 - put_back_count), gptr() - put_back_count, static_cast<std::size_t>(put_back_count));
+        if (put_back_count > static_cast<std::ptrdiff_t>(put_back_size)) put_back_count = put_back_size;
+        std::memmove(out.data() + (put_back_size - static_cast<std::size_t>(put_back_count)),
+            gptr() - put_back_count, static_cast<std::size_t>(put_back_count));
         int num = process();
-        setg(out.data() + 4 - put_back_count, out.data() + 4, out.data() + 4 + num);
+        setg(out.data() + put_back_size - put_back_count, out.data() + put_back_size, out.data() + put_back_size + num);
         if (num <= 0) return EOF;
         return traits_type::to_int_type(*gptr());
     }
@@ -311,6 +422,112 @@ int zip_streambuf_decompress::overflow(int)
     throw xlnt::exception("writing to read-only buffer");
 }
 
+/// <summary>
+/// Owns a copy of the local header and compressed data of one file so that
+/// zip_streambuf_decompress can be constructed over it before the decompressor
+/// base is initialized (base-from-member).
+/// </summary>
+struct detached_zip_source
+{
+    explicit detached_zip_source(std::vector<std::uint8_t> &&data)
+        : bytes(std::move(data))
+    {
+    }
+
+    std::vector<std::uint8_t> bytes;
+};
+
+class detached_zip_streambuf_decompress : private detached_zip_source, public zip_streambuf_decompress
+{
+public:
+    detached_zip_streambuf_decompress(std::vector<std::uint8_t> &&data, zheader central_header,
+        std::size_t inflate_buffer_size, std::size_t contiguous_limit)
+        : detached_zip_source(std::move(data)),
+          zip_streambuf_decompress(bytes.data(), bytes.size(), central_header, inflate_buffer_size, contiguous_limit)
+    {
+    }
+};
+
+/// <summary>
+/// The inflated contents of one file as they're handed from the prefetching
+/// thread inflating it to the streambuf reading it. The buffers cycle between
+/// chunks and spare so no more than capacity + 2 are allocated per file.
+/// </summary>
+struct prefetched_file
+{
+    prefetched_file()
+        : chunks(prefetched_file::capacity),
+          spare(prefetched_file::capacity + 2)
+    {
+    }
+
+    /// <summary>
+    /// The number of buffers inflated ahead of the reader.
+    /// </summary>
+    static const std::size_t capacity = 4;
+
+    bounded_queue<std::vector<char>> chunks;
+
+    /// <summary>
+    /// Buffers the reader is done with.
+    /// </summary>
+    bounded_queue<std::vector<char>> spare;
+
+    /// <summary>
+    /// Set before chunks is closed if inflating the file failed.
+    /// </summary>
+    std::exception_ptr error;
+};
+
+class prefetched_streambuf : public std::streambuf
+{
+public:
+    explicit prefetched_streambuf(std::shared_ptr<prefetched_file> file)
+        : file_(std::move(file))
+    {
+    }
+
+    ~prefetched_streambuf() override
+    {
+        // stops the prefetching thread if the file isn't read to the end
+        file_->chunks.close();
+    }
+
+private:
+    int underflow() override
+    {
+        if (gptr() != nullptr && gptr() < egptr())
+        {
+            return traits_type::to_int_type(*gptr());
+        }
+
+        if (chunk_.capacity() > 0)
+        {
+            file_->spare.push(std::move(chunk_));
+            chunk_ = std::vector<char>();
+        }
+
+        if (!file_->chunks.pop(chunk_))
+        {
+            setg(nullptr, nullptr, nullptr);
+
+            if (file_->error)
+            {
+                std::rethrow_exception(file_->error);
+            }
+
+            return traits_type::eof();
+        }
+
+        setg(chunk_.data(), chunk_.data(), chunk_.data() + chunk_.size());
+
+        return traits_type::to_int_type(*gptr());
+    }
+
+    std::shared_ptr<prefetched_file> file_;
+    std::vector<char> chunk_;
+};
+
 class zip_streambuf_compress : public std::streambuf
 {
     std::ostream &ostream; // owned when header==0 (when not part of zip file)
@@ -486,8 +703,41 @@ std::unique_ptr<std::streambuf> ozstream::open(const path &filename)
     return std::unique_ptr<zip_streambuf_compress>(buffer);
 }
 
+struct izstream::prefetch_state
+{
+    std::mutex mutex;
+
+    /// <summary>
+    /// The files to prefetch in order, those before next have been started or opened.
+    /// </summary>
+    std::vector<std::string> files;
+    std::size_t next = 0;
+
+    /// <summary>
+    /// Files given to a thread which it hasn't started on yet, these are taken
+    /// before the next file in files.
+    /// </summary>
+    std::deque<std::pair<std::string, std::shared_ptr<prefetched_file>>> assigned;
+
+    /// <summary>
+    /// Files which were opened before a thread started on them.
+    /// </summary>
+    std::unordered_set<std::string> opened;
+
+    /// <summary>
+    /// Files a thread has been given which haven't been opened yet.
+    /// </summary>
+    std::unordered_map<std::string, std::shared_ptr<prefetched_file>> started;
+
+    std::vector<std::thread> threads;
+};
+
 izstream::izstream(std::istream &stream)
-    : source_stream_(stream)
+    : source_stream_(&stream),
+      source_data_(nullptr),
+      source_size_(0),
+      inflate_buffer_size_(default_inflate_buffer_size),
+      contiguous_inflate_limit_(default_contiguous_inflate_limit)
 {
     if (!stream)
     {
@@ -497,16 +747,222 @@ izstream::izstream(std::istream &stream)
     read_central_header();
 }
 
+izstream::izstream(const std::uint8_t *data, std::size_t size)
+    : source_stream_(nullptr),
+      source_data_(data),
+      source_size_(size),
+      inflate_buffer_size_(default_inflate_buffer_size),
+      contiguous_inflate_limit_(default_contiguous_inflate_limit)
+{
+    read_central_header();
+}
+
+void izstream::inflate_buffer_size(std::size_t size)
+{
+    inflate_buffer_size_ = std::max(size, std::size_t(1));
+}
+
+void izstream::contiguous_inflate_limit(std::size_t size)
+{
+    contiguous_inflate_limit_ = size;
+}
+
 izstream::~izstream()
 {
+    stop_prefetch();
+}
+
+void izstream::prefetch(const std::vector<path> &files, std::size_t threads)
+{
+    stop_prefetch();
+
+    std::unique_ptr<prefetch_state> state(new prefetch_state);
+
+    for (const auto &file : files)
+    {
+        if (has_file(file))
+        {
+            state->files.push_back(file.string());
+        }
+    }
+
+    threads = std::min(threads, state->files.size());
+
+    if (threads == 0)
+    {
+        return;
+    }
+
+    // the first files are given out here so they're never opened before a thread has started on them
+    for (; state->next < threads; ++state->next)
+    {
+        auto file = std::make_shared<prefetched_file>();
+        state->started[state->files[state->next]] = file;
+        state->assigned.emplace_back(state->files[state->next], file);
+    }
+
+    prefetch_ = std::move(state);
+
+    for (std::size_t i = 0; i < threads; ++i)
+    {
+        prefetch_->threads.emplace_back([this]() { prefetch_files(); });
+    }
+}
+
+void izstream::stop_prefetch()
+{
+    if (!prefetch_)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(prefetch_->mutex);
+        prefetch_->next = prefetch_->files.size();
+
+        for (auto &file : prefetch_->assigned)
+        {
+            file.second->chunks.close();
+        }
+
+        for (auto &file : prefetch_->started)
+        {
+            file.second->chunks.close();
+        }
+
+        prefetch_->assigned.clear();
+    }
+
+    for (auto &thread : prefetch_->threads)
+    {
+        thread.join();
+    }
+
+    prefetch_.reset();
+}
+
+void izstream::prefetch_files()
+{
+    while (true)
+    {
+        std::string filename;
+        std::shared_ptr<prefetched_file> file;
+
+        {
+            std::lock_guard<std::mutex> lock(prefetch_->mutex);
+
+            if (!prefetch_->assigned.empty())
+            {
+                filename = prefetch_->assigned.front().first;
+                file = prefetch_->assigned.front().second;
+                prefetch_->assigned.pop_front();
+            }
+            else
+            {
+                while (prefetch_->next < prefetch_->files.size()
+                    && prefetch_->opened.count(prefetch_->files[prefetch_->next]) != 0)
+                {
+                    ++prefetch_->next;
+                }
+
+                if (prefetch_->next == prefetch_->files.size())
+                {
+                    return;
+                }
+
+                filename = prefetch_->files[prefetch_->next++];
+                file = std::make_shared<prefetched_file>();
+                prefetch_->started[filename] = file;
+            }
+        }
+
+        try
+        {
+            auto buffer = inflate_detached(path(filename));
+
+            while (true)
+            {
+                std::vector<char> chunk;
+
+                if (!file->spare.try_pop(chunk))
+                {
+                    chunk.reserve(inflate_buffer_size_);
+                }
+
+                chunk.resize(inflate_buffer_size_);
+                auto count = buffer->sgetn(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+
+                if (count <= 0)
+                {
+                    break;
+                }
+
+                chunk.resize(static_cast<std::size_t>(count));
+
+                // false once the reader or stop_prefetch() has closed the queue
+                if (!file->chunks.push(std::move(chunk)))
+                {
+                    break;
+                }
+            }
+        }
+        catch (...)
+        {
+            file->error = std::current_exception();
+        }
+
+        file->chunks.close();
+    }
+}
+
+std::unique_ptr<std::streambuf> izstream::take_prefetched(const path &filename) const
+{
+    std::lock_guard<std::mutex> lock(prefetch_->mutex);
+    auto started = prefetch_->started.find(filename.string());
+
+    if (started != prefetch_->started.end())
+    {
+        std::unique_ptr<std::streambuf> buffer(new prefetched_streambuf(started->second));
+        prefetch_->started.erase(started);
+
+        return buffer;
+    }
+
+    prefetch_->opened.insert(filename.string());
+
+    const auto first_pending = prefetch_->files.begin() + static_cast<std::ptrdiff_t>(prefetch_->next);
+
+    // Every thread is busy with a file which has already been opened, so one
+    // of them can take this file next without waiting on the caller. Otherwise
+    // the caller could wait on a thread which waits for the caller to read
+    // another file.
+    if (!prefetch_->started.empty()
+        || std::find(first_pending, prefetch_->files.end(), filename.string()) == prefetch_->files.end())
+    {
+        return nullptr;
+    }
+
+    auto file = std::make_shared<prefetched_file>();
+    prefetch_->assigned.emplace_back(filename.string(), file);
+
+    return std::unique_ptr<std::streambuf>(new prefetched_streambuf(file));
 }
 
 bool izstream::read_central_header()
 {
     // Find the header
     // NOTE: this assumes the zip file header is the last thing written to file...
-    source_stream_.seekg(0, std::ios_base::end);
-    auto end_position = source_stream_.tellg();
+    std::streamoff end_position = 0;
+
+    if (source_data_ != nullptr)
+    {
+        end_position = static_cast<std::streamoff>(source_size_);
+    }
+    else
+    {
+        source_stream_->seekg(0, std::ios_base::end);
+        end_position = source_stream_->tellg();
+    }
 
     auto max_comment_size = std::uint32_t(0xffff); // max size of header
     auto read_size_before_comment = std::uint32_t(22);
@@ -518,20 +974,30 @@ bool izstream::read_central_header()
         read_start = end_position;
     }
 
-    source_stream_.seekg(end_position - read_start);
-    std::vector<std::uint8_t> buf(static_cast<std::size_t>(read_start), '\0');
-
     if (read_start <= 0)
     {
         throw xlnt::exception("file is empty");
     }
 
-    source_stream_.read(reinterpret_cast<char *>(buf.data()), read_start);
+    std::vector<std::uint8_t> tail;
+    const std::uint8_t *buf = nullptr;
 
-    if (buf[0] == 0xd0 && buf[1] == 0xcf && buf[2] == 0x11 && buf[3] == 0xe0
+    if (source_data_ != nullptr)
+    {
+        buf = source_data_ + (end_position - read_start);
+    }
+    else
+    {
+        source_stream_->seekg(end_position - read_start);
+        tail.resize(static_cast<std::size_t>(read_start), '\0');
+        source_stream_->read(reinterpret_cast<char *>(tail.data()), read_start);
+        buf = tail.data();
+    }
+
+    if (read_start >= 8 && buf[0] == 0xd0 && buf[1] == 0xcf && buf[2] == 0x11 && buf[3] == 0xe0
         && buf[4] == 0xa1 && buf[5] == 0xb1 && buf[6] == 0x1a && buf[7] == 0xe1)
     {
-        throw xlnt::exception("encrypted xlsx, password required");
+        throw encrypted_archive();
     }
 
     auto found_header = false;
@@ -555,35 +1021,53 @@ bool izstream::read_central_header()
         throw xlnt::exception("failed to find zip header");
     }
 
-    // seek to end of central header and read
-    source_stream_.seekg(end_position - (read_start - header_index));
+    // read the end of central directory record which was read along with the comment
+    memory_reader end_of_central(buf + header_index, static_cast<std::size_t>(read_start - header_index));
 
-    /*auto word = */ read_int<std::uint32_t>(source_stream_);
-    auto disk_number1 = read_int<std::uint16_t>(source_stream_);
-    auto disk_number2 = read_int<std::uint16_t>(source_stream_);
+    /*auto word = */ read_int<std::uint32_t>(end_of_central);
+    auto disk_number1 = read_int<std::uint16_t>(end_of_central);
+    auto disk_number2 = read_int<std::uint16_t>(end_of_central);
 
     if (disk_number1 != disk_number2 || disk_number1 != 0)
     {
         throw xlnt::exception("multiple disk zip files are not supported");
     }
 
-    auto num_files = read_int<std::uint16_t>(source_stream_); // one entry in center in this disk
-    auto num_files_this_disk = read_int<std::uint16_t>(source_stream_); // one entry in center
+    auto num_files = read_int<std::uint16_t>(end_of_central); // one entry in center in this disk
+    auto num_files_this_disk = read_int<std::uint16_t>(end_of_central); // one entry in center
 
     if (num_files != num_files_this_disk)
     {
         throw xlnt::exception("multi disk zip files are not supported");
     }
 
-    /*auto size_of_header = */ read_int<std::uint32_t>(source_stream_); // size of header
-    auto header_offset = read_int<std::uint32_t>(source_stream_); // offset to header
+    /*auto size_of_header = */ read_int<std::uint32_t>(end_of_central); // size of header
+    auto header_offset = read_int<std::uint32_t>(end_of_central); // offset to header
 
     // go to header and read all file headers
-    source_stream_.seekg(header_offset);
+    if (source_data_ != nullptr)
+    {
+        if (header_offset > source_size_)
+        {
+            throw xlnt::exception("unexpected end of zip file");
+        }
+
+        memory_reader directory(source_data_ + header_offset, source_size_ - header_offset);
+
+        for (std::uint16_t i = 0; i < num_files; ++i)
+        {
+            auto header = read_header(directory, true);
+            file_headers_[header.filename] = header;
+        }
+
+        return true;
+    }
+
+    source_stream_->seekg(header_offset);
 
     for (std::uint16_t i = 0; i < num_files; ++i)
     {
-        auto header = read_header(source_stream_, true);
+        auto header = read_header(*source_stream_, true);
         file_headers_[header.filename] = header;
     }
 
@@ -597,13 +1081,89 @@ std::unique_ptr<std::streambuf> izstream::open(const path &filename) const
         throw xlnt::exception("file not found");
     }
 
+    if (prefetch_)
+    {
+        auto prefetched = take_prefetched(filename);
+
+        // the prefetching threads may be reading from the source stream too
+        return prefetched ? std::move(prefetched) : inflate_detached(filename);
+    }
+
+    if (source_data_ != nullptr)
+    {
+        return inflate_detached(filename);
+    }
+
     auto header = file_headers_.at(filename.string());
-    source_stream_.seekg(header.header_offset);
-    auto buffer = new zip_streambuf_decompress(source_stream_, header);
+
+    source_stream_->seekg(header.header_offset);
+    auto buffer = new zip_streambuf_decompress(*source_stream_, header, inflate_buffer_size_, contiguous_inflate_limit_);
 
     return std::unique_ptr<zip_streambuf_decompress>(buffer);
 }
 
+std::unique_ptr<std::streambuf> izstream::open_detached(const path &filename) const
+{
+    if (!has_file(filename))
+    {
+        throw xlnt::exception("file not found");
+    }
+
+    if (prefetch_)
+    {
+        auto prefetched = take_prefetched(filename);
+
+        if (prefetched)
+        {
+            return prefetched;
+        }
+    }
+
+    return inflate_detached(filename);
+}
+
+std::unique_ptr<std::streambuf> izstream::inflate_detached(const path &filename) const
+{
+    if (!has_file(filename))
+    {
+        throw xlnt::exception("file not found");
+    }
+
+    const auto &header = file_headers_.at(filename.string());
+
+    // nothing is shared between files read straight from memory
+    if (source_data_ != nullptr)
+    {
+        if (header.header_offset > source_size_)
+        {
+            throw xlnt::exception("unexpected end of zip file");
+        }
+
+        return std::unique_ptr<std::streambuf>(new zip_streambuf_decompress(
+            source_data_ + header.header_offset, source_size_ - header.header_offset, header,
+            inflate_buffer_size_, contiguous_inflate_limit_));
+    }
+
+    std::vector<std::uint8_t> bytes;
+
+    {
+        std::lock_guard<std::mutex> lock(source_mutex_);
+
+        // the local header has variable length so read it once to find where the data starts
+        source_stream_->seekg(header.header_offset);
+        read_header(*source_stream_, false);
+        auto data_offset = static_cast<std::size_t>(source_stream_->tellg()) - header.header_offset;
+
+        bytes.resize(data_offset + header.compressed_size);
+        source_stream_->seekg(header.header_offset);
+        source_stream_->read(reinterpret_cast<char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        bytes.resize(static_cast<std::size_t>(source_stream_->gcount()));
+    }
+
+    return std::unique_ptr<std::streambuf>(new detached_zip_streambuf_decompress(
+        std::move(bytes), header, inflate_buffer_size_, contiguous_inflate_limit_));
+}
+
 std::string izstream::read(const path &filename) const
 {
     auto buffer = open(filename);
@@ -37,10 +37,12 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
 
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 
 #include <xlnt/xlnt_config.hpp>
+#include <xlnt/utils/exceptions.hpp>
 #include <xlnt/utils/path.hpp>
 
 //TODO: don't export these classes (some tests are using them for now)
@@ -48,6 +50,19 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
 namespace xlnt {
 namespace detail {
 
+/// <summary>
+/// Thrown by izstream if the file is an encrypted package, i.e. an OLE compound
+/// document holding the encrypted archive, rather than a ZIP archive.
+/// </summary>
+class XLNT_API encrypted_archive : public xlnt::exception
+{
+public:
+    encrypted_archive()
+        : xlnt::exception("encrypted xlsx, password required")
+    {
+    }
+};
+
 /// <summary>
 /// A structure representing the header that occurs before each compressed file in a ZIP
 /// archive and again at the end of the file with more information.
@@ -95,6 +110,17 @@ private:
     std::ostream &destination_stream_;
 };
 
+/// <summary>
+/// The default size of the buffers files are inflated through.
+/// </summary>
+const std::size_t default_inflate_buffer_size = 256 * 1024;
+
+/// <summary>
+/// Files of up to this many bytes when uncompressed are by default inflated
+/// into a single buffer rather than through buffers of the above size.
+/// </summary>
+const std::size_t default_contiguous_inflate_limit = 4 * 1024 * 1024;
+
 /// <summary>
 /// Reads an archive containing a number of files from an istream and allows them
 /// to be decompressed into an istream.
@@ -107,16 +133,59 @@ public:
     /// </summary>
     izstream(std::istream &stream);
 
+    /// <summary>
+    /// Construct a new zip_file_reader which reads a ZIP archive of size bytes held
+    /// in memory at data, e.g. a mapped file. Files are inflated straight from data
+    /// so it must remain valid for the lifetime of this object and the streambufs
+    /// it returns.
+    /// </summary>
+    izstream(const std::uint8_t *data, std::size_t size);
+
     /// <summary>
     /// Destructor.
     /// </summary>
     virtual ~izstream();
 
+    /// <summary>
+    /// Sets the size in bytes of the buffers the streambufs returned by open()
+    /// inflate files through.
+    /// </summary>
+    void inflate_buffer_size(std::size_t size);
+
+    /// <summary>
+    /// Files whose uncompressed size according to the central directory is at
+    /// most size bytes are inflated into a single buffer on the first read, 0
+    /// disables this.
+    /// </summary>
+    void contiguous_inflate_limit(std::size_t size);
+
+    /// <summary>
+    /// Starts inflating files, in the order they're given, on the given number of
+    /// background threads. Each file is inflated into a few buffers of inflate_buffer_size
+    /// bytes ahead of the streambuf open() later returns for it, which reads the
+    /// buffers as they fill. Files opened before a thread has started on them
+    /// are inflated by the caller as usual. Any previous prefetch is stopped.
+    /// </summary>
+    void prefetch(const std::vector<path> &files, std::size_t threads);
+
+    /// <summary>
+    /// Stops inflating files which haven't been opened yet and waits for the
+    /// prefetching threads to finish.
+    /// </summary>
+    void stop_prefetch();
+
     /// <summary>
     ///
     /// </summary>
     std::unique_ptr<std::streambuf> open(const path &file) const;
 
+    /// <summary>
+    /// Like open(), but the compressed bytes of the file are copied out of the
+    /// source stream up front so the returned streambuf doesn't depend on the
+    /// stream's read position. This may be called from several threads at once.
+    /// </summary>
+    std::unique_ptr<std::streambuf> open_detached(const path &file) const;
+
     /// <summary>
     ///
     /// </summary>
@@ -133,20 +202,68 @@ public:
     bool has_file(const path &filename) const;
 
 private:
+    struct prefetch_state;
+
     /// <summary>
     ///
     /// </summary>
     bool read_central_header();
 
+    /// <summary>
+    /// Returns a streambuf over the prefetched buffers of file or nullptr if no
+    /// thread has started on it, in which case it won't be prefetched anymore.
+    /// </summary>
+    std::unique_ptr<std::streambuf> take_prefetched(const path &file) const;
+
+    /// <summary>
+    /// The body of a prefetching thread.
+    /// </summary>
+    void prefetch_files();
+
+    /// <summary>
+    /// open_detached() without checking for a prefetched copy.
+    /// </summary>
+    std::unique_ptr<std::streambuf> inflate_detached(const path &file) const;
+
     /// <summary>
     ///
     /// </summary>
     std::unordered_map<std::string, zheader> file_headers_;
 
     /// <summary>
-    ///
+    /// The stream the archive is read from or nullptr if it's in memory.
+    /// </summary>
+    std::istream *source_stream_;
+
+    /// <summary>
+    /// The archive if it's in memory, otherwise nullptr.
+    /// </summary>
+    const std::uint8_t *source_data_;
+
+    /// <summary>
+    /// The size of the archive at source_data_.
+    /// </summary>
+    std::size_t source_size_;
+
+    /// <summary>
+    /// The size of the buffers files are inflated through.
+    /// </summary>
+    std::size_t inflate_buffer_size_;
+
+    /// <summary>
+    /// Files up to this size are inflated in one go.
+    /// </summary>
+    std::size_t contiguous_inflate_limit_;
+
+    /// <summary>
+    /// Serializes access to source_stream_ from open_detached().
+    /// </summary>
+    mutable std::mutex source_mutex_;
+
+    /// <summary>
+    /// The files being inflated ahead of open() or nullptr if prefetch() isn't in effect.
     /// </summary>
-    std::istream &source_stream_;
+    std::unique_ptr<prefetch_state> prefetch_;
 };
 
 } // namespace detail
@@ -23,6 +23,7 @@
 // @author: see AUTHORS file
 
 #include <xlnt/styles/alignment.hpp>
+#include <detail/hash_combine.hpp>
 
 namespace xlnt {
 
@@ -167,3 +168,22 @@ bool alignment::operator!=(const alignment &other) const
 }
 
 } // namespace xlnt
+
+namespace std {
+
+size_t hash<xlnt::alignment>::operator()(const xlnt::alignment &a) const
+{
+    using xlnt::detail::hash_combine;
+
+    size_t seed = 0;
+    hash_combine(seed, a.horizontal());
+    hash_combine(seed, a.vertical());
+    hash_combine(seed, a.indent());
+    hash_combine(seed, a.rotation());
+    hash_combine(seed, static_cast<size_t>(a.wrap()));
+    hash_combine(seed, static_cast<size_t>(a.shrink()));
+
+    return seed;
+}
+
+} // namespace std
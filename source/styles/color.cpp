@@ -27,6 +27,7 @@
 
 #include <xlnt/styles/color.hpp>
 #include <xlnt/utils/exceptions.hpp>
+#include <detail/hash_combine.hpp>
 
 namespace {
 
@@ -325,3 +326,39 @@ bool color::operator!=(const color &other) const
 }
 
 } // namespace xlnt
+
+namespace std {
+
+size_t hash<xlnt::color>::operator()(const xlnt::color &c) const
+{
+    using xlnt::detail::hash_combine;
+
+    auto seed = static_cast<size_t>(c.type());
+    hash_combine(seed, static_cast<size_t>(c.auto_()));
+    hash_combine(seed, static_cast<size_t>(c.has_tint()));
+
+    if (c.has_tint())
+    {
+        hash_combine(seed, c.tint());
+    }
+
+    switch (c.type())
+    {
+    case xlnt::color_type::indexed:
+        hash_combine(seed, c.indexed().index());
+        break;
+    case xlnt::color_type::theme:
+        hash_combine(seed, c.theme().index());
+        break;
+    case xlnt::color_type::rgb:
+        for (auto component : c.rgb().rgba())
+        {
+            hash_combine(seed, static_cast<size_t>(component));
+        }
+        break;
+    }
+
+    return seed;
+}
+
+} // namespace std
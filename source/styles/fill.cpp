@@ -25,6 +25,7 @@
 #include <cmath> // for std::fabs
 
 #include <xlnt/styles/fill.hpp>
+#include <detail/hash_combine.hpp>
 
 namespace xlnt {
 
@@ -320,3 +321,33 @@ bool fill::operator!=(const fill &other) const
 }
 
 } // namespace xlnt
+
+namespace std {
+
+size_t hash<xlnt::fill>::operator()(const xlnt::fill &f) const
+{
+    using xlnt::detail::hash_combine;
+
+    auto seed = static_cast<size_t>(f.type());
+
+    if (f.type() == xlnt::fill_type::gradient)
+    {
+        const auto gradient = f.gradient_fill();
+        hash_combine(seed, static_cast<size_t>(gradient.type()));
+        hash_combine(seed, gradient.degree());
+    }
+    else
+    {
+        const auto pattern = f.pattern_fill();
+        hash_combine(seed, static_cast<size_t>(pattern.type()));
+
+        if (pattern.foreground().is_set())
+        {
+            hash_combine(seed, hash<xlnt::color>()(pattern.foreground().get()));
+        }
+    }
+
+    return seed;
+}
+
+} // namespace std
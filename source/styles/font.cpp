@@ -25,6 +25,7 @@
 #include <cmath>
 
 #include <xlnt/styles/font.hpp>
+#include <detail/hash_combine.hpp>
 
 namespace {
 const std::string &Default_Name()
@@ -271,3 +272,28 @@ bool font::operator==(const font &other) const
 }
 
 } // namespace xlnt
+
+namespace std {
+
+size_t hash<xlnt::font>::operator()(const xlnt::font &f) const
+{
+    using xlnt::detail::hash_combine;
+
+    size_t seed = 0;
+    hash_combine(seed, f.has_name() ? hash<string>()(f.name()) : size_t(0));
+    hash_combine(seed, static_cast<size_t>(f.has_size()));
+
+    if (f.has_size())
+    {
+        hash_combine(seed, f.size());
+    }
+
+    hash_combine(seed, static_cast<size_t>(f.bold()));
+    hash_combine(seed, static_cast<size_t>(f.italic()));
+    hash_combine(seed, static_cast<size_t>(f.underline()));
+    hash_combine(seed, f.has_color() ? hash<xlnt::color>()(f.color()) : size_t(0));
+
+    return seed;
+}
+
+} // namespace std
@@ -38,7 +38,7 @@ format::format(detail::format_impl *d)
 
 void format::clear_style()
 {
-    d_->style.clear();
+    d_->parent->format_impls.modify(*d_, [](detail::format_impl &impl) { impl.style.clear(); });
 }
 
 format format::style(const xlnt::style &new_style)
@@ -49,7 +49,7 @@ format format::style(const xlnt::style &new_style)
 
 format format::style(const std::string &new_style)
 {
-    d_->style = new_style;
+    d_->parent->format_impls.modify(*d_, [&](detail::format_impl &impl) { impl.style = new_style; });
     return format(d_);
 }
 
@@ -222,7 +222,7 @@ bool format::pivot_button() const
 
 void format::pivot_button(bool show)
 {
-    d_->pivot_button_ = show;
+    d_->parent->format_impls.modify(*d_, [=](detail::format_impl &impl) { impl.pivot_button_ = show; });
 }
 
 bool format::quote_prefix() const
@@ -232,7 +232,7 @@ bool format::quote_prefix() const
 
 void format::quote_prefix(bool quote)
 {
-    d_->quote_prefix_ = quote;
+    d_->parent->format_impls.modify(*d_, [=](detail::format_impl &impl) { impl.quote_prefix_ = quote; });
 }
 
 } // namespace xlnt
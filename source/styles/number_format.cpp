@@ -30,10 +30,19 @@
 #include <xlnt/styles/number_format.hpp>
 #include <xlnt/utils/datetime.hpp>
 #include <xlnt/utils/exceptions.hpp>
+#include <detail/number_format/number_format_cache.hpp>
 #include <detail/number_format/number_formatter.hpp>
 
 namespace {
 
+// Formats compiled for the number_format methods, which have no stylesheet
+// at hand to keep them.
+xlnt::detail::number_format_cache &compiled_formats()
+{
+    static xlnt::detail::number_format_cache cache;
+    return cache;
+}
+
 const std::unordered_map<std::size_t, xlnt::number_format> &builtin_formats()
 {
     static std::unordered_map<std::size_t, xlnt::number_format> formats;
@@ -312,9 +321,8 @@ std::size_t number_format::id() const
 
 bool number_format::is_date_format() const
 {
-    detail::number_format_parser p(format_string_);
-    p.parse();
-    auto parsed = p.result();
+    const auto compiled = compiled_formats().get(*this);
+    const auto &parsed = compiled->sections();
 
     bool any_datetime = false;
     bool any_timedelta = false;
@@ -337,12 +345,12 @@ bool number_format::is_date_format() const
 
 std::string number_format::format(const std::string &text) const
 {
-    return detail::number_formatter(format_string_, calendar::windows_1900).format_text(text);
+    return detail::number_formatter(compiled_formats().get(*this), calendar::windows_1900).format_text(text);
 }
 
 std::string number_format::format(double number, calendar base_date) const
 {
-    return detail::number_formatter(format_string_, base_date).format_number(number);
+    return detail::number_formatter(compiled_formats().get(*this), base_date).format_number(number);
 }
 
 bool number_format::operator==(const number_format &other) const
@@ -356,3 +364,12 @@ bool number_format::operator!=(const number_format &other) const
 }
 
 } // namespace xlnt
+
+namespace std {
+
+size_t hash<xlnt::number_format>::operator()(const xlnt::number_format &f) const
+{
+    return hash<string>()(f.format_string());
+}
+
+} // namespace std
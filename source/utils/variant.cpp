@@ -48,6 +48,12 @@ variant::variant(int32_t value)
 {
 }
 
+variant::variant(double value)
+    : type_(type::r8),
+      r8_value_(value)
+{
+}
+
 variant::variant(bool value)
     : type_(type::boolean),
       i4_value_(value ? 1 : 0)
@@ -136,6 +142,8 @@ bool variant::operator==(const variant &rhs) const
     case type::i4:
     case type::boolean:
         return i4_value_ == rhs.i4_value_;
+    case type::r8:
+        return r8_value_ == rhs.r8_value_;
     case type::date:
     case type::lpstr:
         return lpstr_value_ == rhs.lpstr_value_;
@@ -174,6 +182,12 @@ XLNT_API std::int32_t variant::get() const
     return i4_value_;
 }
 
+template <>
+XLNT_API double variant::get() const
+{
+    return r8_value_;
+}
+
 template <>
 XLNT_API datetime variant::get() const
 {
@@ -0,0 +1,198 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <algorithm>
+
+#include <xlnt/workbook/load_options.hpp>
+
+namespace xlnt {
+
+load_options::load_options()
+    : worker_threads_(1),
+      skip_comments_(false),
+      skip_drawings_(false),
+      skip_properties_(false),
+      skip_themes_(false),
+      values_only_(false),
+      lazy_worksheets_(false),
+      inflate_buffer_size_(256 * 1024),
+      prefetch_threads_(0),
+      cell_arena_(false)
+{
+}
+
+std::size_t load_options::worker_threads() const
+{
+    return worker_threads_;
+}
+
+load_options &load_options::worker_threads(std::size_t count)
+{
+    worker_threads_ = count;
+    return *this;
+}
+
+const std::vector<std::string> &load_options::sheet_titles() const
+{
+    return sheet_titles_;
+}
+
+load_options &load_options::sheet_titles(const std::vector<std::string> &titles)
+{
+    sheet_titles_ = titles;
+    return *this;
+}
+
+const std::vector<std::size_t> &load_options::sheet_indices() const
+{
+    return sheet_indices_;
+}
+
+load_options &load_options::sheet_indices(const std::vector<std::size_t> &indices)
+{
+    sheet_indices_ = indices;
+    return *this;
+}
+
+bool load_options::loads_sheet(std::size_t index, const std::string &title) const
+{
+    if (sheet_titles_.empty() && sheet_indices_.empty())
+    {
+        return true;
+    }
+
+    return std::find(sheet_titles_.begin(), sheet_titles_.end(), title) != sheet_titles_.end()
+        || std::find(sheet_indices_.begin(), sheet_indices_.end(), index) != sheet_indices_.end();
+}
+
+const optional<range_reference> &load_options::projection() const
+{
+    return projection_;
+}
+
+load_options &load_options::projection(const range_reference &range)
+{
+    projection_ = range;
+    return *this;
+}
+
+bool load_options::skip_comments() const
+{
+    return skip_comments_;
+}
+
+load_options &load_options::skip_comments(bool skip)
+{
+    skip_comments_ = skip;
+    return *this;
+}
+
+bool load_options::skip_drawings() const
+{
+    return skip_drawings_;
+}
+
+load_options &load_options::skip_drawings(bool skip)
+{
+    skip_drawings_ = skip;
+    return *this;
+}
+
+bool load_options::skip_properties() const
+{
+    return skip_properties_;
+}
+
+load_options &load_options::skip_properties(bool skip)
+{
+    skip_properties_ = skip;
+    return *this;
+}
+
+bool load_options::skip_themes() const
+{
+    return skip_themes_;
+}
+
+load_options &load_options::skip_themes(bool skip)
+{
+    skip_themes_ = skip;
+    return *this;
+}
+
+bool load_options::values_only() const
+{
+    return values_only_;
+}
+
+load_options &load_options::values_only(bool enabled)
+{
+    values_only_ = enabled;
+    return *this;
+}
+
+bool load_options::lazy_worksheets() const
+{
+    return lazy_worksheets_;
+}
+
+load_options &load_options::lazy_worksheets(bool enabled)
+{
+    lazy_worksheets_ = enabled;
+    return *this;
+}
+
+std::size_t load_options::inflate_buffer_size() const
+{
+    return inflate_buffer_size_;
+}
+
+load_options &load_options::inflate_buffer_size(std::size_t bytes)
+{
+    inflate_buffer_size_ = std::min(std::max(bytes, std::size_t(64 * 1024)), std::size_t(1024 * 1024));
+    return *this;
+}
+
+std::size_t load_options::prefetch_threads() const
+{
+    return prefetch_threads_;
+}
+
+load_options &load_options::prefetch_threads(std::size_t count)
+{
+    prefetch_threads_ = count;
+    return *this;
+}
+
+bool load_options::cell_arena() const
+{
+    return cell_arena_;
+}
+
+load_options &load_options::cell_arena(bool enabled)
+{
+    cell_arena_ = enabled;
+    return *this;
+}
+
+} // namespace xlnt
@@ -26,6 +26,7 @@
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/packaging/manifest.hpp>
 #include <xlnt/utils/optional.hpp>
+#include <xlnt/workbook/load_options.hpp>
 #include <xlnt/workbook/streaming_workbook_reader.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
@@ -37,6 +38,7 @@
 namespace xlnt {
 
 streaming_workbook_reader::streaming_workbook_reader()
+    : read_ahead_(false)
 {
 }
 
@@ -49,6 +51,10 @@ void streaming_workbook_reader::close()
 {
     if (consumer_)
     {
+        // the part is released first so a read ahead thread can finish before the archive is destroyed
+        parser_.reset(nullptr);
+        part_stream_.reset(nullptr);
+        part_stream_buffer_.reset(nullptr);
         consumer_.reset(nullptr);
         stream_buffer_.reset(nullptr);
     }
@@ -64,6 +70,11 @@ cell streaming_workbook_reader::read_cell()
     return consumer_->read_cell();
 }
 
+void streaming_workbook_reader::read_ahead(bool enabled)
+{
+    read_ahead_ = enabled;
+}
+
 bool streaming_workbook_reader::has_worksheet(const std::string &name)
 {
     auto titles = sheet_titles();
@@ -87,13 +98,24 @@ void streaming_workbook_reader::begin_worksheet(const std::string &title)
 
     const auto &manifest = consumer_->target_.manifest();
     const auto part_path = manifest.canonicalize(rel_chain);
-    auto part_stream_buffer = consumer_->archive_->open(part_path);
-    part_stream_buffer_.swap(part_stream_buffer);
+
+    parser_.reset(nullptr);
+    part_stream_.reset(nullptr);
+    part_stream_buffer_.reset(nullptr);
+    consumer_->archive_->stop_prefetch();
+
+    if (read_ahead_)
+    {
+        consumer_->archive_->prefetch({part_path}, 1);
+    }
+
+    part_stream_buffer_ = consumer_->archive_->open(part_path);
     part_stream_.reset(new std::istream(part_stream_buffer_.get()));
     parser_.reset(new xml::parser(*part_stream_, part_path.string()));
     consumer_->parser_ = parser_.get();
 
     consumer_->current_worksheet_ = nullptr;
+    consumer_->options_ = load_options();
 
     for (auto &impl : workbook_->impl().worksheets_)
     {
@@ -111,6 +133,12 @@ void streaming_workbook_reader::begin_worksheet(const std::string &title)
     consumer_->read_worksheet_begin(worksheet_rel_id_);
 }
 
+void streaming_workbook_reader::begin_worksheet(const std::string &title, const range_reference &projection)
+{
+    begin_worksheet(title);
+    consumer_->options_.projection(projection);
+}
+
 worksheet streaming_workbook_reader::end_worksheet()
 {
     return consumer_->read_worksheet_end(worksheet_rel_id_);
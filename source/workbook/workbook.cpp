@@ -26,6 +26,7 @@
 #include <array>
 #include <fstream>
 #include <functional>
+#include <iterator>
 #include <set>
 
 #include <xlnt/cell/cell.hpp>
@@ -42,6 +43,7 @@
 #include <xlnt/utils/exceptions.hpp>
 #include <xlnt/utils/path.hpp>
 #include <xlnt/utils/variant.hpp>
+#include <xlnt/workbook/load_options.hpp>
 #include <xlnt/workbook/metadata_property.hpp>
 #include <xlnt/workbook/named_range.hpp>
 #include <xlnt/workbook/theme.hpp>
@@ -57,10 +59,12 @@
 #include <detail/implementations/workbook_impl.hpp>
 #include <detail/implementations/worksheet_impl.hpp>
 #include <detail/serialization/excel_thumbnail.hpp>
+#include <detail/serialization/mapped_file.hpp>
 #include <detail/serialization/open_stream.hpp>
 #include <detail/serialization/vector_streambuf.hpp>
 #include <detail/serialization/xlsx_consumer.hpp>
 #include <detail/serialization/xlsx_producer.hpp>
+#include <detail/serialization/zstream.hpp>
 
 namespace {
 
@@ -257,6 +261,69 @@ std::string content_type(xlnt::relationship_type type)
     default_case("application/xml");
 }
 
+// Returns the part targeted by rel, an internal relationship of the package.
+xlnt::path target_part(const xlnt::manifest &manifest, const xlnt::relationship &rel)
+{
+    if (rel.source().path() == xlnt::path("/"))
+    {
+        return manifest.canonicalize({rel});
+    }
+
+    // the target is resolved relative to the part containing the relationship
+    const auto source = xlnt::relationship("rId1", rel.type(), xlnt::uri("/"),
+        rel.source(), xlnt::target_mode::internal);
+
+    return manifest.canonicalize({source, rel});
+}
+
+bool is_targeted(const xlnt::manifest &manifest, const xlnt::path &part)
+{
+    for (const auto &source : manifest.parts())
+    {
+        for (const auto &rel : manifest.relationships(source))
+        {
+            if (rel.target_mode() == xlnt::target_mode::internal && target_part(manifest, rel) == part)
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// Unregisters the relationships of part and, recursively, the parts they
+// target which no other part refers to, e.g. the comments and drawings of a
+// worksheet, so that they don't end up in [Content_Types].xml without a part.
+void unregister_related_parts(xlnt::manifest &manifest, const xlnt::path &part)
+{
+    while (true)
+    {
+        const auto rels = manifest.relationships(part);
+
+        if (rels.empty())
+        {
+            break;
+        }
+
+        const auto &rel = rels.front();
+        manifest.unregister_relationship(rel.source(), rel.id());
+
+        if (rel.target_mode() != xlnt::target_mode::internal)
+        {
+            continue;
+        }
+
+        const auto target = target_part(manifest, rel);
+
+        if (!is_targeted(manifest, target))
+        {
+            unregister_related_parts(manifest, target);
+            manifest.unregister_override_type(target.resolve(xlnt::path("/")));
+        }
+    }
+}
+
 } // namespace
 
 namespace xlnt {
@@ -487,12 +554,15 @@ workbook workbook::empty()
         .font(default_font)
         .number_format(xlnt::number_format::general());
 
-    wb.create_format(true)
+    // no cell uses the default format yet, so it's built in place and then
+    // given the reference that keeps it
+    wb.create_format()
         .border(default_border)
         .fill(default_fill)
         .font(default_font)
         .number_format(xlnt::number_format::general())
         .style("Normal");
+    ++stylesheet.format_impls.at(0).references;
 
     xlnt::calculation_properties calc_props;
     calc_props.calc_id = 150000;
@@ -650,6 +720,7 @@ const worksheet workbook::sheet_by_title(const std::string &title) const
     {
         if (impl.title_ == title)
         {
+            detail::xlsx_consumer::read_deferred_worksheet(impl);
             return worksheet(&impl);
         }
     }
@@ -663,6 +734,7 @@ worksheet workbook::sheet_by_title(const std::string &title)
     {
         if (impl.title_ == title)
         {
+            detail::xlsx_consumer::read_deferred_worksheet(impl);
             return worksheet(&impl);
         }
     }
@@ -684,6 +756,8 @@ worksheet workbook::sheet_by_index(std::size_t index)
         ++iter;
     }
 
+    detail::xlsx_consumer::read_deferred_worksheet(*iter);
+
     return worksheet(&*iter);
 }
 
@@ -700,6 +774,8 @@ const worksheet workbook::sheet_by_index(std::size_t index) const
     {
     }
 
+    detail::xlsx_consumer::read_deferred_worksheet(*iter);
+
     return worksheet(&*iter);
 }
 
@@ -709,6 +785,7 @@ worksheet workbook::sheet_by_id(std::size_t id)
     {
         if (impl.id_ == id)
         {
+            detail::xlsx_consumer::read_deferred_worksheet(impl);
             return worksheet(&impl);
         }
     }
@@ -722,6 +799,7 @@ const worksheet workbook::sheet_by_id(std::size_t id) const
     {
         if (impl.id_ == id)
         {
+            detail::xlsx_consumer::read_deferred_worksheet(impl);
             return worksheet(&impl);
         }
     }
@@ -773,11 +851,15 @@ worksheet workbook::create_sheet()
     }
     // unique sheet id
     size_t sheet_id = 1;
-    for (const auto ws : *this)
+    for (const auto &impl : d_->worksheets_)
     {
-        sheet_id = std::max(sheet_id, ws.id() + 1);
+        sheet_id = std::max(sheet_id, impl.id_ + 1);
     }
     d_->worksheets_.push_back(detail::worksheet_impl(this, sheet_id, title));
+    if (d_->cell_arenas_)
+    {
+        d_->worksheets_.back().cells_.use_arena(std::make_shared<detail::arena>());
+    }
     // unique sheet file name
     auto workbook_rel = d_->manifest_.relationship(path("/"), relationship_type::office_document);
     auto workbook_files = d_->manifest_.relationships(workbook_rel.target().path());
@@ -812,11 +894,28 @@ worksheet workbook::copy_sheet(worksheet to_copy)
 {
     if (to_copy.d_->parent_ != this) throw invalid_parameter();
 
-    detail::worksheet_impl impl(*to_copy.d_);
+    // copies don't share the state of a lazily read worksheet
+    detail::xlsx_consumer::read_deferred_worksheet(*to_copy.d_);
+
     auto new_sheet = create_sheet();
-    impl.title_ = new_sheet.title();
-    impl.id_ = new_sheet.id();
-    *new_sheet.d_ = impl;
+    const auto title = new_sheet.title();
+    const auto id = new_sheet.id();
+
+    // the cells are shared with to_copy until either of them changes them
+    *new_sheet.d_ = *to_copy.d_;
+    new_sheet.d_->title_ = title;
+    new_sheet.d_->id_ = id;
+
+    // the copied cells use their formats as well
+    new_sheet.d_->cells_.for_each_row(1, constants::max_row(), [](row_t, const detail::cell_row &entries) {
+        for (const auto &entry : entries)
+        {
+            if (entry.cell->format_ != nullptr)
+            {
+                ++entry.cell->format_->references;
+            }
+        }
+    });
 
     return new_sheet;
 }
@@ -833,8 +932,8 @@ worksheet workbook::copy_sheet(worksheet to_copy, std::size_t index)
         {
         }
 
-        d_->worksheets_.insert(iter, d_->worksheets_.back());
-        d_->worksheets_.pop_back();
+        // moved rather than copied so the cells keep their arena
+        d_->worksheets_.splice(iter, d_->worksheets_, std::prev(d_->worksheets_.end()));
     }
 
     return sheet_by_index(index);
@@ -890,38 +989,61 @@ range workbook::named_range(const std::string &name)
 }
 
 void workbook::load(std::istream &stream)
+{
+    load(stream, load_options());
+}
+
+void workbook::load(std::istream &stream, const load_options &options)
 {
     clear();
     detail::xlsx_consumer consumer(*this);
 
     try
     {
-        consumer.read(stream);
+        consumer.read(stream, options);
     }
-    catch (xlnt::exception &e)
+    catch (detail::encrypted_archive &)
     {
-        if (e.what() == std::string("xlnt::exception : encrypted xlsx, password required"))
-        {
-            stream.seekg(0, std::ios::beg);
-            consumer.read(stream, "VelvetSweatshop");
-        }
-        else
-        {
-            throw;
-        }
+        stream.seekg(0, std::ios::beg);
+        consumer.read(stream, "VelvetSweatshop");
     }
 }
 
 void workbook::load(const std::vector<std::uint8_t> &data)
 {
-    if (data.size() < 22) // the shortest ZIP file is 22 bytes
+    load(data, load_options());
+}
+
+void workbook::load(const std::vector<std::uint8_t> &data, const load_options &options)
+{
+    load(data.data(), data.size(), options);
+}
+
+void workbook::load(const void *data, std::size_t size)
+{
+    load(data, size, load_options());
+}
+
+void workbook::load(const void *data, std::size_t size, const load_options &options)
+{
+    if (size < 22) // the shortest ZIP file is 22 bytes
     {
         throw xlnt::exception("file is empty or malformed");
     }
 
-    xlnt::detail::vector_istreambuf data_buffer(data);
-    std::istream data_stream(&data_buffer);
-    load(data_stream);
+    const auto bytes = static_cast<const std::uint8_t *>(data);
+
+    clear();
+    detail::xlsx_consumer consumer(*this);
+
+    try
+    {
+        consumer.read(bytes, size, options);
+    }
+    catch (detail::encrypted_archive &)
+    {
+        load(std::vector<std::uint8_t>(bytes, bytes + size), "VelvetSweatshop");
+    }
 }
 
 void workbook::load(const std::string &filename)
@@ -929,8 +1051,46 @@ void workbook::load(const std::string &filename)
     return load(path(filename));
 }
 
+void workbook::load(const std::string &filename, const load_options &options)
+{
+    return load(path(filename), options);
+}
+
 void workbook::load(const path &filename)
 {
+    load(filename, load_options());
+}
+
+void workbook::load(const path &filename, const load_options &options)
+{
+    std::shared_ptr<detail::mapped_file> mapping;
+
+    try
+    {
+        mapping = std::make_shared<detail::mapped_file>(filename);
+    }
+    catch (detail::unmappable_file &)
+    {
+        // e.g. empty files, which the stream below reports
+    }
+
+    if (mapping)
+    {
+        clear();
+        detail::xlsx_consumer consumer(*this);
+
+        try
+        {
+            // lazily read worksheets keep the mapping alive through the archive
+            consumer.read(mapping->data(), mapping->size(), options, mapping);
+            return;
+        }
+        catch (detail::encrypted_archive &)
+        {
+            // encrypted files are decrypted from the stream below
+        }
+    }
+
     std::ifstream file_stream;
     open_stream(file_stream, filename.string());
 
@@ -939,7 +1099,7 @@ void workbook::load(const path &filename)
         throw xlnt::exception("file not found " + filename.string());
     }
 
-    load(file_stream);
+    load(file_stream, options);
 }
 
 void workbook::load(const std::string &filename, const std::string &password)
@@ -1072,8 +1232,9 @@ void workbook::remove_sheet(worksheet ws)
     auto ws_rel_id = d_->sheet_title_rel_id_map_.at(ws.title());
     auto wb_rel = d_->manifest_.relationship(path("/"), xlnt::relationship_type::office_document);
     auto ws_rel = d_->manifest_.relationship(wb_rel.target().path(), ws_rel_id);
-    auto ws_part = d_->manifest_.canonicalize({wb_rel, ws_rel}).resolve(path("/"));
-    d_->manifest_.unregister_override_type(ws_part);
+    auto ws_part = d_->manifest_.canonicalize({wb_rel, ws_rel});
+    d_->manifest_.unregister_override_type(ws_part.resolve(path("/")));
+    unregister_related_parts(d_->manifest_, ws_part);
     auto rel_id_map = d_->manifest_.unregister_relationship(wb_rel.target(), ws_rel_id);
     d_->sheet_title_rel_id_map_.erase(ws.title());
     d_->worksheets_.erase(match_iter);
@@ -1101,8 +1262,8 @@ worksheet workbook::create_sheet(std::size_t index)
         {
         }
 
-        d_->worksheets_.insert(iter, d_->worksheets_.back());
-        d_->worksheets_.pop_back();
+        // moved rather than copied so the cells keep their arena
+        d_->worksheets_.splice(iter, d_->worksheets_, std::prev(d_->worksheets_.end()));
     }
 
     return sheet_by_index(index);
@@ -1112,6 +1273,10 @@ worksheet workbook::create_sheet_with_rel(const std::string &title, const relati
 {
     auto sheet_id = d_->worksheets_.size() + 1;
     d_->worksheets_.push_back(detail::worksheet_impl(this, sheet_id, title));
+    if (d_->cell_arenas_)
+    {
+        d_->worksheets_.back().cells_.use_arena(std::make_shared<detail::arena>());
+    }
 
     auto workbook_rel = d_->manifest_.relationship(path("/"), relationship_type::office_document);
     auto sheet_absoulute_path = workbook_rel.target().path().parent().append(rel.target().path());
@@ -1160,9 +1325,9 @@ std::vector<std::string> workbook::sheet_titles() const
 {
     std::vector<std::string> names;
 
-    for (auto ws : *this)
+    for (const auto &impl : d_->worksheets_)
     {
-        names.push_back(ws.title());
+        names.push_back(impl.title_);
     }
 
     return names;
@@ -1208,9 +1373,9 @@ void workbook::swap(workbook &right)
 
     if (left.d_ != nullptr)
     {
-        for (auto ws : left)
+        for (auto &impl : left.d_->worksheets_)
         {
-            ws.parent(left);
+            impl.parent_ = &left;
         }
 
         if (left.d_->stylesheet_.is_set())
@@ -1221,9 +1386,9 @@ void workbook::swap(workbook &right)
 
     if (right.d_ != nullptr)
     {
-        for (auto ws : right)
+        for (auto &impl : right.d_->worksheets_)
         {
-            ws.parent(right);
+            impl.parent_ = &right;
         }
 
         if (right.d_->stylesheet_.is_set())
@@ -1250,11 +1415,17 @@ workbook::workbook(workbook &&other)
 workbook::workbook(const workbook &other)
     : workbook()
 {
+    // copies don't share the state of lazily read worksheets
+    for (auto &impl : other.d_->worksheets_)
+    {
+        detail::xlsx_consumer::read_deferred_worksheet(impl);
+    }
+
     *d_.get() = *other.d_.get();
 
-    for (auto ws : *this)
+    for (auto &impl : d_->worksheets_)
     {
-        ws.parent(*this);
+        impl.parent_ = this;
     }
 
     d_->stylesheet_.get().parent = this;
@@ -1295,8 +1466,16 @@ std::vector<named_range> workbook::named_ranges() const
 
 format workbook::create_format(bool default_format)
 {
-    register_workbook_part(relationship_type::stylesheet);
-    return d_->stylesheet_.get().create_format(default_format);
+    auto &stylesheet = d_->stylesheet_.get();
+
+    // formats are only added along with the stylesheet part, so it only needs
+    // registering for the first one
+    if (stylesheet.format_impls.size() == 0)
+    {
+        register_workbook_part(relationship_type::stylesheet);
+    }
+
+    return stylesheet.create_format(default_format);
 }
 
 bool workbook::has_style(const std::string &name) const
@@ -1339,6 +1518,17 @@ void workbook::clear_formats()
     apply_to_cells([](cell c) { c.clear_format(); });
 }
 
+void workbook::compact_styles()
+{
+    // cells of worksheets which haven't been read yet refer to formats by index
+    for (auto &impl : d_->worksheets_)
+    {
+        detail::xlsx_consumer::read_deferred_worksheet(impl);
+    }
+
+    d_->stylesheet_.get().garbage_collect();
+}
+
 void workbook::apply_to_cells(std::function<void(cell)> f)
 {
     for (auto ws : *this)
@@ -1376,53 +1566,69 @@ const manifest &workbook::manifest() const
     return d_->manifest_;
 }
 
-const rich_text &workbook::shared_strings(std::size_t index) const
+rich_text workbook::shared_strings(std::size_t index) const
 {
-    if (index < d_->shared_strings_values_.size())
+    if (index < d_->shared_strings_->size())
     {
-        return d_->shared_strings_values_.at(index);
+        return d_->shared_strings_->value(index);
     }
 
-    static rich_text empty;
-    return empty;
+    return rich_text();
 }
 
 std::vector<rich_text> &workbook::shared_strings()
 {
-    return d_->shared_strings_values_;
+    return d_->modifiable_shared_strings().modifiable_values();
 }
 
 const std::vector<rich_text> &workbook::shared_strings() const
 {
-    return d_->shared_strings_values_;
+    return d_->shared_strings_->values();
 }
 
 std::size_t workbook::add_shared_string(const rich_text &shared, bool allow_duplicates)
 {
+    if (!allow_duplicates)
+    {
+        auto existing = d_->shared_strings_->find(shared);
+
+        if (existing != d_->shared_strings_->size())
+        {
+            return existing;
+        }
+    }
+
+    // the part was registered when the strings found above were added
     register_workbook_part(relationship_type::shared_string_table);
 
+    return d_->modifiable_shared_strings().add(shared, allow_duplicates);
+}
+
+std::size_t workbook::add_shared_string(const std::string &shared, bool allow_duplicates)
+{
     if (!allow_duplicates)
     {
-        auto it = d_->shared_strings_ids_.find(shared);
+        auto existing = d_->shared_strings_->find(shared.data(), shared.size());
 
-        if (it != d_->shared_strings_ids_.end())
+        if (existing != d_->shared_strings_->size())
         {
-            return it->second;
+            return existing;
         }
     }
 
-    auto sz = d_->shared_strings_ids_.size();
-    d_->shared_strings_ids_[shared] = sz;
-    d_->shared_strings_values_.push_back(shared);
+    // the part was registered when the strings found above were added
+    register_workbook_part(relationship_type::shared_string_table);
+
+    const auto preserve_space = !shared.empty() && (shared.front() == ' ' || shared.back() == ' ');
 
-    return sz;
+    return d_->modifiable_shared_strings().add(shared.data(), shared.size(), preserve_space, allow_duplicates);
 }
 
 bool workbook::contains(const std::string &sheet_title) const
 {
-    for (auto ws : *this)
+    for (const auto &impl : d_->worksheets_)
     {
-        if (ws.title() == sheet_title) return true;
+        if (impl.title_ == sheet_title) return true;
     }
 
     return false;
@@ -37,9 +37,10 @@ cell_iterator::cell_iterator(worksheet ws, const cell_reference &cursor,
       cursor_(cursor),
       bounds_(bounds)
 {
-    if (skip_null && !ws.has_cell(cursor_))
+    if (skip_null)
     {
-        (*this)++; // move to the next non-empty cell or one past the end if none exists
+        // move to the next non-empty cell or one past the end if none exists
+        cursor_ = ws_.next_stored_cell(cursor_, bounds_, order_);
     }
 }
 
@@ -52,9 +53,10 @@ const_cell_iterator::const_cell_iterator(worksheet ws, const cell_reference &cur
       cursor_(cursor),
       bounds_(bounds)
 {
-    if (skip_null && !ws.has_cell(cursor_))
+    if (skip_null)
     {
-        (*this)++; // move to the next non-empty cell or one past the end if none exists
+        // move to the next non-empty cell or one past the end if none exists
+        cursor_ = ws_.next_stored_cell(cursor_, bounds_, order_);
     }
 }
 
@@ -99,10 +101,7 @@ cell_iterator &cell_iterator::operator--()
 
         if (skip_null_)
         {
-            while (!ws_.has_cell(cursor_) && cursor_.column() > bounds_.top_left().column())
-            {
-                cursor_.column_index(cursor_.column_index() - 1);
-            }
+            cursor_ = ws_.previous_stored_cell(cursor_, bounds_, order_);
         }
     }
     else
@@ -114,10 +113,7 @@ cell_iterator &cell_iterator::operator--()
 
         if (skip_null_)
         {
-            while (!ws_.has_cell(cursor_) && cursor_.row() > bounds_.top_left().row())
-            {
-                cursor_.row(cursor_.row() - 1);
-            }
+            cursor_ = ws_.previous_stored_cell(cursor_, bounds_, order_);
         }
     }
 
@@ -135,10 +131,7 @@ const_cell_iterator &const_cell_iterator::operator--()
 
         if (skip_null_)
         {
-            while (!ws_.has_cell(cursor_) && cursor_.column() > bounds_.top_left().column())
-            {
-                cursor_.column_index(cursor_.column_index() - 1);
-            }
+            cursor_ = ws_.previous_stored_cell(cursor_, bounds_, order_);
         }
     }
     else
@@ -150,10 +143,7 @@ const_cell_iterator &const_cell_iterator::operator--()
 
         if (skip_null_)
         {
-            while (!ws_.has_cell(cursor_) && cursor_.row() > bounds_.top_left().row())
-            {
-                cursor_.row(cursor_.row() - 1);
-            }
+            cursor_ = ws_.previous_stored_cell(cursor_, bounds_, order_);
         }
     }
 
@@ -187,10 +177,7 @@ cell_iterator &cell_iterator::operator++()
 
         if (skip_null_)
         {
-            while (!ws_.has_cell(cursor_) && cursor_.column() <= bounds_.bottom_right().column())
-            {
-                cursor_.column_index(cursor_.column_index() + 1);
-            }
+            cursor_ = ws_.next_stored_cell(cursor_, bounds_, order_);
         }
     }
     else
@@ -202,10 +189,7 @@ cell_iterator &cell_iterator::operator++()
 
         if (skip_null_)
         {
-            while (!ws_.has_cell(cursor_) && cursor_.row() <= bounds_.bottom_right().row())
-            {
-                cursor_.row(cursor_.row() + 1);
-            }
+            cursor_ = ws_.next_stored_cell(cursor_, bounds_, order_);
         }
     }
 
@@ -223,10 +207,7 @@ const_cell_iterator &const_cell_iterator::operator++()
 
         if (skip_null_)
         {
-            while (!ws_.has_cell(cursor_) && cursor_.column() <= bounds_.bottom_right().column())
-            {
-                cursor_.column_index(cursor_.column_index() + 1);
-            }
+            cursor_ = ws_.next_stored_cell(cursor_, bounds_, order_);
         }
     }
     else
@@ -238,10 +219,7 @@ const_cell_iterator &const_cell_iterator::operator++()
 
         if (skip_null_)
         {
-            while (!ws_.has_cell(cursor_) && cursor_.row() <= bounds_.bottom_right().row())
-            {
-                cursor_.row(cursor_.row() + 1);
-            }
+            cursor_ = ws_.next_stored_cell(cursor_, bounds_, order_);
         }
     }
 
@@ -21,6 +21,11 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <unordered_map>
+
+#include <detail/implementations/cell_impl.hpp>
+#include <detail/implementations/stylesheet.hpp>
+#include <detail/implementations/worksheet_impl.hpp>
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/styles/style.hpp>
 #include <xlnt/workbook/workbook.hpp>
@@ -139,44 +144,37 @@ bool range::contains(const cell_reference &cell_ref)
 
 range range::alignment(const xlnt::alignment &new_alignment)
 {
-    apply([&new_alignment](class cell c) { c.alignment(new_alignment); });
-    return *this;
+    return restyle([&new_alignment](class cell c) { c.alignment(new_alignment); });
 }
 
 range range::border(const xlnt::border &new_border)
 {
-    apply([&new_border](class cell c) { c.border(new_border); });
-    return *this;
+    return restyle([&new_border](class cell c) { c.border(new_border); });
 }
 
 range range::fill(const xlnt::fill &new_fill)
 {
-    apply([&new_fill](class cell c) { c.fill(new_fill); });
-    return *this;
+    return restyle([&new_fill](class cell c) { c.fill(new_fill); });
 }
 
 range range::font(const xlnt::font &new_font)
 {
-    apply([&new_font](class cell c) { c.font(new_font); });
-    return *this;
+    return restyle([&new_font](class cell c) { c.font(new_font); });
 }
 
 range range::number_format(const xlnt::number_format &new_number_format)
 {
-    apply([&new_number_format](class cell c) { c.number_format(new_number_format); });
-    return *this;
+    return restyle([&new_number_format](class cell c) { c.number_format(new_number_format); });
 }
 
 range range::protection(const xlnt::protection &new_protection)
 {
-    apply([&new_protection](class cell c) { c.protection(new_protection); });
-    return *this;
+    return restyle([&new_protection](class cell c) { c.protection(new_protection); });
 }
 
 range range::style(const class style &new_style)
 {
-    apply([&new_style](class cell c) { c.style(new_style); });
-    return *this;
+    return restyle([&new_style](class cell c) { c.style(new_style); });
 }
 
 range range::style(const std::string &style_name)
@@ -189,6 +187,34 @@ conditional_format range::conditional_format(const condition &when)
     return ws_.conditional_format(ref_, when);
 }
 
+range range::restyle(const std::function<void(class cell)> &change)
+{
+    // the format given to the cells of each format, nullptr for no format
+    std::unordered_map<detail::format_impl *, detail::format_impl *> targets;
+
+    apply([&](class cell c) {
+        auto source = c.d_->format_;
+        auto target = targets.find(source);
+
+        if (target == targets.end())
+        {
+            change(c);
+            targets.emplace(source, c.d_->format_);
+        }
+        else if (target->second != source)
+        {
+            if (c.parent_ != nullptr)
+            {
+                c.d_ = c.parent_->cells_.detach(c.d_);
+            }
+
+            detail::stylesheet::restyle(*c.d_, target->second);
+        }
+    });
+
+    return *this;
+}
+
 void range::apply(std::function<void(class cell)> f)
 {
     for (auto row : *this)
@@ -46,9 +46,10 @@ range_iterator::range_iterator(worksheet &ws, const cell_reference &cursor,
       cursor_(cursor),
       bounds_(bounds)
 {
-    if (skip_null_ && (**this).empty())
+    if (skip_null_)
     {
-        ++(*this);
+        // move to the next non-empty row or column or one past the end if none exists
+        cursor_ = ws_.next_stored_vector(cursor_, bounds_, order_);
     }
 }
 
@@ -76,10 +77,7 @@ range_iterator &range_iterator::operator--()
 
         if (skip_null_)
         {
-            while ((**this).empty() && cursor_.row() > bounds_.top_left().row())
-            {
-                cursor_.row(cursor_.row() - 1);
-            }
+            cursor_ = ws_.previous_stored_vector(cursor_, bounds_, order_);
         }
     }
     else
@@ -91,10 +89,7 @@ range_iterator &range_iterator::operator--()
 
         if (skip_null_)
         {
-            while ((**this).empty() && cursor_.column() > bounds_.top_left().column())
-            {
-                cursor_.column_index(cursor_.column_index() - 1);
-            }
+            cursor_ = ws_.previous_stored_vector(cursor_, bounds_, order_);
         }
     }
 
@@ -120,10 +115,7 @@ range_iterator &range_iterator::operator++()
 
         if (skip_null_)
         {
-            while ((**this).empty() && cursor_.row() <= bounds_.bottom_right().row())
-            {
-                cursor_.row(cursor_.row() + 1);
-            }
+            cursor_ = ws_.next_stored_vector(cursor_, bounds_, order_);
         }
     }
     else
@@ -135,10 +127,7 @@ range_iterator &range_iterator::operator++()
 
         if (skip_null_)
         {
-            while ((**this).empty() && cursor_.column() <= bounds_.bottom_right().column())
-            {
-                cursor_.column_index(cursor_.column_index() + 1);
-            }
+            cursor_ = ws_.next_stored_vector(cursor_, bounds_, order_);
         }
     }
 
@@ -161,9 +150,10 @@ const_range_iterator::const_range_iterator(const worksheet &ws, const cell_refer
       cursor_(cursor),
       bounds_(bounds)
 {
-    if (skip_null_ && (**this).empty())
+    if (skip_null_)
     {
-        ++(*this);
+        // move to the next non-empty row or column or one past the end if none exists
+        cursor_ = worksheet(ws_).next_stored_vector(cursor_, bounds_, order_);
     }
 }
 
@@ -191,10 +181,7 @@ const_range_iterator &const_range_iterator::operator--()
 
         if (skip_null_)
         {
-            while ((**this).empty() && cursor_.row() > bounds_.top_left().row())
-            {
-                cursor_.row(cursor_.row() - 1);
-            }
+            cursor_ = worksheet(ws_).previous_stored_vector(cursor_, bounds_, order_);
         }
     }
     else
@@ -206,10 +193,7 @@ const_range_iterator &const_range_iterator::operator--()
 
         if (skip_null_)
         {
-            while ((**this).empty() && cursor_.row() > bounds_.top_left().column())
-            {
-                cursor_.column_index(cursor_.column_index() - 1);
-            }
+            cursor_ = worksheet(ws_).previous_stored_vector(cursor_, bounds_, order_);
         }
     }
 
@@ -235,10 +219,7 @@ const_range_iterator &const_range_iterator::operator++()
 
         if (skip_null_)
         {
-            while ((**this).empty() && cursor_.row() <= bounds_.bottom_right().row())
-            {
-                cursor_.row(cursor_.row() + 1);
-            }
+            cursor_ = worksheet(ws_).next_stored_vector(cursor_, bounds_, order_);
         }
     }
     else
@@ -250,10 +231,7 @@ const_range_iterator &const_range_iterator::operator++()
 
         if (skip_null_)
         {
-            while ((**this).empty() && cursor_.column() <= bounds_.bottom_right().column())
-            {
-                cursor_.column_index(cursor_.column_index() + 1);
-            }
+            cursor_ = worksheet(ws_).next_stored_vector(cursor_, bounds_, order_);
         }
     }
 
@@ -24,7 +24,9 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <limits>
+#include <memory>
 
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/cell/cell_reference.hpp>
@@ -34,11 +36,13 @@
 #include <xlnt/utils/datetime.hpp>
 #include <xlnt/utils/exceptions.hpp>
 #include <xlnt/utils/numeric.hpp>
+#include <xlnt/utils/variant.hpp>
 #include <xlnt/workbook/named_range.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/workbook/worksheet_iterator.hpp>
 #include <xlnt/worksheet/cell_iterator.hpp>
 #include <xlnt/worksheet/column_properties.hpp>
+#include <xlnt/worksheet/column_view.hpp>
 #include <xlnt/worksheet/header_footer.hpp>
 #include <xlnt/worksheet/range.hpp>
 #include <xlnt/worksheet/range_iterator.hpp>
@@ -54,11 +58,78 @@
 
 namespace {
 
+bool entry_before_column(const xlnt::detail::cell_entry &entry, xlnt::column_t::index_t column)
+{
+    return entry.column < column;
+}
+
+bool entry_less(const xlnt::detail::cell_entry &a, const xlnt::detail::cell_entry &b)
+{
+    return a.column < b.column;
+}
+
 int points_to_pixels(double points, double dpi)
 {
     return static_cast<int>(std::ceil(points * dpi / 72));
 }
 
+template <typename T>
+std::shared_ptr<T> make_column_values(std::size_t size, const T &empty)
+{
+    auto values = std::make_shared<std::vector<T>>(size, empty);
+    return std::shared_ptr<T>(values, values->data());
+}
+
+std::shared_ptr<bool> make_column_values(std::size_t size, bool empty)
+{
+    // std::vector<bool> isn't contiguous
+    auto values = std::shared_ptr<bool>(new bool[size], std::default_delete<bool[]>());
+    std::fill(values.get(), values.get() + size, empty);
+
+    return values;
+}
+
+/// <summary>
+/// Gathers the values of the cells of the given type in column from first_row
+/// to last_row into a column_view, converting them with convert. Values for
+/// which convert returns false, e.g. because they're out of range, are invalid.
+/// </summary>
+template <typename T, typename Convert>
+xlnt::column_view<T> gather_column(const xlnt::detail::cell_store &cells, xlnt::column_t column,
+    xlnt::row_t first_row, xlnt::row_t last_row, xlnt::cell_type type, const T &empty, Convert convert)
+{
+    if (last_row < first_row)
+    {
+        return xlnt::column_view<T>(first_row, 0, make_column_values(0, empty), {});
+    }
+
+    const auto size = static_cast<std::size_t>(last_row - first_row) + 1;
+    auto values = make_column_values(size, empty);
+    std::vector<std::uint8_t> validity((size + 7) / 8, 0);
+    const auto column_index = column.index;
+
+    cells.for_each_row(first_row, last_row, [&](xlnt::row_t row, const xlnt::detail::cell_row &entries) {
+        auto entry = std::lower_bound(entries.begin(), entries.end(), column_index,
+            [](const xlnt::detail::cell_entry &e, xlnt::column_t::index_t index) { return e.column < index; });
+
+        if (entry == entries.end() || entry->column != column_index || entry->cell->type_ != type)
+        {
+            return;
+        }
+
+        const auto index = static_cast<std::size_t>(row - first_row);
+
+        if (!convert(entry->cell->value_numeric_, values.get()[index]))
+        {
+            return;
+        }
+
+        validity[index / 8] = static_cast<std::uint8_t>(validity[index / 8] | (1 << (index % 8)));
+    });
+
+    return xlnt::column_view<T>(first_row, size, std::move(values), std::move(validity));
+}
+
 } // namespace
 
 namespace xlnt {
@@ -201,19 +272,9 @@ const workbook &worksheet::workbook() const
 
 void worksheet::garbage_collect()
 {
-    auto cell_iter = d_->cell_map_.begin();
-
-    while (cell_iter != d_->cell_map_.end())
-    {
-        if (xlnt::cell(&cell_iter->second).garbage_collectible())
-        {
-            cell_iter = d_->cell_map_.erase(cell_iter);
-        }
-        else
-        {
-            ++cell_iter;
-        }
-    }
+    d_->cells_.erase_if([](detail::cell_impl &cell) {
+        return cell.is_garbage_collectible();
+    });
 }
 
 void worksheet::id(std::size_t id)
@@ -382,22 +443,25 @@ cell_reference worksheet::active_cell() const
 
 cell worksheet::cell(const cell_reference &reference)
 {
-    auto match = d_->cell_map_.find(reference);
-    if (match == d_->cell_map_.end())
+    auto match = d_->cells_.emplace(reference);
+    if (match.second)
     {
-        auto impl = detail::cell_impl();
-        impl.parent_ = d_;
-        impl.column_ = reference.column_index();
-        impl.row_ = reference.row();
-
-        match = d_->cell_map_.emplace(reference, impl).first;
+        match.first->parent_ = d_;
     }
-    return xlnt::cell(&match->second);
+    return xlnt::cell(match.first, d_);
 }
 
 const cell worksheet::cell(const cell_reference &reference) const
 {
-    return xlnt::cell(&d_->cell_map_.at(reference));
+    // the const lookup leaves blocks shared with copies alone, writes through
+    // the cell detach it
+    const auto &cells = d_->cells_;
+    auto match = cells.find(reference);
+    if (match == nullptr)
+    {
+        throw xlnt::key_not_found();
+    }
+    return xlnt::cell(const_cast<detail::cell_impl *>(match), d_);
 }
 
 cell worksheet::cell(xlnt::column_t column, row_t row)
@@ -412,8 +476,10 @@ const cell worksheet::cell(xlnt::column_t column, row_t row) const
 
 bool worksheet::has_cell(const cell_reference &reference) const
 {
-    const auto cell = d_->cell_map_.find(reference);
-    return cell != d_->cell_map_.cend();
+    const auto &cells = d_->cells_;
+
+    // const so that blocks shared with copies of the worksheet aren't copied
+    return cells.find(reference) != nullptr;
 }
 
 bool worksheet::has_row_properties(row_t row) const
@@ -453,33 +519,22 @@ const range worksheet::named_range(const std::string &name) const
 
 column_t worksheet::lowest_column() const
 {
-    if (d_->cell_map_.empty())
+    if (d_->cells_.empty())
     {
         return constants::min_column();
     }
 
-    auto lowest = constants::max_column();
-
-    for (auto &cell : d_->cell_map_)
-    {
-        lowest = std::min(lowest, cell.first.column());
-    }
-
-    return lowest;
+    return d_->cells_.extent().min_column;
 }
 
 column_t worksheet::lowest_column_or_props() const
 {
     auto lowest = lowest_column();
 
-    if (d_->cell_map_.empty() && !d_->column_properties_.empty())
+    if (!d_->column_properties_.empty())
     {
-        lowest = d_->column_properties_.begin()->first;
-    }
-
-    for (auto &props : d_->column_properties_)
-    {
-        lowest = std::min(lowest, props.first);
+        const auto first = d_->column_properties_.begin()->first;
+        lowest = d_->cells_.empty() ? first : std::min(lowest, first);
     }
 
     return lowest;
@@ -487,33 +542,22 @@ column_t worksheet::lowest_column_or_props() const
 
 row_t worksheet::lowest_row() const
 {
-    if (d_->cell_map_.empty())
+    if (d_->cells_.empty())
     {
         return constants::min_row();
     }
 
-    auto lowest = constants::max_row();
-
-    for (auto &cell : d_->cell_map_)
-    {
-        lowest = std::min(lowest, cell.first.row());
-    }
-
-    return lowest;
+    return d_->cells_.extent().min_row;
 }
 
 row_t worksheet::lowest_row_or_props() const
 {
     auto lowest = lowest_row();
 
-    if (d_->cell_map_.empty() && !d_->row_properties_.empty())
-    {
-        lowest = d_->row_properties_.begin()->first;
-    }
-
-    for (auto &props : d_->row_properties_)
+    if (!d_->row_properties_.empty())
     {
-        lowest = std::min(lowest, props.first);
+        const auto first = d_->row_properties_.begin()->first;
+        lowest = d_->cells_.empty() ? first : std::min(lowest, first);
     }
 
     return lowest;
@@ -521,28 +565,22 @@ row_t worksheet::lowest_row_or_props() const
 
 row_t worksheet::highest_row() const
 {
-    auto highest = constants::min_row();
-
-    for (auto &cell : d_->cell_map_)
+    if (d_->cells_.empty())
     {
-        highest = std::max(highest, cell.first.row());
+        return constants::min_row();
     }
 
-    return highest;
+    return d_->cells_.extent().max_row;
 }
 
 row_t worksheet::highest_row_or_props() const
 {
     auto highest = highest_row();
 
-    if (d_->cell_map_.empty() && !d_->row_properties_.empty())
+    if (!d_->row_properties_.empty())
     {
-        highest = d_->row_properties_.begin()->first;
-    }
-
-    for (auto &props : d_->row_properties_)
-    {
-        highest = std::max(highest, props.first);
+        const auto last = d_->row_properties_.rbegin()->first;
+        highest = d_->cells_.empty() ? last : std::max(highest, last);
     }
 
     return highest;
@@ -550,28 +588,22 @@ row_t worksheet::highest_row_or_props() const
 
 column_t worksheet::highest_column() const
 {
-    auto highest = constants::min_column();
-
-    for (auto &cell : d_->cell_map_)
+    if (d_->cells_.empty())
     {
-        highest = std::max(highest, cell.first.column());
+        return constants::min_column();
     }
 
-    return highest;
+    return d_->cells_.extent().max_column;
 }
 
 column_t worksheet::highest_column_or_props() const
 {
     auto highest = highest_column();
 
-    if (d_->cell_map_.empty() && !d_->column_properties_.empty())
+    if (!d_->column_properties_.empty())
     {
-        highest = d_->column_properties_.begin()->first;
-    }
-
-    for (auto &props : d_->column_properties_)
-    {
-        highest = std::max(highest, props.first);
+        const auto last = d_->column_properties_.rbegin()->first;
+        highest = d_->cells_.empty() ? last : std::max(highest, last);
     }
 
     return highest;
@@ -579,46 +611,43 @@ column_t worksheet::highest_column_or_props() const
 
 range_reference worksheet::calculate_dimension(bool skip_null) const
 {
-    // partially optimised version of:
+    // equivalent to:
     // return range_reference(lowest_column(), lowest_row_or_props(),
     //                        highest_column(), highest_row_or_props());
-    //
-    if (d_->cell_map_.empty() && d_->row_properties_.empty())
+    // except that the first row and column are included unless skip_null
+    if (d_->cells_.empty() && d_->row_properties_.empty())
     {
         return range_reference(constants::min_column(), constants::min_row(),
             constants::min_column(), constants::min_row());
     }
 
-    // if skip_null = false, min row = min_row() and min column = min_column()
-    // in order to include first empty rows and columns
-    row_t min_row_prop = skip_null? constants::max_row() : constants::min_row();
-    row_t max_row_prop = constants::min_row();
-    for (const auto &row_prop : d_->row_properties_)
+    auto min_row = constants::max_row();
+    auto max_row = constants::min_row();
+    auto min_col = constants::min_column();
+    auto max_col = constants::min_column();
+
+    if (!d_->row_properties_.empty())
     {
-        if(skip_null){
-            min_row_prop = std::min(min_row_prop, row_prop.first);
-        }
-        max_row_prop = std::max(max_row_prop, row_prop.first);
+        min_row = d_->row_properties_.begin()->first;
+        max_row = d_->row_properties_.rbegin()->first;
     }
-    if (d_->cell_map_.empty())
+
+    if (!d_->cells_.empty())
     {
-        return range_reference(constants::min_column(), min_row_prop,
-            constants::min_column(), max_row_prop);
+        const auto &extent = d_->cells_.extent();
+        min_row = std::min(min_row, extent.min_row);
+        max_row = std::max(max_row, extent.max_row);
+        min_col = extent.min_column;
+        max_col = extent.max_column;
     }
-    // find min and max row/column in cell map
-    column_t min_col = skip_null? constants::max_column() : constants::min_column();
-    column_t max_col = constants::min_column();
-    row_t min_row = min_row_prop;
-    row_t max_row = max_row_prop;
-    for (auto &c : d_->cell_map_)
+
+    if (!skip_null)
     {
-        if(skip_null){
-            min_col = std::min(min_col, c.second.column_);
-            min_row = std::min(min_row, c.second.row_);
-        }
-        max_col = std::max(max_col, c.second.column_);
-        max_row = std::max(max_row, c.second.row_);
+        // include the empty rows and columns before the first cell
+        min_row = constants::min_row();
+        min_col = constants::min_column();
     }
+
     return range_reference(min_col, min_row, max_col, max_row);
 }
 
@@ -714,7 +743,7 @@ row_t worksheet::next_row() const
 {
     auto row = highest_row() + 1;
 
-    if (row == 2 && d_->cell_map_.size() == 0)
+    if (row == 2 && d_->cells_.empty())
     {
         row = 1;
     }
@@ -742,6 +771,427 @@ const xlnt::range worksheet::columns(bool skip_null) const
     return xlnt::range(*this, calculate_dimension(skip_null), major_order::column, skip_null);
 }
 
+std::vector<cell> worksheet::stored_cells(major_order order)
+{
+    std::vector<xlnt::cell> result;
+    result.reserve(d_->cells_.size());
+
+    for (auto &cell : d_->cells_)
+    {
+        result.push_back(xlnt::cell(&cell, d_));
+    }
+
+    if (order == major_order::column)
+    {
+        // stable so that the cells of each column stay in row order
+        std::stable_sort(result.begin(), result.end(), [](const xlnt::cell &a, const xlnt::cell &b) {
+            return a.d_->column_ < b.d_->column_;
+        });
+    }
+
+    return result;
+}
+
+const std::vector<cell> worksheet::stored_cells(major_order order) const
+{
+    return const_cast<worksheet *>(this)->stored_cells(order);
+}
+
+cell_reference worksheet::next_stored_cell(const cell_reference &cursor, const range_reference &bounds, major_order order) const
+{
+    auto result = cursor;
+
+    if (order == major_order::row)
+    {
+        const auto last = bounds.bottom_right().column_index();
+
+        if (cursor.column_index() > last)
+        {
+            return result;
+        }
+
+        result.column_index(last + 1);
+        auto entries = d_->cells_.row(cursor.row());
+
+        if (entries != nullptr)
+        {
+            auto entry = std::lower_bound(entries->begin(), entries->end(), cursor.column_index(), entry_before_column);
+
+            if (entry != entries->end() && entry->column <= last)
+            {
+                result.column_index(entry->column);
+            }
+        }
+    }
+    else
+    {
+        const auto last = bounds.bottom_right().row();
+
+        if (cursor.row() > last)
+        {
+            return result;
+        }
+
+        const auto column = cursor.column_index();
+        const auto row = d_->cells_.find_row(cursor.row(), last, [column](const detail::cell_row &entries) {
+            return std::binary_search(entries.begin(), entries.end(), detail::cell_entry{column, nullptr}, entry_less);
+        });
+
+        result.row(row == 0 ? last + 1 : row);
+    }
+
+    return result;
+}
+
+cell_reference worksheet::previous_stored_cell(const cell_reference &cursor, const range_reference &bounds, major_order order) const
+{
+    auto result = cursor;
+
+    if (order == major_order::row)
+    {
+        const auto first = bounds.top_left().column_index();
+
+        if (cursor.column_index() < first)
+        {
+            return result;
+        }
+
+        result.column_index(first);
+        auto entries = d_->cells_.row(cursor.row());
+
+        if (entries != nullptr)
+        {
+            auto entry = std::upper_bound(entries->begin(), entries->end(), detail::cell_entry{cursor.column_index(), nullptr}, entry_less);
+
+            if (entry != entries->begin() && (entry - 1)->column >= first)
+            {
+                result.column_index((entry - 1)->column);
+            }
+        }
+    }
+    else
+    {
+        const auto first = bounds.top_left().row();
+
+        if (cursor.row() < first)
+        {
+            return result;
+        }
+
+        const auto column = cursor.column_index();
+        const auto row = d_->cells_.find_last_row(first, cursor.row(), [column](const detail::cell_row &entries) {
+            return std::binary_search(entries.begin(), entries.end(), detail::cell_entry{column, nullptr}, entry_less);
+        });
+
+        result.row(row == 0 ? first : row);
+    }
+
+    return result;
+}
+
+cell_reference worksheet::next_stored_vector(const cell_reference &cursor, const range_reference &bounds, major_order order) const
+{
+    auto result = cursor;
+    const auto first_column = bounds.top_left().column_index();
+    const auto last_column = bounds.bottom_right().column_index();
+
+    if (order == major_order::row)
+    {
+        const auto last = bounds.bottom_right().row();
+
+        if (cursor.row() > last)
+        {
+            return result;
+        }
+
+        const auto row = d_->cells_.find_row(cursor.row(), last, [&](const detail::cell_row &entries) {
+            auto entry = std::lower_bound(entries.begin(), entries.end(), first_column, entry_before_column);
+            return entry != entries.end() && entry->column <= last_column;
+        });
+
+        result.row(row == 0 ? last + 1 : row);
+    }
+    else
+    {
+        if (cursor.column_index() > last_column)
+        {
+            return result;
+        }
+
+        // the leftmost cell at or after the cursor over all rows of bounds
+        auto next = last_column + 1;
+
+        d_->cells_.for_each_row(bounds.top_left().row(), bounds.bottom_right().row(), [&](row_t, const detail::cell_row &entries) {
+            auto entry = std::lower_bound(entries.begin(), entries.end(), cursor.column_index(), entry_before_column);
+
+            if (entry != entries.end() && entry->column < next)
+            {
+                next = entry->column;
+            }
+        });
+
+        result.column_index(next);
+    }
+
+    return result;
+}
+
+cell_reference worksheet::previous_stored_vector(const cell_reference &cursor, const range_reference &bounds, major_order order) const
+{
+    auto result = cursor;
+    const auto first_column = bounds.top_left().column_index();
+    const auto last_column = bounds.bottom_right().column_index();
+
+    if (order == major_order::row)
+    {
+        const auto first = bounds.top_left().row();
+
+        if (cursor.row() < first)
+        {
+            return result;
+        }
+
+        const auto row = d_->cells_.find_last_row(first, cursor.row(), [&](const detail::cell_row &entries) {
+            auto entry = std::lower_bound(entries.begin(), entries.end(), first_column, entry_before_column);
+            return entry != entries.end() && entry->column <= last_column;
+        });
+
+        result.row(row == 0 ? first : row);
+    }
+    else
+    {
+        if (cursor.column_index() < first_column)
+        {
+            return result;
+        }
+
+        // the rightmost cell at or before the cursor over all rows of bounds
+        auto previous = first_column;
+
+        d_->cells_.for_each_row(bounds.top_left().row(), bounds.bottom_right().row(), [&](row_t, const detail::cell_row &entries) {
+            auto entry = std::upper_bound(entries.begin(), entries.end(), detail::cell_entry{cursor.column_index(), nullptr}, entry_less);
+
+            if (entry != entries.begin() && (entry - 1)->column > previous)
+            {
+                previous = (entry - 1)->column;
+            }
+        });
+
+        result.column_index(previous);
+    }
+
+    return result;
+}
+
+template <>
+XLNT_API column_view<double> worksheet::column_values<double>(column_t column, row_t first_row, row_t last_row) const
+{
+    return gather_column<double>(d_->cells_, column, first_row, last_row, cell::type::number, 0.0,
+        [](double number, double &value) {
+            value = number;
+            return true;
+        });
+}
+
+template <>
+XLNT_API column_view<std::int64_t> worksheet::column_values<std::int64_t>(column_t column, row_t first_row, row_t last_row) const
+{
+    return gather_column<std::int64_t>(d_->cells_, column, first_row, last_row, cell::type::number, 0,
+        [](double number, std::int64_t &value) {
+            // casting NaN, infinities or anything outside [-2^63, 2^63) is undefined
+            if (!(number >= -9223372036854775808.0 && number < 9223372036854775808.0))
+            {
+                return false;
+            }
+
+            value = static_cast<std::int64_t>(number);
+
+            return true;
+        });
+}
+
+template <>
+XLNT_API column_view<bool> worksheet::column_values<bool>(column_t column, row_t first_row, row_t last_row) const
+{
+    return gather_column<bool>(d_->cells_, column, first_row, last_row, cell::type::boolean, false,
+        [](double number, bool &value) {
+            value = number != 0.0;
+            return true;
+        });
+}
+
+template <>
+XLNT_API column_view<datetime> worksheet::column_values<datetime>(column_t column, row_t first_row, row_t last_row) const
+{
+    const auto base_date = workbook().base_date();
+
+    return gather_column<datetime>(d_->cells_, column, first_row, last_row, cell::type::number,
+        datetime::from_number(0, base_date),
+        [base_date](double number, datetime &value) {
+            // the dates Excel can show, from the base date to 9999-12-31
+            if (!(number >= 0.0 && number < 2958466.0))
+            {
+                return false;
+            }
+
+            value = datetime::from_number(number, base_date);
+
+            return true;
+        });
+}
+
+void worksheet::assign(const range_reference &range, const double *values, std::size_t count)
+{
+    const auto width = range.width();
+
+    if (count != width * range.height())
+    {
+        throw invalid_parameter();
+    }
+
+    // cells come from the store's regular chunks rather than one block reserved
+    // for the whole range, which would be fresh memory for every call
+    const auto first_column = range.top_left().column_index();
+    std::vector<detail::cell_impl *> row_cells(width);
+
+    for (auto row = range.top_left().row(); row <= range.bottom_right().row(); ++row)
+    {
+        d_->cells_.emplace_row(row, first_column, width, row_cells.data());
+
+        for (auto cell : row_cells)
+        {
+            cell->parent_ = d_;
+            cell->type_ = cell::type::number;
+            cell->value_numeric_ = *values++;
+        }
+    }
+}
+
+void worksheet::assign(const cell_reference &top_left, const std::vector<std::vector<variant>> &rows)
+{
+    const auto first_column = top_left.column_index();
+    auto row = top_left.row();
+    std::vector<detail::cell_impl *> row_cells;
+
+    // the first date written to a cell without a format, whose format the
+    // dates written to other such cells share rather than looking it up again
+    detail::cell_impl *first_date = nullptr;
+    const auto base_date = workbook().base_date();
+
+    for (const auto &values : rows)
+    {
+        if (!values.empty())
+        {
+            // throws if the row doesn't fit in the worksheet
+            cell_reference(first_column + static_cast<column_t::index_t>(values.size() - 1), row);
+        }
+
+        // cells are only created for runs of non-null values
+        std::size_t run_start = 0;
+
+        while (run_start < values.size())
+        {
+            if (values[run_start].is(variant::type::null))
+            {
+                auto existing = d_->cells_.find(cell_reference(first_column + static_cast<column_t::index_t>(run_start), row));
+
+                if (existing != nullptr)
+                {
+                    xlnt::cell(existing, d_).clear_value();
+                }
+
+                ++run_start;
+                continue;
+            }
+
+            auto run_end = run_start + 1;
+
+            while (run_end < values.size() && !values[run_end].is(variant::type::null))
+            {
+                ++run_end;
+            }
+
+            row_cells.resize(run_end - run_start);
+            d_->cells_.emplace_row(row, first_column + static_cast<column_t::index_t>(run_start),
+                row_cells.size(), row_cells.data());
+
+            for (std::size_t i = 0; i < row_cells.size(); ++i)
+            {
+                auto cell = row_cells[i];
+                const auto &value = values[run_start + i];
+                cell->parent_ = d_;
+
+                switch (value.value_type())
+                {
+                case variant::type::i4:
+                    cell->type_ = cell::type::number;
+                    cell->value_numeric_ = value.get<std::int32_t>();
+                    break;
+                case variant::type::r8:
+                    cell->type_ = cell::type::number;
+                    cell->value_numeric_ = value.get<double>();
+                    break;
+                case variant::type::boolean:
+                    cell->type_ = cell::type::boolean;
+                    cell->value_numeric_ = value.get<bool>() ? 1.0 : 0.0;
+                    break;
+                case variant::type::lpstr:
+                    xlnt::cell(cell, d_).value(value.get<std::string>());
+                    break;
+                case variant::type::date:
+                    if (first_date != nullptr && cell->format_ == nullptr)
+                    {
+                        cell->type_ = cell::type::number;
+                        cell->value_numeric_ = value.get<datetime>().to_number(base_date);
+                        xlnt::cell(cell, d_).format(xlnt::cell(first_date, d_).format());
+                        break;
+                    }
+
+                    first_date = first_date == nullptr && cell->format_ == nullptr ? cell : first_date;
+                    xlnt::cell(cell, d_).value(value.get<datetime>());
+                    break;
+                case variant::type::null:
+                case variant::type::vector:
+                    throw invalid_parameter();
+                }
+            }
+
+            run_start = run_end;
+        }
+
+        ++row;
+    }
+}
+
+void worksheet::extract(const range_reference &range, double *values, std::size_t count) const
+{
+    const auto width = range.width();
+
+    if (count != width * range.height())
+    {
+        throw invalid_parameter();
+    }
+
+    std::fill(values, values + count, std::numeric_limits<double>::quiet_NaN());
+
+    const auto first_row = range.top_left().row();
+    const auto first_column = range.top_left().column_index();
+    const auto last_column = range.bottom_right().column_index();
+
+    d_->cells_.for_each_row(first_row, range.bottom_right().row(), [&](row_t row, const detail::cell_row &entries) {
+        auto entry = std::lower_bound(entries.begin(), entries.end(), first_column, entry_before_column);
+        auto row_values = values + static_cast<std::size_t>(row - first_row) * width;
+
+        for (; entry != entries.end() && entry->column <= last_column; ++entry)
+        {
+            if (entry->cell->type_ == cell::type::number)
+            {
+                row_values[entry->column - first_column] = entry->cell->value_numeric_;
+            }
+        }
+    });
+}
+
 /*
 //TODO: finish implementing cell_iterator wrapping before uncommenting
 
@@ -760,23 +1210,13 @@ const cell_vector worksheet::cells(bool skip_null) const
 
 void worksheet::clear_cell(const cell_reference &ref)
 {
-    d_->cell_map_.erase(ref);
+    d_->cells_.erase(ref);
     // TODO: garbage collect newly unreferenced resources such as styles?
 }
 
 void worksheet::clear_row(row_t row)
 {
-    for (auto it = d_->cell_map_.begin(); it != d_->cell_map_.end();)
-    {
-        if (it->first.row() == row)
-        {
-            it = d_->cell_map_.erase(it);
-        }
-        else
-        {
-            ++it;
-        }
-    }
+    d_->cells_.erase_row(row);
     d_->row_properties_.erase(row);
     // TODO: garbage collect newly unreferenced resources such as styles?
 }
@@ -813,59 +1253,78 @@ void worksheet::move_cells(std::uint32_t min_index, std::uint32_t amount, row_or
         throw xlnt::exception("Cannot move cells as they would be outside the maximum bounds of the spreadsheet");
     }
 
-    std::vector<detail::cell_impl> cells_to_move;
-
-    auto cell_iter = d_->cell_map_.cbegin();
-    while (cell_iter != d_->cell_map_.cend())
+    // rows and columns of cells are moved in place, not cell by cell
+    switch (row_or_col)
     {
-        std::uint32_t current_index;
-        switch (row_or_col)
+    case row_or_col_t::row:
+        if (reverse)
+        {
+            d_->cells_.delete_rows(min_index - amount, amount);
+        }
+        else
+        {
+            d_->cells_.insert_rows(min_index, amount);
+        }
+        break;
+    case row_or_col_t::column:
+        if (reverse)
+        {
+            d_->cells_.delete_columns(min_index - amount, amount);
+        }
+        else
         {
-        case row_or_col_t::row:
-            current_index = cell_iter->first.row();
-            break;
-        case row_or_col_t::column:
-            current_index = cell_iter->first.column().index;
-            break;
-        default:
-            throw xlnt::unhandled_switch_case();
+            d_->cells_.insert_columns(min_index, amount);
         }
+        break;
+    default:
+        throw xlnt::unhandled_switch_case();
+    }
 
-        if (current_index >= min_index) // extract cells to be moved
+    auto shift_reference = [min_index, amount, row_or_col, reverse](cell_reference &ref) {
+        auto index = row_or_col == row_or_col_t::row ? ref.row() : ref.column_index();
+        if (index >= min_index)
         {
-            auto cell = cell_iter->second;
+            auto new_index = reverse ? index - amount : index + amount;
             if (row_or_col == row_or_col_t::row)
             {
-                cell.row_ = reverse ? cell.row_ - amount : cell.row_ + amount;
+                ref.row(new_index);
             }
             else if (row_or_col == row_or_col_t::column)
             {
-                cell.column_ = reverse ? cell.column_.index - amount : cell.column_.index + amount;
+                ref.column_index(new_index);
             }
-
-            cells_to_move.push_back(cell);
-            cell_iter = d_->cell_map_.erase(cell_iter);
         }
-        else if (reverse && current_index >= min_index - amount) // delete destination cells
-        {
-            cell_iter = d_->cell_map_.erase(cell_iter);
-        }
-        else // skip other cells
+    };
+
+    // comments are held by the worksheet under the reference of their cell
+    if (!d_->comments_.empty())
+    {
+        std::unordered_map<std::string, xlnt::comment> comments;
+
+        for (auto &comment : d_->comments_)
         {
-            ++cell_iter;
+            auto reference = cell_reference(comment.first);
+            const auto index = row_or_col == row_or_col_t::row ? reference.row() : reference.column_index();
+
+            // comments of deleted cells are deleted with them
+            if (reverse && index < min_index && index >= min_index - amount)
+            {
+                continue;
+            }
+
+            shift_reference(reference);
+            comments.emplace(reference.to_string(), std::move(comment.second));
         }
-    }
 
-    for (auto &cell : cells_to_move)
-    {
-        d_->cell_map_[cell_reference(cell.column_, cell.row_)] = cell;
+        d_->comments_.swap(comments);
     }
 
     if (row_or_col == row_or_col_t::row)
     {
         std::vector<std::pair<row_t, xlnt::row_properties>> properties_to_move;
 
-        auto row_prop_iter = d_->row_properties_.cbegin();
+        // properties are ordered by row, those before the affected rows are skipped
+        auto row_prop_iter = d_->row_properties_.lower_bound(reverse ? min_index - amount : min_index);
         while (row_prop_iter != d_->row_properties_.cend())
         {
             auto current_row = row_prop_iter->first;
@@ -894,7 +1353,7 @@ void worksheet::move_cells(std::uint32_t min_index, std::uint32_t amount, row_or
     {
         std::vector<std::pair<column_t, xlnt::column_properties>> properties_to_move;
 
-        auto col_prop_iter = d_->column_properties_.cbegin();
+        auto col_prop_iter = d_->column_properties_.lower_bound(column_t(reverse ? min_index - amount : min_index));
         while (col_prop_iter != d_->column_properties_.cend())
         {
             auto current_col = col_prop_iter->first.index;
@@ -921,22 +1380,6 @@ void worksheet::move_cells(std::uint32_t min_index, std::uint32_t amount, row_or
     }
 
     // adjust merged cells
-    auto shift_reference = [min_index, amount, row_or_col, reverse](cell_reference &ref) {
-        auto index = row_or_col == row_or_col_t::row ? ref.row() : ref.column_index();
-        if (index >= min_index)
-        {
-            auto new_index = reverse ? index - amount : index + amount;
-            if (row_or_col == row_or_col_t::row)
-            {
-                ref.row(new_index);
-            }
-            else if (row_or_col == row_or_col_t::column)
-            {
-                ref.column_index(new_index);
-            }
-        }
-    };
-
     for (auto merged_cell = d_->merged_cells_.begin(); merged_cell != d_->merged_cells_.end(); ++merged_cell)
     {
         cell_reference new_top_left = merged_cell->top_left();
@@ -967,15 +1410,21 @@ bool worksheet::compare(const worksheet &other, bool reference) const
 
     if (d_->parent_ != other.d_->parent_) return false;
 
-    for (auto &cell : d_->cell_map_)
+    const auto &cells = d_->cells_;
+    const auto &other_cells = other.d_->cells_;
+
+    for (const auto &cell : cells)
     {
-        if (other.d_->cell_map_.find(cell.first) == other.d_->cell_map_.end())
+        auto other_impl = other_cells.find(cell_reference(cell.column_, cell.row_));
+
+        if (other_impl == nullptr)
         {
             return false;
         }
 
-        xlnt::cell this_cell(&cell.second);
-        xlnt::cell other_cell(&other.d_->cell_map_[cell.first]);
+        // only read, so the cells may be shared with copies of the worksheets
+        xlnt::cell this_cell(const_cast<detail::cell_impl *>(&cell), d_);
+        xlnt::cell other_cell(const_cast<detail::cell_impl *>(other_impl), other.d_);
 
         if (this_cell.data_type() != other_cell.data_type())
         {
@@ -1042,7 +1491,7 @@ void worksheet::remove_named_range(const std::string &name)
 
 void worksheet::reserve(std::size_t n)
 {
-    d_->cell_map_.reserve(n);
+    d_->cells_.reserve(n);
 }
 
 class header_footer worksheet::header_footer() const
@@ -1349,7 +1798,7 @@ bool worksheet::has_drawing() const
 
 bool worksheet::is_empty() const
 {
-    return d_->cell_map_.empty();
+    return d_->cells_.empty();
 }
 
 } // namespace xlnt
@@ -0,0 +1,417 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <detail/implementations/cell_store.hpp>
+#include <helpers/test_suite.hpp>
+
+class cell_store_test_suite : public test_suite
+{
+public:
+    cell_store_test_suite()
+    {
+        register_test(test_emplace_find);
+        register_test(test_row_major_order);
+        register_test(test_stable_addresses);
+        register_test(test_erase);
+        register_test(test_copy);
+        register_test(test_copy_on_write);
+        register_test(test_arena);
+        register_test(test_emplace_row);
+        register_test(test_extent);
+        register_test(test_extent_shared_reads);
+        register_test(test_insert_delete_rows);
+        register_test(test_insert_delete_columns);
+    }
+
+    std::vector<std::string> references(const xlnt::detail::cell_store &store)
+    {
+        std::vector<std::string> result;
+
+        for (const auto &cell : store)
+        {
+            result.push_back(xlnt::cell_reference(cell.column_, cell.row_).to_string());
+        }
+
+        return result;
+    }
+
+    void test_emplace_find()
+    {
+        xlnt::detail::cell_store store;
+        xlnt_assert(store.empty());
+        xlnt_assert(store.find("B2") == nullptr);
+
+        auto created = store.emplace("B2");
+        xlnt_assert(created.second);
+        xlnt_assert_equals(created.first->column_, xlnt::column_t("B").index);
+        xlnt_assert_equals(created.first->row_, 2);
+
+        auto existing = store.emplace("B2");
+        xlnt_assert(!existing.second);
+        xlnt_assert_equals(existing.first, created.first);
+        xlnt_assert_equals(store.find("B2"), created.first);
+        xlnt_assert(store.find("B3") == nullptr);
+        xlnt_assert(store.find("C2") == nullptr);
+        xlnt_assert_equals(store.size(), 1);
+    }
+
+    void test_row_major_order()
+    {
+        xlnt::detail::cell_store store;
+
+        for (auto reference : {"C1000000", "B2", "A2", "XFD1", "D300", "A1"})
+        {
+            store.emplace(reference);
+        }
+
+        const auto expected = std::vector<std::string>{"A1", "XFD1", "A2", "B2", "D300", "C1000000"};
+        xlnt_assert(references(store) == expected);
+        xlnt_assert(store.rows() == std::vector<xlnt::row_t>({1, 2, 300, 1000000}));
+        xlnt_assert_equals(store.row(2)->size(), 2);
+        xlnt_assert_equals(store.row(2)->front().column, 1);
+        xlnt_assert(store.row(3) == nullptr);
+    }
+
+    void test_stable_addresses()
+    {
+        xlnt::detail::cell_store store;
+        auto b1 = store.emplace("B1").first;
+        b1->value_numeric_ = 2;
+
+        // inserting before it in the same row and growing the store past a chunk
+        for (xlnt::row_t row = 1; row <= 1000; ++row)
+        {
+            store.emplace(xlnt::cell_reference(1, row)).first->value_numeric_ = row;
+        }
+
+        xlnt_assert_equals(store.find("B1"), b1);
+        xlnt_assert_equals(b1->value_numeric_, 2);
+        xlnt_assert_equals(store.find("A1000")->value_numeric_, 1000);
+        xlnt_assert_equals(store.size(), 1001);
+    }
+
+    void test_erase()
+    {
+        xlnt::detail::cell_store store;
+
+        for (xlnt::row_t row = 1; row <= 10; ++row)
+        {
+            for (xlnt::column_t::index_t column = 1; column <= 3; ++column)
+            {
+                store.emplace(xlnt::cell_reference(column, row));
+            }
+        }
+
+        xlnt_assert(store.erase("B2"));
+        xlnt_assert(!store.erase("B2"));
+        store.erase_row(3);
+        store.erase_if([](xlnt::detail::cell_impl &cell) { return cell.column_ == 3 || cell.row_ > 4; });
+
+        const auto expected = std::vector<std::string>{"A1", "B1", "A2", "A4", "B4"};
+        xlnt_assert(references(store) == expected);
+        xlnt_assert_equals(store.size(), 5);
+
+        // erased cells are reused as new ones
+        xlnt_assert(store.emplace("Z9").first->column_ == xlnt::column_t("Z").index);
+        xlnt_assert(store.find("Z9")->extras_ == nullptr);
+
+        store.clear();
+        xlnt_assert(store.empty());
+        xlnt_assert(store.begin() == store.end());
+    }
+
+    void test_copy()
+    {
+        xlnt::detail::cell_store store;
+        store.emplace("A1").first->value_numeric_ = 1;
+        store.emplace("C3").first->value_numeric_ = 3;
+
+        xlnt::detail::cell_store copy(store);
+        xlnt_assert(copy == store);
+        xlnt_assert(copy.find("A1") != store.find("A1"));
+
+        copy.find("C3")->value_numeric_ = 4;
+        xlnt_assert(!(copy == store));
+        xlnt_assert_equals(store.find("C3")->value_numeric_, 3);
+    }
+
+    void test_copy_on_write()
+    {
+        const auto rows = xlnt::row_t(3 * xlnt::detail::cell_store::block_rows);
+        auto store = std::unique_ptr<xlnt::detail::cell_store>(new xlnt::detail::cell_store());
+
+        for (xlnt::row_t row = 1; row <= rows; ++row)
+        {
+            store->emplace(xlnt::cell_reference(1, row)).first->value_numeric_ = row;
+        }
+
+        auto a1 = store->find("A1");
+        xlnt::detail::cell_store copy(*store);
+        const auto &shared = copy;
+        xlnt_assert(shared.find("A1") == a1);
+
+        // shared cells are never changed, the store changing one gets a copy
+        const auto shared_a1 = a1;
+        a1 = store->detach(a1);
+        xlnt_assert(a1 != shared_a1);
+        a1->value_numeric_ = -1;
+        xlnt_assert_equals(store->find("A1"), a1);
+        xlnt_assert_equals(store->detach(a1), a1);
+        xlnt_assert(shared.find("A1") == shared_a1);
+        xlnt_assert_equals(shared.find("A1")->value_numeric_, 1);
+        xlnt_assert_equals(shared.find("A2")->value_numeric_, 2);
+
+        // each store copies the blocks it changes, the other blocks stay shared
+        copy.find("A300")->value_numeric_ = -300;
+        xlnt_assert_equals(store->find("A300")->value_numeric_, 300);
+        xlnt_assert(shared.find("A600") == static_cast<const xlnt::detail::cell_store &>(*store).find("A600"));
+
+        copy.insert_rows(1, 1);
+        copy.erase("A600");
+        xlnt_assert_equals(store->find("A2")->value_numeric_, 2);
+        xlnt_assert_equals(store->find("A600")->value_numeric_, 600);
+        xlnt_assert_equals(store->size(), rows);
+
+        // shared cells outlive the store they were copied from
+        store.reset();
+        xlnt_assert_equals(copy.size(), rows - 1);
+        xlnt_assert_equals(shared.find("A2")->value_numeric_, 1);
+        xlnt_assert_equals(copy.find("A301")->value_numeric_, -300);
+        xlnt_assert_equals(copy.find("A768")->value_numeric_, 767);
+        xlnt_assert(copy.find("A600") == nullptr);
+        xlnt_assert_equals(copy.extent().max_row, rows + 1);
+    }
+
+    void test_arena()
+    {
+        auto arena = std::make_shared<xlnt::detail::arena>();
+        xlnt::detail::cell_store store;
+        store.use_arena(arena);
+
+        for (xlnt::row_t row = 1; row <= 1000; ++row)
+        {
+            store.emplace(xlnt::cell_reference(1, row)).first->value_numeric_ = row;
+        }
+
+        xlnt_assert_equals(store.size(), 1000);
+        xlnt_assert_equals(store.find("A500")->value_numeric_, 500);
+        xlnt_assert(arena->capacity() > 1000 * sizeof(xlnt::detail::cell_impl));
+
+        // memory given back, e.g. by a growing row, is reused for the same size
+        auto buffer = arena->allocate(256, alignof(xlnt::detail::cell_entry));
+        arena->deallocate(buffer, 256);
+        xlnt_assert_equals(arena->allocate(256, alignof(xlnt::detail::cell_entry)), buffer);
+        xlnt_assert(arena->allocate(128, alignof(xlnt::detail::cell_entry)) != buffer);
+
+        auto extras = store.allocate_extras();
+        xlnt_assert(extras != nullptr);
+        extras->formula = std::string("SUM(A1:A2)");
+        store.release_extras(extras);
+
+        // released extras are reset and reused
+        xlnt_assert_equals(store.allocate_extras(), extras);
+        xlnt_assert(!extras->formula.is_set());
+
+        // cells copied in own their extras until they're adopted
+        xlnt::detail::cell_impl heap_cell;
+        heap_cell.extras().formula = std::string("A1");
+        auto cell = store.find("A1");
+        *cell = heap_cell;
+        xlnt_assert(!cell->pooled_extras_);
+        store.adopt(cell);
+        xlnt_assert(cell->pooled_extras_);
+        xlnt_assert_equals(cell->extras_->formula.get(), "A1");
+
+        // copies don't share the arena
+        xlnt::detail::cell_store copy(store);
+        xlnt_assert(copy == store);
+        xlnt_assert(copy.arena_source() == nullptr);
+        xlnt_assert(!copy.find("A1")->pooled_extras_);
+
+        xlnt::detail::cell_store heap_store;
+        xlnt_assert(heap_store.allocate_extras() == nullptr);
+    }
+
+    void test_emplace_row()
+    {
+        xlnt::detail::cell_store store;
+        auto c2 = store.emplace("C2").first;
+        store.emplace("F2");
+        store.emplace("A2");
+
+        std::vector<xlnt::detail::cell_impl *> cells(3);
+        store.emplace_row(2, 2, cells.size(), cells.data());
+        xlnt_assert_equals(cells[1], c2);
+        xlnt_assert_equals(cells[0], store.find("B2"));
+        xlnt_assert_equals(cells[2], store.find("D2"));
+        xlnt_assert_equals(store.size(), 5);
+
+        store.emplace_row(3, 1, cells.size(), cells.data());
+        xlnt_assert_equals(store.size(), 8);
+
+        const auto expected = std::vector<std::string>{"A2", "B2", "C2", "D2", "F2", "A3", "B3", "C3"};
+        xlnt_assert(references(store) == expected);
+    }
+
+    void test_extent()
+    {
+        xlnt::detail::cell_store store;
+        store.emplace("C3");
+
+        auto extent = store.extent();
+        xlnt_assert_equals(extent.min_row, 3);
+        xlnt_assert_equals(extent.max_row, 3);
+        xlnt_assert_equals(extent.min_column, 3);
+        xlnt_assert_equals(extent.max_column, 3);
+
+        store.emplace("B5");
+        store.emplace("E1");
+        std::vector<xlnt::detail::cell_impl *> cells(4);
+        store.emplace_row(4, 2, cells.size(), cells.data());
+
+        extent = store.extent();
+        xlnt_assert_equals(extent.min_row, 1);
+        xlnt_assert_equals(extent.max_row, 5);
+        xlnt_assert_equals(extent.min_column, 2);
+        xlnt_assert_equals(extent.max_column, 5);
+
+        // erasing cells inside the box keeps it, erasing its edges shrinks it
+        store.erase("C3");
+        xlnt_assert_equals(store.extent().max_column, 5);
+        store.erase("E1");
+        store.erase_row(4);
+
+        extent = store.extent();
+        xlnt_assert_equals(extent.min_row, 5);
+        xlnt_assert_equals(extent.max_row, 5);
+        xlnt_assert_equals(extent.min_column, 2);
+        xlnt_assert_equals(extent.max_column, 2);
+
+        store.emplace("A7");
+        store.erase_if([](const xlnt::detail::cell_impl &cell) { return cell.row_ == 5; });
+
+        extent = store.extent();
+        xlnt_assert_equals(extent.min_row, 7);
+        xlnt_assert_equals(extent.max_column, 1);
+
+        const auto copy = store;
+        xlnt_assert_equals(copy.extent().min_row, 7);
+    }
+
+    void test_extent_shared_reads()
+    {
+        xlnt::detail::cell_store store;
+
+        for (xlnt::row_t row = 1; row <= 1000; ++row)
+        {
+            store.emplace(xlnt::cell_reference(row % 10 + 1, row));
+        }
+
+        store.erase_row(1000);
+
+        // the stale bounds are recomputed by one of the readers
+        const auto &shared = store;
+        std::vector<xlnt::detail::cell_store::bounds> seen(4);
+        std::vector<std::thread> readers;
+
+        for (std::size_t i = 0; i < seen.size(); ++i)
+        {
+            readers.emplace_back([&shared, &seen, i]() { seen[i] = shared.extent(); });
+        }
+
+        for (auto &reader : readers)
+        {
+            reader.join();
+        }
+
+        for (const auto &extent : seen)
+        {
+            xlnt_assert_equals(extent.min_row, 1);
+            xlnt_assert_equals(extent.max_row, 999);
+            xlnt_assert_equals(extent.min_column, 1);
+            xlnt_assert_equals(extent.max_column, 10);
+        }
+    }
+
+    void test_insert_delete_rows()
+    {
+        xlnt::detail::cell_store store;
+
+        // rows on both sides of block boundaries
+        for (auto row : {1u, 2u, 255u, 256u, 257u, 600u})
+        {
+            store.emplace(xlnt::cell_reference(1, row));
+            store.emplace(xlnt::cell_reference(3, row));
+        }
+
+        store.insert_rows(256, 300);
+        xlnt_assert_equals(store.size(), 12);
+        xlnt_assert(store.find("A255") != nullptr);
+        xlnt_assert(store.find("A256") == nullptr);
+        xlnt_assert(store.find("A556") != nullptr);
+        xlnt_assert(store.find("C557") != nullptr);
+        xlnt_assert(store.find("A900") != nullptr);
+        xlnt_assert_equals(store.find("C900")->row_, 900);
+        xlnt_assert_equals(store.extent().max_row, 900);
+
+        store.delete_rows(2, 300);
+        xlnt_assert_equals(store.size(), 8);
+
+        const auto expected = std::vector<std::string>{"A1", "C1", "A256", "C256", "A257", "C257", "A600", "C600"};
+        xlnt_assert(references(store) == expected);
+        xlnt_assert_equals(store.find("A257")->row_, 257);
+        xlnt_assert_equals(store.extent().min_row, 1);
+        xlnt_assert_equals(store.extent().max_row, 600);
+
+        store.delete_rows(1, 1000);
+        xlnt_assert(store.empty());
+    }
+
+    void test_insert_delete_columns()
+    {
+        xlnt::detail::cell_store store;
+        store.emplace("A1");
+        store.emplace("B1");
+        store.emplace("D1");
+        store.emplace("C300");
+
+        store.insert_columns(2, 2);
+        const auto inserted = std::vector<std::string>{"A1", "D1", "F1", "E300"};
+        xlnt_assert(references(store) == inserted);
+        xlnt_assert_equals(store.find("F1")->column_, 6);
+        xlnt_assert_equals(store.extent().max_column, 6);
+
+        store.delete_columns(1, 4);
+        const auto deleted = std::vector<std::string>{"B1", "A300"};
+        xlnt_assert(references(store) == deleted);
+        xlnt_assert_equals(store.extent().min_column, 1);
+        xlnt_assert_equals(store.extent().max_column, 2);
+    }
+};
+
+static cell_store_test_suite x;
@@ -0,0 +1,143 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <detail/implementations/format_table.hpp>
+#include <helpers/test_suite.hpp>
+
+class format_table_test_suite : public test_suite
+{
+public:
+    format_table_test_suite()
+    {
+        register_test(test_push_back_at);
+        register_test(test_find);
+        register_test(test_modify);
+        register_test(test_erase_unreferenced);
+        register_test(test_copy);
+    }
+
+    xlnt::detail::format_impl make_format(std::size_t font_id)
+    {
+        xlnt::detail::format_impl impl;
+        impl.parent = nullptr;
+        impl.font_id = font_id;
+        impl.font_applied = true;
+
+        return impl;
+    }
+
+    void test_push_back_at()
+    {
+        xlnt::detail::format_table table;
+
+        auto &first = table.push_back(make_format(0));
+        auto &second = table.push_back(make_format(1));
+
+        xlnt_assert_equals(table.size(), 2);
+        xlnt_assert_equals(first.id, 0);
+        xlnt_assert_equals(second.id, 1);
+        xlnt_assert_equals(&table.at(1), &second);
+        xlnt_assert_throws(table.at(2), xlnt::invalid_parameter);
+
+        // adding formats doesn't move the others
+        for (std::size_t i = 2; i < 1000; ++i)
+        {
+            table.push_back(make_format(i));
+        }
+
+        xlnt_assert_equals(&table.at(0), &first);
+    }
+
+    void test_find()
+    {
+        xlnt::detail::format_table table;
+
+        for (std::size_t i = 0; i < 100; ++i)
+        {
+            table.push_back(make_format(i));
+        }
+
+        // equal formats are found by their content, the first one wins
+        table.push_back(make_format(42));
+        xlnt_assert_equals(table.find(make_format(42)), &table.at(42));
+        xlnt_assert_equals(table.find(make_format(100)), nullptr);
+
+        auto pattern = make_format(7);
+        pattern.references = 5;
+        pattern.id = 99;
+        xlnt_assert_equals(table.find(pattern), &table.at(7));
+
+        pattern.quote_prefix_ = true;
+        xlnt_assert_equals(table.find(pattern), nullptr);
+    }
+
+    void test_modify()
+    {
+        xlnt::detail::format_table table;
+        auto &impl = table.push_back(make_format(0));
+
+        table.modify(impl, [](xlnt::detail::format_impl &changed) { changed.style = std::string("Heading 1"); });
+
+        auto pattern = make_format(0);
+        xlnt_assert_equals(table.find(pattern), nullptr);
+        pattern.style = std::string("Heading 1");
+        xlnt_assert_equals(table.find(pattern), &impl);
+    }
+
+    void test_erase_unreferenced()
+    {
+        xlnt::detail::format_table table;
+
+        for (std::size_t i = 0; i < 10; ++i)
+        {
+            table.push_back(make_format(i)).references = i % 2;
+        }
+
+        auto &kept = table.at(5);
+        table.erase_unreferenced();
+
+        xlnt_assert_equals(table.size(), 5);
+        xlnt_assert_equals(&table.at(2), &kept);
+        xlnt_assert_equals(kept.id, 2);
+        xlnt_assert_equals(table.find(make_format(5)), &kept);
+        xlnt_assert_equals(table.find(make_format(4)), nullptr);
+    }
+
+    void test_copy()
+    {
+        xlnt::detail::format_table table;
+        table.push_back(make_format(0));
+        table.push_back(make_format(1));
+
+        auto copy = table;
+        xlnt_assert(copy == table);
+        xlnt_assert_differs(&copy.at(1), &table.at(1));
+        xlnt_assert_equals(copy.find(make_format(1)), &copy.at(1));
+
+        copy.modify(copy.at(1), [](xlnt::detail::format_impl &changed) { changed.pivot_button_ = true; });
+        xlnt_assert(!(copy == table));
+        xlnt_assert_equals(table.find(make_format(1)), &table.at(1));
+    }
+};
+
+static format_table_test_suite x;
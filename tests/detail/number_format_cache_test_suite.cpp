@@ -0,0 +1,113 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <detail/number_format/number_format_cache.hpp>
+#include <detail/number_format/number_formatter.hpp>
+#include <helpers/test_suite.hpp>
+#include <xlnt/styles/number_format.hpp>
+
+class number_format_cache_test_suite : public test_suite
+{
+public:
+    number_format_cache_test_suite()
+    {
+        register_test(test_get);
+        register_test(test_clear);
+        register_test(test_clear_shared_reads);
+    }
+
+    std::string format(std::shared_ptr<const xlnt::detail::compiled_number_format> compiled, double number)
+    {
+        return xlnt::detail::number_formatter(compiled, xlnt::calendar::windows_1900).format_number(number);
+    }
+
+    void test_get()
+    {
+        xlnt::detail::number_format_cache cache;
+        const auto percent = cache.get(xlnt::number_format::percentage());
+        xlnt_assert_equals(cache.get(xlnt::number_format::percentage()), percent);
+        xlnt_assert_equals(format(percent, 0.5), "50%");
+
+        // an id given another format string compiles that one
+        const auto reused = cache.get(xlnt::number_format("0.0%", 9));
+        xlnt_assert_equals(format(reused, 0.5), "50.0%");
+        xlnt_assert_equals(cache.get(xlnt::number_format::percentage()), percent);
+
+        const auto no_id = cache.get(xlnt::number_format("0.000"));
+        xlnt_assert_equals(cache.get(xlnt::number_format("0.000")), no_id);
+    }
+
+    void test_clear()
+    {
+        xlnt::detail::number_format_cache cache;
+        const auto percent = cache.get(xlnt::number_format::percentage());
+        const auto no_id = cache.get(xlnt::number_format("0.000"));
+        cache.clear();
+
+        // published formats stay valid, the others are owned by the result
+        xlnt_assert_equals(format(percent, 0.5), "50%");
+        xlnt_assert_equals(format(no_id, 1.0), "1.000");
+        xlnt_assert_equals(cache.get(xlnt::number_format::percentage()), percent);
+        xlnt_assert_differs(cache.get(xlnt::number_format("0.000")), no_id);
+    }
+
+    void test_clear_shared_reads()
+    {
+        // formats found without the lock are still in use when the cache is
+        // cleared on another thread
+        xlnt::detail::number_format_cache cache;
+        std::vector<int> failures(3, 0);
+        std::vector<std::thread> threads;
+
+        for (std::size_t i = 0; i < failures.size(); ++i)
+        {
+            threads.emplace_back([this, &cache, &failures, i]() {
+                for (int j = 0; j < 2000; ++j)
+                {
+                    failures[i] += format(cache.get(xlnt::number_format::percentage()), 0.25) != "25%";
+                }
+            });
+        }
+
+        for (int j = 0; j < 2000; ++j)
+        {
+            cache.clear();
+        }
+
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        for (auto failed : failures)
+        {
+            xlnt_assert_equals(failed, 0);
+        }
+    }
+};
+
+static number_format_cache_test_suite x;
@@ -0,0 +1,162 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <string>
+#include <vector>
+
+#include <detail/implementations/shared_string_pool.hpp>
+#include <helpers/test_suite.hpp>
+#include <xlnt/styles/font.hpp>
+
+class shared_string_pool_test_suite : public test_suite
+{
+public:
+    shared_string_pool_test_suite()
+    {
+        register_test(test_add_find);
+        register_test(test_plain_and_rich);
+        register_test(test_duplicates);
+        register_test(test_many_strings);
+        register_test(test_modifiable_values);
+        register_test(test_equality);
+    }
+
+    void test_add_find()
+    {
+        xlnt::detail::shared_string_pool pool;
+        const std::string text = "some text";
+
+        xlnt_assert_equals(pool.find(text.data(), text.size()), 0);
+        xlnt_assert_equals(pool.add(text.data(), text.size(), false, false), 0);
+        xlnt_assert_equals(pool.add(xlnt::rich_text("other text"), false), 1);
+        xlnt_assert_equals(pool.add(xlnt::rich_text(text), false), 0);
+        xlnt_assert_equals(pool.size(), 2);
+
+        xlnt_assert_equals(pool.find(text.data(), text.size()), 0);
+        xlnt_assert_equals(pool.find(xlnt::rich_text("other text")), 1);
+        xlnt_assert_equals(pool.find(text.data(), 4), 2);
+        xlnt_assert_equals(pool.plain_text(1), "other text");
+        xlnt_assert_equals(pool.value(0), xlnt::rich_text(text));
+    }
+
+    void test_plain_and_rich()
+    {
+        xlnt::detail::shared_string_pool pool;
+
+        xlnt::rich_text bold;
+        bold.add_run(xlnt::rich_text_run{"bold", xlnt::font().bold(true), false});
+        bold.add_run(xlnt::rich_text_run{" text", xlnt::optional<xlnt::font>(), true});
+
+        pool.add(" spaced ", 8, true, false);
+        pool.add(bold, false);
+
+        xlnt_assert(pool.is_plain(0));
+        xlnt_assert(pool.preserve_space(0));
+        xlnt_assert_equals(pool.value(0).runs().front().preserve_space, true);
+
+        xlnt_assert(!pool.is_plain(1));
+        xlnt_assert_equals(pool.rich(1), bold);
+        xlnt_assert_equals(pool.plain_text(1), "bold text");
+
+        // same text, but only the rich string has formatting
+        xlnt_assert_equals(pool.find("bold text", 9), 2);
+        xlnt_assert_equals(pool.add(xlnt::rich_text("bold text"), false), 2);
+        xlnt_assert_equals(pool.find(bold), 1);
+    }
+
+    void test_duplicates()
+    {
+        xlnt::detail::shared_string_pool pool;
+
+        xlnt_assert_equals(pool.add(xlnt::rich_text("a"), true), 0);
+        xlnt_assert_equals(pool.add(xlnt::rich_text("b"), true), 1);
+        xlnt_assert_equals(pool.add(xlnt::rich_text("a"), true), 2);
+        xlnt_assert_equals(pool.size(), 3);
+
+        // the first of equal strings is found
+        xlnt_assert_equals(pool.find(xlnt::rich_text("a")), 0);
+        xlnt_assert_equals(pool.add(xlnt::rich_text("a"), false), 0);
+        xlnt_assert_equals(pool.add(xlnt::rich_text("c"), false), 3);
+        xlnt_assert_equals(pool.plain_text(3), "c");
+    }
+
+    void test_many_strings()
+    {
+        xlnt::detail::shared_string_pool pool;
+
+        for (int i = 0; i < 10000; ++i)
+        {
+            const auto text = "string " + std::to_string(i);
+            xlnt_assert_equals(pool.add(text.data(), text.size(), false, false), i);
+        }
+
+        for (int i = 0; i < 10000; ++i)
+        {
+            const auto text = "string " + std::to_string(i);
+            xlnt_assert_equals(pool.find(text.data(), text.size()), i);
+            xlnt_assert_equals(pool.plain_text(static_cast<std::size_t>(i)), text);
+        }
+
+        xlnt_assert_equals(pool.values().size(), 10000);
+        xlnt_assert_equals(pool.values()[1234], xlnt::rich_text("string 1234"));
+    }
+
+    void test_modifiable_values()
+    {
+        xlnt::detail::shared_string_pool pool;
+        pool.add(xlnt::rich_text("a"), false);
+        pool.add(xlnt::rich_text("b"), false);
+
+        auto &values = pool.modifiable_values();
+        xlnt_assert_equals(values.size(), 2);
+        values[1] = xlnt::rich_text("changed");
+        values.push_back(xlnt::rich_text("pushed"));
+
+        xlnt_assert_equals(pool.size(), 3);
+        xlnt_assert(!pool.is_plain(0));
+        xlnt_assert_equals(pool.plain_text(1), "changed");
+        xlnt_assert_equals(pool.value(2), xlnt::rich_text("pushed"));
+        xlnt_assert_equals(pool.find("a", 1), 0);
+        xlnt_assert_equals(pool.add("new", 3, false, false), 3);
+        xlnt_assert_equals(pool.add(xlnt::rich_text("new"), false), 3);
+        xlnt_assert_equals(&pool.values(), &values);
+    }
+
+    void test_equality()
+    {
+        xlnt::detail::shared_string_pool pool;
+        pool.add(xlnt::rich_text("a"), false);
+        pool.add(xlnt::rich_text("b", xlnt::font().italic(true)), false);
+
+        auto copy = pool;
+        xlnt_assert(copy == pool);
+
+        copy.modifiable_values();
+        xlnt_assert(copy == pool);
+
+        copy.add(xlnt::rich_text("c"), false);
+        xlnt_assert(!(copy == pool));
+    }
+};
+
+static shared_string_pool_test_suite x;
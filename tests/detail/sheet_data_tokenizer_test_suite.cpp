@@ -0,0 +1,296 @@
+// Copyright (c) 2014-2021 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <sstream>
+#include <string>
+
+#include <detail/serialization/sheet_data_tokenizer.hpp>
+#include <helpers/test_suite.hpp>
+#include <xlnt/utils/exceptions.hpp>
+
+class sheet_data_tokenizer_test_suite : public test_suite
+{
+public:
+    sheet_data_tokenizer_test_suite()
+    {
+        register_test(test_split_around_sheet_data);
+        register_test(test_no_sheet_data);
+        register_test(test_empty_sheet_data);
+        register_test(test_attributes);
+        register_test(test_entities_and_cdata);
+        register_test(test_small_buffer_reads);
+        register_test(test_unknown_entity);
+        register_test(test_non_utf8_falls_back);
+        register_test(test_skip_element);
+        register_test(test_skip_sheet_data);
+    }
+
+    void test_split_around_sheet_data()
+    {
+        std::istringstream part(
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+            "<worksheet xmlns=\"ns\"><dimension ref=\"A1\"/>"
+            "<sheetData><row r=\"1\"><c r=\"A1\"><v>1</v></c></row></sheetData>"
+            "<mergeCells count=\"0\"/></worksheet>");
+        xlnt::detail::sheet_data_tokenizer tokenizer(part);
+        std::string document;
+
+        xlnt_assert(tokenizer.read_to_sheet_data(document));
+        xlnt_assert_equals(document,
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+            "<worksheet xmlns=\"ns\"><dimension ref=\"A1\"/><sheetData/>");
+
+        using event = xlnt::detail::sheet_data_tokenizer::event;
+        xlnt_assert(tokenizer.next() == event::start_element);
+        xlnt_assert(tokenizer.name() == "row");
+        xlnt_assert(tokenizer.next() == event::start_element);
+        xlnt_assert(tokenizer.name() == "c");
+        xlnt_assert(tokenizer.next() == event::start_element);
+        xlnt_assert(tokenizer.name() == "v");
+        xlnt_assert(tokenizer.next() == event::characters);
+        xlnt_assert(tokenizer.value() == "1");
+        xlnt_assert(tokenizer.name() == "v");
+        xlnt_assert(tokenizer.next() == event::end_element);
+        xlnt_assert(tokenizer.next() == event::end_element);
+        xlnt_assert(tokenizer.name() == "c");
+        xlnt_assert(tokenizer.next() == event::end_element);
+        xlnt_assert(tokenizer.name() == "row");
+        xlnt_assert(tokenizer.next() == event::end_of_sheet_data);
+
+        tokenizer.read_remainder(document);
+        xlnt_assert_equals(document,
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+            "<worksheet xmlns=\"ns\"><dimension ref=\"A1\"/><sheetData/>"
+            "<mergeCells count=\"0\"/></worksheet>");
+    }
+
+    void test_no_sheet_data()
+    {
+        const std::string xml = "<worksheet><dimension ref=\"A1\"/></worksheet>";
+        std::istringstream part(xml);
+        xlnt::detail::sheet_data_tokenizer tokenizer(part);
+        std::string document;
+
+        xlnt_assert(!tokenizer.read_to_sheet_data(document));
+        tokenizer.read_remainder(document);
+        xlnt_assert_equals(document, xml);
+    }
+
+    void test_empty_sheet_data()
+    {
+        const std::string xml = "<worksheet><sheetData /></worksheet>";
+        std::istringstream part(xml);
+        xlnt::detail::sheet_data_tokenizer tokenizer(part);
+        std::string document;
+
+        xlnt_assert(!tokenizer.read_to_sheet_data(document));
+        tokenizer.read_remainder(document);
+        xlnt_assert_equals(document, xml);
+    }
+
+    void test_attributes()
+    {
+        std::istringstream part(
+            "<x:worksheet xmlns:x=\"ns\"><x:sheetData>"
+            "<x:row r=\"12\" spans='1:2' ht = \"15.5\"><x:c r=\"AB12\" t=\"s\"/></x:row>"
+            "</x:sheetData></x:worksheet>");
+        xlnt::detail::sheet_data_tokenizer tokenizer(part);
+        std::string document;
+        xlnt_assert(tokenizer.read_to_sheet_data(document));
+
+        using event = xlnt::detail::sheet_data_tokenizer::event;
+        xlnt_assert(tokenizer.next() == event::start_element);
+        xlnt_assert(tokenizer.name() == "row");
+        xlnt_assert_equals(tokenizer.attributes().size(), 3);
+        xlnt_assert(tokenizer.attribute_value("r") == "12");
+        xlnt_assert(tokenizer.attribute_value("spans") == "1:2");
+        xlnt_assert(tokenizer.attribute_value("ht") == "15.5");
+        xlnt_assert(!tokenizer.attribute_present("hidden"));
+        xlnt_assert(tokenizer.attribute_value("hidden").empty());
+
+        xlnt_assert(tokenizer.next() == event::start_element);
+        xlnt_assert(tokenizer.name() == "c");
+        xlnt_assert(tokenizer.attribute_value("r") == "AB12");
+        xlnt_assert(tokenizer.attribute_value("t") == "s");
+        xlnt_assert(tokenizer.next() == event::end_element);
+        xlnt_assert(tokenizer.name() == "c");
+        xlnt_assert(tokenizer.next() == event::end_element);
+        xlnt_assert(tokenizer.next() == event::end_of_sheet_data);
+    }
+
+    void test_entities_and_cdata()
+    {
+        std::istringstream part(
+            "<worksheet><sheetData><row><c t=\"inlineStr\" x=\"&quot;a&amp;b&quot;\"><is><t>"
+            "&lt;&#65;&#x3bb;&gt;<!-- skipped --><![CDATA[<&>]]>\r\n&apos;"
+            "</t></is></c></row></sheetData></worksheet>");
+        xlnt::detail::sheet_data_tokenizer tokenizer(part);
+        std::string document;
+        xlnt_assert(tokenizer.read_to_sheet_data(document));
+
+        using event = xlnt::detail::sheet_data_tokenizer::event;
+        std::string text;
+        auto e = tokenizer.next();
+
+        while (e != event::end_of_sheet_data)
+        {
+            if (e == event::start_element && tokenizer.name() == "c")
+            {
+                xlnt_assert(tokenizer.attribute_value("x") == "\"a&b\"");
+            }
+            else if (e == event::characters)
+            {
+                text.append(tokenizer.value().data, tokenizer.value().size);
+            }
+
+            e = tokenizer.next();
+        }
+
+        xlnt_assert_equals(text, "<A\xce\xbb><&>\n'");
+    }
+
+    void test_small_buffer_reads()
+    {
+        // enough rows to move through the buffer several times
+        std::string xml = "<worksheet><sheetData>";
+
+        for (int row = 1; row <= 20000; ++row)
+        {
+            xml.append("<row r=\"" + std::to_string(row) + "\"><c r=\"A" + std::to_string(row)
+                + "\"><v>" + std::to_string(row * 3) + "</v></c></row>");
+        }
+
+        xml.append("</sheetData><tail/></worksheet>");
+
+        std::istringstream part(xml);
+        xlnt::detail::sheet_data_tokenizer tokenizer(part);
+        std::string document;
+        xlnt_assert(tokenizer.read_to_sheet_data(document));
+
+        using event = xlnt::detail::sheet_data_tokenizer::event;
+        long sum = 0;
+        int rows = 0;
+        auto e = tokenizer.next();
+
+        while (e != event::end_of_sheet_data)
+        {
+            if (e == event::start_element && tokenizer.name() == "row")
+            {
+                ++rows;
+                xlnt_assert_equals(std::stol(tokenizer.attribute_value("r").to_string()), rows);
+            }
+            else if (e == event::characters)
+            {
+                sum += std::stol(tokenizer.value().to_string());
+            }
+
+            e = tokenizer.next();
+        }
+
+        xlnt_assert_equals(rows, 20000);
+        xlnt_assert_equals(sum, 3L * 20000 * 20001 / 2);
+
+        tokenizer.read_remainder(document);
+        xlnt_assert_equals(document, "<worksheet><sheetData/><tail/></worksheet>");
+    }
+
+    void test_unknown_entity()
+    {
+        std::istringstream part("<worksheet><sheetData><row><c><v>&nbsp;</v></c></row></sheetData></worksheet>");
+        xlnt::detail::sheet_data_tokenizer tokenizer(part);
+        std::string document;
+        xlnt_assert(tokenizer.read_to_sheet_data(document));
+
+        using event = xlnt::detail::sheet_data_tokenizer::event;
+        xlnt_assert(tokenizer.next() == event::start_element);
+        xlnt_assert(tokenizer.next() == event::start_element);
+        xlnt_assert(tokenizer.next() == event::start_element);
+        xlnt_assert_throws(tokenizer.next(), xlnt::exception);
+    }
+
+    void test_non_utf8_falls_back()
+    {
+        const std::string xml = "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?><worksheet><sheetData><row/></sheetData></worksheet>";
+        std::istringstream part(xml);
+        xlnt::detail::sheet_data_tokenizer tokenizer(part);
+        std::string document;
+
+        xlnt_assert(!tokenizer.read_to_sheet_data(document));
+        tokenizer.read_remainder(document);
+        xlnt_assert_equals(document, xml);
+    }
+
+    void test_skip_element()
+    {
+        std::istringstream part(
+            "<worksheet><sheetData>"
+            "<row r=\"1\"><c r=\"A1\"><v>1</v></c><c r=\"B1\"/><!-- <c> --><c r=\"C1\"><is><t><![CDATA[</c>]]></t></is></c></row>"
+            "<row r=\"2\"><c r=\"A2\"><v>2</v></c></row>"
+            "</sheetData></worksheet>");
+        xlnt::detail::sheet_data_tokenizer tokenizer(part);
+        std::string document;
+
+        using event = xlnt::detail::sheet_data_tokenizer::event;
+        xlnt_assert(tokenizer.read_to_sheet_data(document));
+        xlnt_assert(tokenizer.next() == event::start_element);
+        xlnt_assert(tokenizer.next() == event::start_element);
+        xlnt_assert(tokenizer.attribute_value("r") == "A1");
+        tokenizer.skip_element();
+        xlnt_assert(tokenizer.next() == event::start_element);
+        xlnt_assert(tokenizer.attribute_value("r") == "B1");
+        tokenizer.skip_element();
+        xlnt_assert(tokenizer.next() == event::start_element);
+        xlnt_assert(tokenizer.attribute_value("r") == "C1");
+        tokenizer.skip_element();
+        xlnt_assert(tokenizer.next() == event::end_element);
+        xlnt_assert(tokenizer.name() == "row");
+        xlnt_assert(tokenizer.next() == event::start_element);
+        xlnt_assert(tokenizer.attribute_value("r") == "2");
+        tokenizer.skip_element();
+        xlnt_assert(tokenizer.next() == event::end_of_sheet_data);
+
+        tokenizer.read_remainder(document);
+        xlnt_assert_equals(document, "<worksheet><sheetData/></worksheet>");
+    }
+
+    void test_skip_sheet_data()
+    {
+        std::istringstream part(
+            "<worksheet><sheetData>"
+            "<row r=\"1\"><c r=\"A1\"><v>1</v></c></row>"
+            "<row r=\"2\"><c r=\"A2\"><v>2</v></c></row>"
+            "</sheetData><mergeCells count=\"0\"/></worksheet>");
+        xlnt::detail::sheet_data_tokenizer tokenizer(part);
+        std::string document;
+
+        using event = xlnt::detail::sheet_data_tokenizer::event;
+        xlnt_assert(tokenizer.read_to_sheet_data(document));
+        xlnt_assert(tokenizer.next() == event::start_element);
+        xlnt_assert(tokenizer.next() == event::start_element);
+        tokenizer.skip_sheet_data();
+
+        tokenizer.read_remainder(document);
+        xlnt_assert_equals(document, "<worksheet><sheetData/><mergeCells count=\"0\"/></worksheet>");
+    }
+};
+static sheet_data_tokenizer_test_suite x;
@@ -34,6 +34,7 @@ public:
     {
         register_test(test_known_colors);
         register_test(test_non_rgb_colors);
+        register_test(test_hash);
     }
 
     void test_known_colors()
@@ -74,5 +75,18 @@ public:
         xlnt_assert_throws(theme.indexed(), xlnt::invalid_attribute);
         xlnt_assert_throws(theme.rgb(), xlnt::invalid_attribute);
     }
+
+    void test_hash()
+    {
+        std::hash<xlnt::color> hash;
+
+        xlnt_assert_equals(hash(xlnt::color::red()), hash(xlnt::rgb_color("FFFF0000")));
+        xlnt_assert_differs(hash(xlnt::color::red()), hash(xlnt::color::darkred()));
+        xlnt_assert_differs(hash(xlnt::indexed_color(1)), hash(xlnt::theme_color(1)));
+
+        xlnt::color tinted = xlnt::theme_color(1);
+        tinted.tint(0.5);
+        xlnt_assert_differs(hash(tinted), hash(xlnt::theme_color(1)));
+    }
 };
 static color_test_suite x;
@@ -38,6 +38,7 @@ public:
         register_test(test_properties);
         register_test(test_comparison);
         register_test(test_two_fills);
+        register_test(test_hash);
     }
 
     void test_properties()
@@ -105,5 +106,27 @@ public:
         xlnt_assert_equals(cell1.fill(), xlnt::fill::solid(xlnt::color::yellow()));
         xlnt_assert_equals(cell2.fill(), xlnt::fill::solid(xlnt::color::green()));
     }
+
+    void test_hash()
+    {
+        std::hash<xlnt::fill> hash;
+
+        xlnt_assert_equals(hash(xlnt::fill::solid(xlnt::color::yellow())), hash(xlnt::fill::solid(xlnt::rgb_color("FFFFFF00"))));
+        xlnt_assert_differs(hash(xlnt::fill::solid(xlnt::color::yellow())), hash(xlnt::fill::solid(xlnt::color::green())));
+        xlnt_assert_differs(hash(xlnt::gradient_fill().type(xlnt::gradient_fill_type::linear)),
+            hash(xlnt::gradient_fill().type(xlnt::gradient_fill_type::path)));
+
+        // equal fills are found through their hash
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (xlnt::row_t row = 1; row <= 100; ++row)
+        {
+            ws.cell(1, row).fill(xlnt::fill::solid(row % 2 == 0 ? xlnt::color::yellow() : xlnt::color::green()));
+        }
+
+        xlnt_assert_equals(ws.cell("A2").fill(), xlnt::fill::solid(xlnt::color::yellow()));
+        xlnt_assert_equals(ws.cell("A1").fill(), xlnt::fill::solid(xlnt::color::green()));
+    }
 };
 static fill_test_suite x;
@@ -22,6 +22,8 @@
 // @author: see AUTHORS file
 
 #include <iostream>
+#include <thread>
+#include <vector>
 
 #include <helpers/test_suite.hpp>
 
@@ -115,6 +117,8 @@ public:
         register_test(test_builtin_format_date_dmyminus);
         register_test(test_builtin_format_date_dmminus);
         register_test(test_builtin_format_date_myminus);
+        register_test(test_compiled_formats);
+        register_test(test_compiled_formats_shared);
     }
 
     void test_basic()
@@ -1032,5 +1036,58 @@ public:
     {
         format_and_test(xlnt::number_format::date_myminus(), {{"5-16", "###########", "1-00", "text"}});
     }
+
+    void test_compiled_formats()
+    {
+        // formats are compiled once by id, but not confused when an id is reused
+        xlnt::number_format one_place("0.0", 164);
+        xlnt::number_format two_places("0.00", 164);
+        xlnt_assert_equals(one_place.format(1.234, xlnt::calendar::windows_1900), "1.2");
+        xlnt_assert_equals(two_places.format(1.234, xlnt::calendar::windows_1900), "1.23");
+        xlnt_assert_equals(one_place.format(1.234, xlnt::calendar::windows_1900), "1.2");
+
+        xlnt::number_format no_id("0.000");
+        xlnt_assert_equals(no_id.format(1.0, xlnt::calendar::windows_1900), "1.000");
+        no_id.format_string("0%");
+        xlnt_assert_equals(no_id.format(0.5, xlnt::calendar::windows_1900), "50%");
+
+        // invalid formats aren't cached
+        xlnt::number_format invalid("[x]", 165);
+        xlnt_assert_throws(invalid.format(1.0, xlnt::calendar::windows_1900), std::runtime_error);
+        xlnt_assert_throws(invalid.format(1.0, xlnt::calendar::windows_1900), std::runtime_error);
+    }
+
+    void test_compiled_formats_shared()
+    {
+        // the first thread to use the format compiles it, the others find it
+        xlnt::number_format percent("0.0%", 200);
+        std::vector<std::string> results(4);
+        std::vector<std::thread> threads;
+
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            threads.emplace_back([&percent, &results, i]() {
+                for (int j = 0; j < 100; ++j)
+                {
+                    results[i] = percent.format(0.1234, xlnt::calendar::windows_1900);
+                }
+            });
+        }
+
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        for (const auto &result : results)
+        {
+            xlnt_assert_equals(result, "12.3%");
+        }
+
+        // another format with the same id isn't confused with the published one
+        xlnt::number_format other("0%", 200);
+        xlnt_assert_equals(other.format(0.1234, xlnt::calendar::windows_1900), "12%");
+        xlnt_assert_equals(percent.format(0.1234, xlnt::calendar::windows_1900), "12.3%");
+    }
 };
 static number_format_test_suite x;
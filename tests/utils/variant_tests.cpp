@@ -32,6 +32,7 @@ public:
     {
         register_test(test_null);
         register_test(test_int32);
+        register_test(test_double);
         register_test(test_string);
     }
 
@@ -51,6 +52,16 @@ public:
         xlnt_assert_equals(10, var_int.get<std::int32_t>());
     }
 
+    void test_double()
+    {
+        xlnt::variant var_double(2.5);
+        xlnt_assert_equals(var_double.value_type(), xlnt::variant::type::r8);
+        xlnt_assert(var_double.is(xlnt::variant::type::r8));
+        xlnt_assert_equals(2.5, var_double.get<double>());
+        xlnt_assert(var_double == xlnt::variant(2.5));
+        xlnt_assert(!(var_double == xlnt::variant(3.5)));
+    }
+
     void test_string()
     {
         xlnt::variant var_str1("test1");
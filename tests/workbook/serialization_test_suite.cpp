@@ -21,7 +21,10 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <fstream>
 #include <iostream>
+#include <regex>
+#include <thread>
 
 #include <xlnt/xlnt.hpp>
 #include <helpers/path_helper.hpp>
@@ -50,6 +53,7 @@ public:
         register_test(test_read_formulae);
         register_test(test_read_headers_and_footers);
         register_test(test_read_custom_properties);
+        register_test(test_round_trip_double_custom_property);
         register_test(test_read_custom_heights_widths);
         register_test(test_write_custom_heights_widths);
         register_test(test_round_trip_rw_minimal);
@@ -73,6 +77,21 @@ public:
         register_test(test_Issue503_external_link_load);
         register_test(test_formatting);
         register_test(test_active_sheet);
+        register_test(test_load_worksheets_concurrently);
+        register_test(test_load_sheet_data_in_batches);
+        register_test(test_load_selected_sheets);
+        register_test(test_load_skipping_parts);
+        register_test(test_load_selected_sheets_content_types);
+        register_test(test_load_values_only);
+        register_test(test_load_projection);
+        register_test(test_load_projection_implicit_references);
+        register_test(test_streaming_read_projection);
+        register_test(test_streaming_read_ahead);
+        register_test(test_load_lazy_worksheets);
+        register_test(test_load_lazy_worksheets_copies_and_threads);
+        register_test(test_load_from_memory);
+        register_test(test_load_prefetch);
+        register_test(test_load_cell_arena);
     }
 
     bool workbook_matches_file(xlnt::workbook &wb, const xlnt::path &file)
@@ -478,6 +497,18 @@ public:
         xlnt_assert_equals(wb.custom_property("Client").get<std::string>(), "me!");
     }
 
+    void test_round_trip_double_custom_property()
+    {
+        xlnt::workbook wb;
+        wb.custom_property("Ratio", xlnt::variant(0.25));
+        std::vector<std::uint8_t> data;
+        wb.save(data);
+        xlnt::workbook reloaded;
+        reloaded.load(data);
+        xlnt_assert(reloaded.custom_property("Ratio").is(xlnt::variant::type::r8));
+        xlnt_assert_equals(reloaded.custom_property("Ratio").get<double>(), 0.25);
+    }
+
     void test_read_custom_heights_widths()
     {
         xlnt::workbook wb;
@@ -808,6 +839,539 @@ public:
         wb.load(path_helper::test_file("20_active_sheet.xlsx"));
         xlnt_assert_equals(wb.active_sheet(), wb[2]);
     }
+
+    void test_load_worksheets_concurrently()
+    {
+        const auto files = {
+            "10_comments_hyperlinks_formulae.xlsx",
+            "14_images.xlsx",
+            "19_defined_names.xlsx",
+            "20_active_sheet.xlsx",
+            "4_every_style.xlsx"};
+
+        for (auto file : files)
+        {
+            xlnt::workbook serial;
+            serial.load(path_helper::test_file(file));
+
+            xlnt::workbook concurrent;
+            concurrent.load(path_helper::test_file(file), xlnt::load_options().worker_threads(4));
+
+            std::vector<std::uint8_t> serial_bytes;
+            serial.save(serial_bytes);
+            std::vector<std::uint8_t> concurrent_bytes;
+            concurrent.save(concurrent_bytes);
+
+            xlnt_assert(concurrent_bytes == serial_bytes);
+            xlnt_assert_equals(concurrent.active_sheet().title(), serial.active_sheet().title());
+        }
+    }
+
+    void test_load_sheet_data_in_batches()
+    {
+        // enough cells for sheetData to be parsed and constructed in several batches
+        const auto rows = xlnt::row_t(5000);
+
+        xlnt::workbook original;
+        auto ws = original.active_sheet();
+
+        for (auto row = xlnt::row_t(1); row <= rows; ++row)
+        {
+            ws.cell(1, row).value(static_cast<double>(row) / 4);
+            ws.cell(2, row).value("row " + std::to_string(row));
+            ws.cell(3, row).formula("A" + std::to_string(row) + "*2");
+        }
+
+        std::vector<std::uint8_t> bytes;
+        original.save(bytes);
+
+        xlnt::workbook loaded;
+        loaded.load(bytes);
+        auto loaded_ws = loaded.active_sheet();
+
+        xlnt_assert_equals(loaded_ws.highest_row(), rows);
+
+        for (auto row = xlnt::row_t(1); row <= rows; ++row)
+        {
+            xlnt_assert_equals(loaded_ws.cell(1, row).value<double>(), static_cast<double>(row) / 4);
+            xlnt_assert_equals(loaded_ws.cell(2, row).value<std::string>(), "row " + std::to_string(row));
+            xlnt_assert_equals(loaded_ws.cell(3, row).formula(), "A" + std::to_string(row) + "*2");
+        }
+    }
+
+    void test_load_selected_sheets()
+    {
+        const auto file = path_helper::test_file("20_active_sheet.xlsx");
+
+        xlnt::workbook by_title;
+        by_title.load(file, xlnt::load_options().sheet_titles({"Sheet2"}));
+        xlnt_assert_equals(by_title.sheet_count(), 1);
+        xlnt_assert_equals(by_title.active_sheet().title(), "Sheet2");
+
+        xlnt::workbook by_index;
+        by_index.load(file, xlnt::load_options().sheet_indices({0, 3}));
+        xlnt_assert_equals(by_index.sheet_count(), 2);
+        xlnt_assert_equals(by_index[0].title(), "Sheet");
+        xlnt_assert_equals(by_index[1].title(), "Sheet3");
+        xlnt_assert_equals(by_index.active_sheet().title(), "Sheet");
+
+        std::vector<std::uint8_t> bytes;
+        by_index.save(bytes);
+        xlnt::workbook reloaded;
+        reloaded.load(bytes);
+        xlnt_assert_equals(reloaded.sheet_count(), 2);
+        xlnt_assert_equals(reloaded[1].title(), "Sheet3");
+
+        xlnt::workbook missing;
+        xlnt_assert_throws(missing.load(file, xlnt::load_options().sheet_titles({"Sheet9"})), xlnt::key_not_found);
+        xlnt_assert_throws(missing.load(file, xlnt::load_options().sheet_indices({4})), xlnt::key_not_found);
+    }
+
+    void test_load_skipping_parts()
+    {
+        xlnt::workbook wb;
+        wb.load(path_helper::test_file("10_comments_hyperlinks_formulae.xlsx"),
+            xlnt::load_options().skip_comments(true).skip_properties(true).skip_themes(true));
+        auto ws = wb.sheet_by_title("Sheet1");
+        xlnt_assert(!ws.cell("A1").has_comment());
+        xlnt_assert_equals(ws.cell("A1").value<std::string>(), "Sheet1!A1");
+        xlnt_assert(!wb.has_core_property(xlnt::core_property::creator));
+        xlnt_assert(!wb.has_theme());
+
+        std::vector<std::uint8_t> without_comments;
+        wb.save(without_comments);
+        xlnt::workbook reloaded;
+        reloaded.load(without_comments);
+        xlnt_assert_equals(reloaded.sheet_by_title("Sheet1").cell("A5").hyperlink().url(), "https://google.com/");
+        xlnt_assert(!reloaded.sheet_by_title("Sheet2").cell("A1").has_comment());
+
+        xlnt::workbook images;
+        images.load(path_helper::test_file("14_images.xlsx"), xlnt::load_options().skip_drawings(true));
+        xlnt_assert(!images.active_sheet().has_drawing());
+
+        std::vector<std::uint8_t> bytes;
+        xlnt_assert_throws_nothing(images.save(bytes));
+    }
+
+    void test_load_selected_sheets_content_types()
+    {
+        const auto source_path = path_helper::test_file("10_comments_hyperlinks_formulae.xlsx");
+        xlnt::workbook wb;
+        wb.load(source_path, xlnt::load_options().sheet_titles({"Sheet2"}));
+
+        std::vector<std::uint8_t> bytes;
+        wb.save(bytes);
+        xlnt::workbook reloaded;
+        reloaded.load(bytes);
+        const auto &manifest = reloaded.manifest();
+        xlnt_assert(!manifest.has_override_type(xlnt::path("/xl/comments1.xml")));
+        xlnt_assert(manifest.has_override_type(xlnt::path("/xl/comments2.xml")));
+        xlnt_assert(reloaded.sheet_by_title("Sheet2").cell("A1").has_comment());
+
+        std::ifstream source_stream(source_path.string(), std::ios::binary);
+        xlnt::detail::izstream source_archive(source_stream);
+        xlnt::detail::vector_istreambuf saved_buffer(bytes);
+        std::istream saved_stream(&saved_buffer);
+        xlnt::detail::izstream saved_archive(saved_stream);
+        xlnt_assert(!saved_archive.has_file(xlnt::path("xl/worksheets/_rels/sheet1.xml.rels")));
+        xlnt_assert(!saved_archive.has_file(xlnt::path("xl/drawings/vmlDrawing1.vml")));
+
+        // every part of the source listed in [Content_Types].xml must have been saved
+        for (const auto &part : manifest.parts_with_overriden_types())
+        {
+            const auto member = xlnt::path(part.string().substr(1));
+            xlnt_assert(saved_archive.has_file(member) || !source_archive.has_file(member));
+        }
+    }
+
+    void test_load_values_only()
+    {
+        xlnt::workbook wb;
+        wb.load(path_helper::test_file("10_comments_hyperlinks_formulae.xlsx"),
+            xlnt::load_options().values_only(true).sheet_titles({"Sheet2"}));
+        xlnt_assert_equals(wb.sheet_count(), 1);
+
+        auto ws = wb.active_sheet();
+        xlnt_assert_equals(ws.title(), "Sheet2");
+        xlnt_assert(!ws.cell("C1").has_formula());
+        xlnt_assert(!ws.cell("A4").has_hyperlink());
+        xlnt_assert_equals(ws.cell("A4").value<std::string>(), "hyperlink2");
+        xlnt_assert_equals(ws.cell("C2").value<int>(), 2);
+        xlnt_assert(ws.cell("A1").has_comment());
+    }
+
+    std::vector<std::uint8_t> projection_test_data()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (auto row = xlnt::row_t(1); row <= 10; ++row)
+        {
+            ws.row_properties(row).height = 20.0;
+            ws.row_properties(row).custom_height = true;
+
+            for (auto column = xlnt::column_t(1); column <= 5; ++column)
+            {
+                ws.cell(column, row).value(static_cast<int>(row * 10 + column.index));
+            }
+        }
+
+        std::vector<std::uint8_t> bytes;
+        wb.save(bytes);
+
+        return bytes;
+    }
+
+    void test_load_projection()
+    {
+        xlnt::workbook wb;
+        wb.load(projection_test_data(), xlnt::load_options().projection(xlnt::range_reference("B3:C4")));
+        auto ws = wb.active_sheet();
+
+        xlnt_assert_equals(ws.calculate_dimension(), xlnt::range_reference("B3:C4"));
+        xlnt_assert_equals(ws.cell("B3").value<int>(), 32);
+        xlnt_assert_equals(ws.cell("C4").value<int>(), 43);
+        xlnt_assert(!ws.has_cell("A3"));
+        xlnt_assert(!ws.has_cell("D4"));
+        xlnt_assert(!ws.has_cell("B5"));
+        xlnt_assert(ws.has_row_properties(3));
+        xlnt_assert(!ws.has_row_properties(2));
+        xlnt_assert(!ws.has_row_properties(5));
+    }
+
+    // projection_test_data without the r attributes of rows 2 to 10 and of
+    // the cells in columns B to E, whose positions then follow from the
+    // previous row or cell
+    std::vector<std::uint8_t> implicit_reference_test_data()
+    {
+        const auto bytes = projection_test_data();
+        xlnt::detail::vector_istreambuf source_buffer(bytes);
+        std::istream source_stream(&source_buffer);
+        xlnt::detail::izstream source(source_stream);
+
+        std::vector<std::uint8_t> result;
+        xlnt::detail::vector_ostreambuf result_buffer(result);
+        std::ostream result_stream(&result_buffer);
+
+        {
+            xlnt::detail::ozstream archive(result_stream);
+
+            for (const auto &file : source.files())
+            {
+                auto content = source.read(file);
+
+                if (file == xlnt::path("xl/worksheets/sheet1.xml"))
+                {
+                    content = std::regex_replace(content, std::regex(" r=\"([2-9]|10|[B-E][0-9]+)\""), "");
+                }
+
+                auto file_buffer = archive.open(file);
+                std::ostream(file_buffer.get()) << content;
+            }
+        }
+
+        return result;
+    }
+
+    void test_load_projection_implicit_references()
+    {
+        xlnt::workbook wb;
+        wb.load(implicit_reference_test_data());
+        auto ws = wb.active_sheet();
+        xlnt_assert_equals(ws.calculate_dimension(), xlnt::range_reference("A1:E10"));
+        xlnt_assert_equals(ws.cell("E10").value<int>(), 105);
+
+        xlnt::workbook projected;
+        projected.load(implicit_reference_test_data(), xlnt::load_options().projection(xlnt::range_reference("B3:C4")));
+        ws = projected.active_sheet();
+
+        xlnt_assert_equals(ws.calculate_dimension(), xlnt::range_reference("B3:C4"));
+        xlnt_assert_equals(ws.cell("B3").value<int>(), 32);
+        xlnt_assert_equals(ws.cell("C4").value<int>(), 43);
+        xlnt_assert(ws.has_row_properties(3));
+        xlnt_assert(!ws.has_row_properties(5));
+    }
+
+    void test_streaming_read_projection()
+    {
+        const auto bytes = projection_test_data();
+        xlnt::streaming_workbook_reader reader;
+        reader.open(bytes);
+
+        std::vector<std::string> references;
+        reader.begin_worksheet("Sheet1", xlnt::range_reference("D9:E10"));
+
+        while (reader.has_cell())
+        {
+            references.push_back(reader.read_cell().reference().to_string());
+        }
+
+        reader.end_worksheet();
+
+        xlnt_assert_equals(references.size(), 4);
+        xlnt_assert_equals(references.front(), "D9");
+        xlnt_assert_equals(references.back(), "E10");
+    }
+
+    void test_streaming_read_ahead()
+    {
+        auto read_all = [](xlnt::streaming_workbook_reader &reader) {
+            std::vector<std::string> cells;
+
+            for (auto sheet_name : reader.sheet_titles())
+            {
+                reader.begin_worksheet(sheet_name);
+
+                while (reader.has_cell())
+                {
+                    auto cell = reader.read_cell();
+                    cells.push_back(cell.reference().to_string() + "=" + cell.to_string());
+                }
+
+                reader.end_worksheet();
+            }
+
+            return cells;
+        };
+
+        const auto path = path_helper::test_file("10_comments_hyperlinks_formulae.xlsx");
+
+        xlnt::streaming_workbook_reader reader;
+        reader.open(xlnt::path(path));
+        const auto expected = read_all(reader);
+        reader.close();
+
+        xlnt::streaming_workbook_reader read_ahead_reader;
+        read_ahead_reader.read_ahead(true);
+        read_ahead_reader.open(xlnt::path(path));
+        xlnt_assert(read_all(read_ahead_reader) == expected);
+        read_ahead_reader.close();
+
+        // closing in the middle of a worksheet larger than the buffers stops the thread
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (auto row = 1u; row <= 20000; ++row)
+        {
+            for (auto column = 1u; column <= 4; ++column)
+            {
+                ws.cell(column, row).value(row * column);
+            }
+        }
+
+        std::vector<std::uint8_t> bytes;
+        wb.save(bytes);
+
+        read_ahead_reader.open(bytes);
+        read_ahead_reader.begin_worksheet(ws.title());
+        xlnt_assert(read_ahead_reader.has_cell());
+        xlnt_assert_equals(read_ahead_reader.read_cell().value<int>(), 1);
+        read_ahead_reader.close();
+    }
+
+    void test_load_lazy_worksheets()
+    {
+        const auto file = path_helper::test_file("10_comments_hyperlinks_formulae.xlsx");
+
+        xlnt::workbook eager;
+        eager.load(file);
+        std::vector<std::uint8_t> eager_bytes;
+        eager.save(eager_bytes);
+
+        xlnt::workbook lazy;
+        {
+            std::vector<std::uint8_t> file_bytes;
+            xlnt::workbook(file).save(file_bytes);
+            lazy.load(file_bytes, xlnt::load_options().lazy_worksheets(true));
+        }
+        xlnt_assert_equals(lazy.sheet_titles(), eager.sheet_titles());
+
+        // the archive outlives the data it was loaded from
+        auto ws = lazy.sheet_by_title("Sheet2");
+        xlnt_assert_equals(ws.cell("C2").value<int>(), 2);
+        xlnt_assert(ws.cell("A4").has_hyperlink());
+        xlnt_assert(ws.cell("A1").has_comment());
+
+        lazy.load(file, xlnt::load_options().lazy_worksheets(true));
+        std::vector<std::uint8_t> lazy_bytes;
+        lazy.save(lazy_bytes);
+        xlnt_assert(lazy_bytes == eager_bytes);
+
+        // worksheets after a removed one are still found
+        lazy.load(file, xlnt::load_options().lazy_worksheets(true));
+        lazy.remove_sheet(lazy.sheet_by_index(0));
+        xlnt_assert_equals(lazy.sheet_by_index(0).cell("C2").value<int>(), 2);
+    }
+
+    void test_load_lazy_worksheets_copies_and_threads()
+    {
+        const auto file = path_helper::test_file("10_comments_hyperlinks_formulae.xlsx");
+
+        // each copy gets the cells, whichever of them is accessed first
+        xlnt::workbook lazy;
+        lazy.load(file, xlnt::load_options().lazy_worksheets(true));
+        xlnt::workbook first_copy(lazy);
+        xlnt::workbook second_copy(lazy);
+        xlnt_assert_equals(second_copy.sheet_by_title("Sheet2").cell("C2").value<int>(), 2);
+        xlnt_assert_equals(first_copy.sheet_by_title("Sheet2").cell("C2").value<int>(), 2);
+        xlnt_assert_equals(lazy.sheet_by_title("Sheet2").cell("C2").value<int>(), 2);
+
+        lazy.load(file, xlnt::load_options().lazy_worksheets(true));
+        auto copied = lazy.copy_sheet(lazy.sheet_by_index(0));
+        xlnt_assert_equals(copied.cell("A1").value<std::string>(), "Sheet1!A1");
+
+        // the worksheets are read once however many threads access them
+        lazy.load(file, xlnt::load_options().lazy_worksheets(true));
+        const auto &shared = lazy;
+        std::vector<std::string> values(4);
+        std::vector<std::thread> threads;
+
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            threads.emplace_back([&shared, &values, i]() {
+                values[i] = shared.sheet_by_title("Sheet1").cell("A1").value<std::string>()
+                    + shared.sheet_by_index(1).cell("C2").to_string();
+            });
+        }
+
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        for (const auto &value : values)
+        {
+            xlnt_assert_equals(value, "Sheet1!A12");
+        }
+    }
+
+    void test_load_from_memory()
+    {
+        const auto file = path_helper::test_file("10_comments_hyperlinks_formulae.xlsx");
+
+        std::ifstream file_stream(file.string(), std::ios::binary);
+        std::vector<std::uint8_t> file_bytes((std::istreambuf_iterator<char>(file_stream)),
+            std::istreambuf_iterator<char>());
+        file_stream.seekg(0);
+
+        // read from the stream, a mapping of the file and the bytes in memory
+        xlnt::workbook from_stream;
+        from_stream.load(file_stream);
+        std::vector<std::uint8_t> stream_bytes;
+        from_stream.save(stream_bytes);
+
+        xlnt::workbook from_file;
+        from_file.load(file);
+        std::vector<std::uint8_t> file_saved_bytes;
+        from_file.save(file_saved_bytes);
+        xlnt_assert(file_saved_bytes == stream_bytes);
+
+        xlnt::workbook from_memory;
+        from_memory.load(file_bytes.data(), file_bytes.size());
+        std::vector<std::uint8_t> memory_saved_bytes;
+        from_memory.save(memory_saved_bytes);
+        xlnt_assert(memory_saved_bytes == stream_bytes);
+
+        xlnt::workbook lazy;
+        lazy.load(file_bytes.data(), file_bytes.size(), xlnt::load_options().lazy_worksheets(true));
+        file_bytes.assign(file_bytes.size(), 0);
+        xlnt_assert_equals(lazy.sheet_by_title("Sheet2").cell("C2").value<int>(), 2);
+
+        xlnt_assert_throws(from_memory.load(file_bytes.data(), 10), xlnt::exception);
+        xlnt_assert_throws(from_memory.load(file_bytes.data(), file_bytes.size()), xlnt::exception);
+    }
+
+    void test_load_prefetch()
+    {
+        for (auto name : {"10_comments_hyperlinks_formulae.xlsx", "4_every_style.xlsx", "14_images.xlsx"})
+        {
+            const auto file = path_helper::test_file(name);
+
+            xlnt::workbook expected(file);
+            std::vector<std::uint8_t> expected_bytes;
+            expected.save(expected_bytes);
+
+            for (std::size_t threads : {1, 4})
+            {
+                const auto options = xlnt::load_options().prefetch_threads(threads);
+
+                xlnt::workbook from_file;
+                from_file.load(file, options);
+                std::vector<std::uint8_t> file_bytes;
+                from_file.save(file_bytes);
+                xlnt_assert(file_bytes == expected_bytes);
+
+                std::ifstream file_stream(file.string(), std::ios::binary);
+                xlnt::workbook from_stream;
+                from_stream.load(file_stream, options);
+                std::vector<std::uint8_t> stream_bytes;
+                from_stream.save(stream_bytes);
+                xlnt_assert(stream_bytes == expected_bytes);
+            }
+        }
+
+        // only the parts read before the worksheets are prefetched
+        xlnt::workbook lazy;
+        lazy.load(path_helper::test_file("10_comments_hyperlinks_formulae.xlsx"),
+            xlnt::load_options().prefetch_threads(2).lazy_worksheets(true));
+        xlnt_assert_equals(lazy.sheet_by_title("Sheet2").cell("C2").value<int>(), 2);
+    }
+
+    void test_load_cell_arena()
+    {
+        const auto options = xlnt::load_options().cell_arena(true);
+
+        for (auto name : {"4_every_style.xlsx", "14_images.xlsx", "18_formulae.xlsx"})
+        {
+            const auto file = path_helper::test_file(name);
+
+            xlnt::workbook expected(file);
+            std::vector<std::uint8_t> expected_bytes;
+            expected.save(expected_bytes);
+
+            xlnt::workbook wb;
+            wb.load(file, options);
+            std::vector<std::uint8_t> bytes;
+            wb.save(bytes);
+            xlnt_assert(bytes == expected_bytes);
+
+            // copies and reloads drop the arena along with the cells
+            xlnt::workbook copy(wb);
+            wb.load(file, options);
+
+            for (std::size_t i = 0; i < wb.sheet_count(); ++i)
+            {
+                for (auto row : wb.sheet_by_index(i).rows())
+                {
+                    for (auto cell : row)
+                    {
+                        auto copied = copy.sheet_by_index(i).cell(cell.reference());
+                        xlnt_assert_equals(copied.to_string(), cell.to_string());
+                        xlnt_assert_equals(copied.has_formula(), cell.has_formula());
+                    }
+                }
+            }
+        }
+
+        xlnt::workbook wb;
+        wb.load(path_helper::test_file("10_comments_hyperlinks_formulae.xlsx"), options);
+        xlnt_assert(workbook_matches_file(wb, path_helper::test_file("10_comments_hyperlinks_formulae.xlsx")));
+
+        auto ws = wb.sheet_by_index(0);
+        ws.cell("Z100").formula("=SUM(A1:A2)");
+        ws.cell("Z101").value("inline");
+        ws.cell("Z101").hyperlink("https://example.com");
+        ws.cell("Z100").clear_formula();
+        ws.insert_rows(1, 2);
+        xlnt_assert(!ws.cell("Z102").has_formula());
+        xlnt_assert_equals(ws.cell("Z103").hyperlink().url(), "https://example.com");
+
+        auto added = wb.create_sheet(0);
+        added.cell("A1").formula("=1+1");
+        xlnt_assert(wb.sheet_by_index(0).cell("A1").has_formula());
+        wb.remove_sheet(ws);
+        wb.clear();
+    }
 };
 
 static serialization_test_suite x;
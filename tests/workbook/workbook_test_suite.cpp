@@ -23,6 +23,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <thread>
 
 #include <xlnt/xlnt.hpp>
 #include <detail/serialization/open_stream.hpp>
@@ -62,8 +63,15 @@ public:
         register_test(test_remove_named_range);
         register_test(test_post_increment_iterator);
         register_test(test_copy_iterator);
+        register_test(test_copy_comments);
         register_test(test_manifest);
         register_test(test_memory);
+        register_test(test_copy_on_write);
+        register_test(test_copy_from_threads);
+        register_test(test_shared_strings);
+        register_test(test_shared_strings_shared_reads);
+        register_test(test_compact_styles);
+        register_test(test_restyle_shared_format);
         register_test(test_clear);
         register_test(test_comparison);
         register_test(test_id_gen);
@@ -393,6 +401,29 @@ public:
         xlnt_assert_equals(iter, copy);
     }
 
+    void test_copy_comments()
+    {
+        xlnt::workbook copy;
+
+        {
+            xlnt::workbook wb;
+            auto a1 = wb.active_sheet().cell("A1");
+            a1.value("value");
+            a1.comment(xlnt::comment("note", "author"));
+            copy = wb;
+        }
+
+        auto ws = copy.active_sheet();
+        xlnt_assert(ws.cell("A1").has_comment());
+        xlnt_assert_equals(ws.cell("A1").comment().plain_text(), "note");
+
+        std::vector<std::uint8_t> data;
+        copy.save(data);
+        xlnt::workbook loaded;
+        loaded.load(data);
+        xlnt_assert_equals(loaded.active_sheet().cell("A1").comment().author(), "author");
+    }
+
     void test_manifest()
     {
         xlnt::manifest m;
@@ -413,6 +444,230 @@ public:
         xlnt_assert_equals(wb.active_sheet().title(), "swap");
     }
 
+    void test_copy_on_write()
+    {
+        xlnt::workbook copy;
+
+        {
+            xlnt::workbook wb;
+            auto ws = wb.active_sheet();
+            auto a1 = ws.cell("A1");
+            a1.value(1);
+            ws.cell("B1").value("shared");
+
+            copy = wb;
+            auto copy_ws = copy.active_sheet();
+
+            // cells obtained before copying change only the original
+            a1.value(2);
+            a1.formula("=1+1");
+            xlnt_assert_equals(copy_ws.cell("A1").value<int>(), 1);
+            xlnt_assert(!copy_ws.cell("A1").has_formula());
+
+            copy_ws.cell("A2").value(3);
+            copy_ws.cell("B2").value("copied");
+            xlnt_assert(!ws.has_cell("A2"));
+            xlnt_assert_equals(wb.shared_strings().size(), 1);
+            xlnt_assert_equals(copy.shared_strings().size(), 2);
+
+            auto sheet_copy = wb.copy_sheet(ws);
+            sheet_copy.cell("A1").value(4);
+            sheet_copy.insert_rows(1, 1);
+            xlnt_assert_equals(ws.cell("A1").value<int>(), 2);
+            xlnt_assert_equals(sheet_copy.cell("A2").value<int>(), 4);
+        }
+
+        // the copy outlives the workbook it shared its cells with
+        std::vector<std::uint8_t> data;
+        copy.save(data);
+        xlnt::workbook loaded;
+        loaded.load(data);
+        auto ws = loaded.active_sheet();
+        xlnt_assert_equals(ws.cell("A1").value<int>(), 1);
+        xlnt_assert_equals(ws.cell("B1").value<std::string>(), "shared");
+        xlnt_assert_equals(ws.cell("A2").value<int>(), 3);
+        xlnt_assert_equals(ws.cell("B2").value<std::string>(), "copied");
+    }
+
+    void test_copy_from_threads()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (xlnt::row_t row = 1; row <= 1000; ++row)
+        {
+            ws.cell(1, row).value(static_cast<int>(row));
+            ws.cell(2, row).value("row " + std::to_string(row));
+        }
+
+        // copies are made from and changed on several threads at once, the
+        // workbook they share their cells with is only read
+        const xlnt::workbook &source = wb;
+        std::vector<std::thread> threads;
+        std::vector<int> failures(4, 0);
+
+        for (std::size_t i = 0; i < failures.size(); ++i)
+        {
+            threads.emplace_back([&source, &failures, i]() {
+                for (int round = 0; round < 20; ++round)
+                {
+                    xlnt::workbook copy(source);
+                    auto copy_ws = copy.active_sheet();
+                    const auto changed = static_cast<xlnt::row_t>(1 + (i * 311 + static_cast<std::size_t>(round) * 97) % 1000);
+                    copy_ws.cell(1, changed).value(-1);
+                    copy_ws.cell(2, changed).value("changed");
+                    copy_ws.insert_rows(500, 1);
+
+                    std::vector<std::uint8_t> data;
+                    copy.save(data);
+
+                    const auto moved = changed >= 500 ? changed + 1 : changed;
+                    failures[i] += copy_ws.cell(1, moved).value<int>() != -1;
+                    failures[i] += copy_ws.cell(2, moved).value<std::string>() != "changed";
+                    failures[i] += source.sheet_by_index(0).cell(1, changed).value<int>() != static_cast<int>(changed);
+                    failures[i] += copy_ws.cell(1, 1001).value<int>() != 1000;
+                }
+            });
+        }
+
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        for (auto failed : failures)
+        {
+            xlnt_assert_equals(failed, 0);
+        }
+
+        xlnt_assert_equals(ws.cell(2, 1000).value<std::string>(), "row 1000");
+        xlnt_assert_equals(wb.shared_strings().size(), 1000);
+    }
+
+    void test_shared_strings()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A1").value("plain");
+        ws.cell("A2").value(" spaced ");
+        ws.cell("A3").value(xlnt::rich_text("bold", xlnt::font().bold(true)));
+        ws.cell("A4").value("plain");
+
+        xlnt_assert_equals(wb.add_shared_string(std::string("plain")), 0);
+        xlnt_assert_equals(wb.add_shared_string(xlnt::rich_text("plain")), 0);
+        xlnt_assert_equals(wb.add_shared_string(std::string("plain"), true), 3);
+        xlnt_assert_equals(wb.shared_strings(1), xlnt::rich_text(" spaced "));
+        xlnt_assert_equals(ws.cell("A3").value<xlnt::rich_text>().runs().front().second.get().bold(), true);
+
+        // strings changed in place are seen by the cells using them
+        wb.shared_strings()[0] = xlnt::rich_text("changed");
+        xlnt_assert_equals(ws.cell("A4").value<std::string>(), "changed");
+        ws.cell("A5").value("plain");
+        xlnt_assert_equals(ws.cell("A5").value<std::string>(), "plain");
+
+        std::vector<std::uint8_t> data;
+        wb.save(data);
+        xlnt::workbook loaded;
+        loaded.load(data);
+        auto loaded_ws = loaded.active_sheet();
+        xlnt_assert_equals(loaded_ws.cell("A1").value<std::string>(), "changed");
+        xlnt_assert_equals(loaded_ws.cell("A2").value<std::string>(), " spaced ");
+        xlnt_assert_equals(loaded_ws.cell("A3").value<xlnt::rich_text>(), ws.cell("A3").value<xlnt::rich_text>());
+        xlnt_assert_equals(loaded_ws.cell("A5").value<std::string>(), "plain");
+    }
+
+    void test_shared_strings_shared_reads()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (xlnt::row_t row = 1; row <= 1000; ++row)
+        {
+            ws.cell(1, row).value("string " + std::to_string(row));
+        }
+
+        xlnt_assert_equals(wb.shared_strings(999), xlnt::rich_text("string 1000"));
+        xlnt_assert_equals(wb.shared_strings(1000), xlnt::rich_text());
+
+        // the copy shares the strings, converting them to rich_text mustn't race
+        const xlnt::workbook original(wb);
+        const xlnt::workbook copy(wb);
+        std::size_t original_size = 0;
+        std::size_t copy_size = 0;
+        std::thread reader([&original, &original_size]() { original_size = original.shared_strings().size(); });
+        copy_size = copy.shared_strings().size();
+        reader.join();
+
+        xlnt_assert_equals(original_size, 1000);
+        xlnt_assert_equals(copy_size, 1000);
+        xlnt_assert_equals(copy.shared_strings()[499], xlnt::rich_text("string 500"));
+    }
+
+    void test_compact_styles()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A1").font(xlnt::font().bold(true));
+        ws.cell("A2").font(xlnt::font().italic(true));
+        ws.cell("A1").font(xlnt::font().italic(true));
+
+        // the bold format is kept until the styles are compacted
+        xlnt_assert(wb.format(1).font().bold());
+        xlnt_assert(wb.format(2).font().italic());
+        wb.compact_styles();
+        xlnt_assert(wb.format(1).font().italic());
+        xlnt_assert_throws(wb.format(2), xlnt::invalid_parameter);
+        xlnt_assert(ws.cell("A1").font().italic());
+
+        // or the workbook is saved
+        ws.cell("A1").font(xlnt::font().bold(true));
+        ws.cell("A2").font(xlnt::font().bold(true));
+        xlnt_assert(wb.format(2).font().bold());
+        std::vector<std::uint8_t> data;
+        wb.save(data);
+        xlnt_assert(wb.format(1).font().bold());
+        xlnt_assert_throws(wb.format(2), xlnt::invalid_parameter);
+        xlnt_assert(ws.cell("A2").font().bold());
+
+        xlnt::workbook loaded;
+        loaded.load(data);
+        xlnt_assert(loaded.active_sheet().cell("A2").font().bold());
+        xlnt_assert(loaded.format(1).font().bold());
+        xlnt_assert_throws(loaded.format(2), xlnt::invalid_parameter);
+    }
+
+    void test_restyle_shared_format()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A1").font(xlnt::font().italic(true));
+        ws.cell("A2").font(xlnt::font().bold(true));
+        ws.cell("A3").format(ws.cell("A2").format());
+        ws.cell("B1").value(ws.cell("A3"));
+        std::vector<std::uint8_t> data;
+        wb.save(data);
+
+        xlnt::workbook loaded;
+        loaded.load(data);
+        auto loaded_ws = loaded.active_sheet();
+
+        // the bold format is the last one and still used by A3 and B1 when A2
+        // is given the italic one
+        loaded_ws.cell("A2").font(xlnt::font().italic(true));
+        xlnt_assert(loaded_ws.cell("A3").font().bold());
+        loaded_ws.cell("A3").clear_format();
+        xlnt_assert(loaded_ws.cell("B1").font().bold());
+
+        // ranges count each cell once as well
+        loaded_ws.range("A1:A3").font(xlnt::font().bold(true));
+        loaded_ws.cell("A1").clear_format();
+        loaded.compact_styles();
+        xlnt_assert(loaded_ws.cell("A2").font().bold());
+        xlnt_assert(loaded_ws.cell("A3").font().bold());
+        xlnt_assert(loaded_ws.cell("B1").font().bold());
+        xlnt_assert(!loaded_ws.cell("A1").has_format());
+    }
+
     void test_clear()
     {
         xlnt::workbook wb;
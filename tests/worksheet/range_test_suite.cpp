@@ -39,6 +39,7 @@ public:
     {
         register_test(test_construction);
         register_test(test_batch_formatting);
+        register_test(test_batch_formatting_mixed);
         register_test(test_clear_cells);
     }
 
@@ -100,6 +101,41 @@ public:
         xlnt_assert(!ws.cell("B2").has_format());
     }
     
+    void test_batch_formatting_mixed()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A1").font(xlnt::font().bold(true));
+        ws.cell("A2").font(xlnt::font().italic(true));
+        ws.cell("A3").font(xlnt::font().bold(true));
+        ws.cell("B1").fill(xlnt::fill::solid(xlnt::rgb_color(255, 0, 0)));
+
+        ws.range("A1:B4").fill(xlnt::fill::solid(xlnt::rgb_color(0, 255, 0)));
+
+        for (auto row : ws.range("A1:B4"))
+        {
+            for (auto cell : row)
+            {
+                xlnt_assert_equals(cell.fill(), xlnt::fill::solid(xlnt::rgb_color(0, 255, 0)));
+            }
+        }
+
+        xlnt_assert(ws.cell("A1").font().bold());
+        xlnt_assert(ws.cell("A2").font().italic());
+        xlnt_assert(ws.cell("A3").font().bold());
+        xlnt_assert(!ws.cell("C1").has_format());
+
+        // the cells sharing a format keep it when one of them is restyled
+        ws.cell("A1").font(xlnt::font().italic(true));
+        ws.cell("B2").font(xlnt::font().italic(true));
+        wb.compact_styles();
+        xlnt_assert(ws.cell("A3").font().bold());
+        xlnt_assert(ws.cell("A4").has_format());
+        xlnt_assert_equals(ws.cell("A4").fill(), xlnt::fill::solid(xlnt::rgb_color(0, 255, 0)));
+        xlnt_assert(ws.cell("A1").font().italic());
+        xlnt_assert(ws.cell("B2").font().italic());
+    }
+
     void test_clear_cells()
     {
         xlnt::workbook wb;
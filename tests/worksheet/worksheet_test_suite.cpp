@@ -21,10 +21,19 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <cmath>
+#include <limits>
+
 #include <xlnt/cell/cell.hpp>
+#include <xlnt/cell/comment.hpp>
 #include <xlnt/cell/hyperlink.hpp>
+#include <xlnt/styles/font.hpp>
+#include <xlnt/styles/number_format.hpp>
+#include <xlnt/utils/datetime.hpp>
+#include <xlnt/utils/variant.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/worksheet/column_properties.hpp>
+#include <xlnt/worksheet/column_view.hpp>
 #include <xlnt/worksheet/header_footer.hpp>
 #include <xlnt/worksheet/range.hpp>
 #include <xlnt/worksheet/row_properties.hpp>
@@ -73,6 +82,9 @@ public:
         register_test(test_lowest_row_or_props);
         register_test(test_highest_row);
         register_test(test_highest_row_or_props);
+        register_test(test_bounds_after_clear);
+        register_test(test_stored_cells);
+        register_test(test_sparse_iteration);
         register_test(test_iterator_has_value);
         register_test(test_const_iterators);
         register_test(test_const_reverse_iterators);
@@ -111,6 +123,13 @@ public:
         register_test(test_hidden_sheet);
         register_test(test_xlsm_read_write);
         register_test(test_issue_484);
+        register_test(test_save_sparse);
+        register_test(test_move_cells_with_extras);
+        register_test(test_column_values);
+        register_test(test_column_values_out_of_range);
+        register_test(test_assign_extract);
+        register_test(test_assign_rows);
+        register_test(test_assign_rows_dates);
     }
 
     void test_new_worksheet()
@@ -579,6 +598,109 @@ public:
         xlnt_assert_equals(ws.highest_row_or_props(), 11);
     }
 
+    void test_bounds_after_clear()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        xlnt_assert_equals(ws.next_row(), 1);
+
+        for (auto i = 0; i < 10; ++i)
+        {
+            ws.cell(static_cast<xlnt::column_t::index_t>(i % 3 + 2), ws.next_row()).value(i);
+        }
+
+        xlnt_assert_equals(ws.next_row(), 11);
+        xlnt_assert_equals(ws.calculate_dimension(), xlnt::range_reference("B1:D10"));
+        xlnt_assert_equals(ws.calculate_dimension(false), xlnt::range_reference("A1:D10"));
+
+        ws.clear_cell("B10");
+        ws.clear_row(9);
+        xlnt_assert_equals(ws.next_row(), 9);
+        xlnt_assert_equals(ws.highest_column(), 4);
+
+        ws.clear_cell("D3");
+        ws.clear_cell("D6");
+        xlnt_assert_equals(ws.calculate_dimension(), xlnt::range_reference("B1:C8"));
+
+        ws.row_properties(12).height = 14.3;
+        xlnt_assert_equals(ws.calculate_dimension(), xlnt::range_reference("B1:C12"));
+        xlnt_assert_equals(ws.next_row(), 9);
+    }
+
+    void test_stored_cells()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        xlnt_assert(ws.stored_cells().empty());
+
+        ws.cell("C1").value(1);
+        ws.cell("A2").value(2);
+        ws.cell("B2").value(3);
+        ws.cell("A5").value(4);
+
+        std::vector<std::string> references;
+
+        for (auto cell : ws.stored_cells())
+        {
+            references.push_back(cell.reference().to_string());
+        }
+
+        xlnt_assert(references == (std::vector<std::string>{"C1", "A2", "B2", "A5"}));
+
+        references.clear();
+        const auto &const_ws = ws;
+
+        for (auto cell : const_ws.stored_cells(xlnt::major_order::column))
+        {
+            references.push_back(cell.reference().to_string());
+        }
+
+        xlnt_assert(references == (std::vector<std::string>{"A2", "A5", "B2", "C1"}));
+    }
+
+    void test_sparse_iteration()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("B2").value("B2");
+        ws.cell("XFD1000000").value("XFD1000000");
+        ws.cell("XFD3").value("XFD3");
+
+        std::vector<std::string> references;
+
+        for (auto row : ws.rows())
+        {
+            for (auto cell : row)
+            {
+                references.push_back(cell.reference().to_string());
+            }
+        }
+
+        xlnt_assert(references == (std::vector<std::string>{"B2", "XFD3", "XFD1000000"}));
+
+        references.clear();
+
+        for (auto column : ws.columns())
+        {
+            for (auto cell : column)
+            {
+                references.push_back(cell.reference().to_string());
+            }
+        }
+
+        xlnt_assert(references == (std::vector<std::string>{"B2", "XFD3", "XFD1000000"}));
+
+        const auto rows = ws.rows();
+        auto last_row = rows.end();
+        --last_row;
+        xlnt_assert_equals((*last_row).front().reference(), "XFD1000000");
+        --last_row;
+        xlnt_assert_equals((*last_row).back().reference(), "XFD3");
+        xlnt_assert_equals((*last_row).front().reference(), "XFD3");
+        --last_row;
+        xlnt_assert(last_row == rows.begin());
+    }
+
     void test_iterator_has_value()
     {
         xlnt::workbook wb;
@@ -1674,6 +1796,218 @@ public:
         xlnt_assert_equals("B12:B12", ws.columns(true).reference());
         xlnt_assert_equals("A1:B12", ws.columns(false).reference());
     }
+
+    void test_save_sparse()
+    {
+        // only the cells which exist are visited, not the whole dimension
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A1").value(1);
+        ws.cell("XFD1048576").value("last");
+        ws.cell("C500000").value(true);
+        ws.row_properties(700000).height = 30;
+        xlnt_assert_equals(ws.calculate_dimension().to_string(), "A1:XFD1048576");
+
+        std::vector<std::uint8_t> bytes;
+        wb.save(bytes);
+
+        xlnt::workbook loaded;
+        loaded.load(bytes);
+        auto loaded_ws = loaded.active_sheet();
+        xlnt_assert_equals(loaded_ws.cell("A1").value<int>(), 1);
+        xlnt_assert_equals(loaded_ws.cell("XFD1048576").value<std::string>(), "last");
+        xlnt_assert(loaded_ws.cell("C500000").value<bool>());
+        xlnt_assert_equals(loaded_ws.row_properties(700000).height.get(), 30);
+        xlnt_assert(!loaded_ws.has_cell("B1"));
+    }
+
+    void test_move_cells_with_extras()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A2").formula("=SUM(B1:B5)");
+        ws.cell("B2").hyperlink("https://example.com/", "link");
+        ws.cell("C2").comment("note", "author");
+        ws.cell("D2").error("#N/A");
+
+        ws.insert_rows(1, 2);
+
+        xlnt_assert(!ws.cell("A2").has_formula());
+        xlnt_assert_equals(ws.cell("A4").formula(), "SUM(B1:B5)");
+        xlnt_assert_equals(ws.cell("B4").hyperlink().url(), "https://example.com/");
+        xlnt_assert_equals(ws.cell("C4").comment().plain_text(), "note");
+        xlnt_assert(!ws.cell("C2").has_comment());
+        xlnt_assert_equals(ws.cell("D4").error(), "#N/A");
+
+        ws.delete_rows(1, 2);
+        xlnt_assert_equals(ws.cell("C2").comment().plain_text(), "note");
+
+        // a cleared cell doesn't keep its text, formula or hyperlink
+        ws.cell("A2").clear_value();
+        ws.clear_cell("B2");
+        xlnt_assert(!ws.cell("A2").has_formula());
+        xlnt_assert(!ws.cell("B2").has_hyperlink());
+        xlnt_assert(!ws.cell("B2").has_value());
+    }
+
+    void test_column_values()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("B1").value(1.5);
+        ws.cell("B2").value("text");
+        ws.cell("B4").value(-2.75);
+        ws.cell("B5").value(true);
+        ws.cell("A3").value(3);
+        ws.cell("C3").value(4);
+        ws.cell("B300").value(xlnt::datetime(2021, 3, 4, 5, 6, 7));
+
+        auto doubles = ws.column_values<double>(2);
+        xlnt_assert_equals(doubles.first_row(), 1);
+        xlnt_assert_equals(doubles.size(), 300);
+        xlnt_assert_equals(doubles.valid_count(), 3);
+        xlnt_assert(doubles.valid(0));
+        xlnt_assert(!doubles.valid(1));
+        xlnt_assert(!doubles.valid(2));
+        xlnt_assert(doubles.valid(3));
+        xlnt_assert(!doubles.valid(4));
+        xlnt_assert_equals(doubles[0], 1.5);
+        xlnt_assert_equals(doubles.data()[3], -2.75);
+        xlnt_assert_equals(doubles[2], 0.0);
+        xlnt_assert_equals(doubles.validity()[0], 0x09);
+
+        auto integers = ws.column_values<std::int64_t>(2, 4, 5);
+        xlnt_assert_equals(integers.first_row(), 4);
+        xlnt_assert_equals(integers.size(), 2);
+        xlnt_assert_equals(integers[0], -2);
+        xlnt_assert(!integers.valid(1));
+
+        auto booleans = ws.column_values<bool>(2, 1, 5);
+        xlnt_assert_equals(booleans.valid_count(), 1);
+        xlnt_assert(booleans.valid(4) && booleans[4]);
+        xlnt_assert(!booleans.valid(0) && !booleans[0]);
+
+        auto datetimes = ws.column_values<xlnt::datetime>(2, 300, 300);
+        xlnt_assert(datetimes.valid(0));
+        xlnt_assert_equals(datetimes[0], xlnt::datetime(2021, 3, 4, 5, 6, 7));
+
+        auto sum = 0.0;
+        for (auto value : ws.column_values<double>(2, 1, 4))
+        {
+            sum += value;
+        }
+        xlnt_assert_equals(sum, -1.25);
+
+        xlnt_assert(ws.column_values<double>(2, 5, 4).empty());
+        xlnt_assert_equals(ws.column_values<double>(4).valid_count(), 0);
+    }
+
+    void test_column_values_out_of_range()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A1").value(std::numeric_limits<double>::quiet_NaN());
+        ws.cell("A2").value(1e30);
+        ws.cell("A3").value(-std::numeric_limits<double>::infinity());
+        ws.cell("A4").value(-9223372036854775808.0);
+        ws.cell("A5").value(-1.0);
+
+        auto integers = ws.column_values<std::int64_t>(1);
+        xlnt_assert_equals(integers.valid_count(), 2);
+        xlnt_assert(!integers.valid(0) && integers[0] == 0);
+        xlnt_assert(!integers.valid(1) && integers[1] == 0);
+        xlnt_assert(!integers.valid(2));
+        xlnt_assert(integers.valid(3));
+        xlnt_assert_equals(integers[3], std::numeric_limits<std::int64_t>::min());
+        xlnt_assert_equals(integers[4], -1);
+
+        auto datetimes = ws.column_values<xlnt::datetime>(1);
+        xlnt_assert_equals(datetimes.valid_count(), 0);
+
+        auto doubles = ws.column_values<double>(1);
+        xlnt_assert_equals(doubles.valid_count(), 5);
+        xlnt_assert(std::isnan(doubles[0]));
+    }
+
+    void test_assign_extract()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("C2").value("kept text");
+        ws.cell("C2").number_format(xlnt::number_format::percentage());
+        ws.cell("E2").value(9);
+
+        const std::vector<double> values{1, 2, 3, 4, 5, 6};
+        ws.assign(xlnt::range_reference("B2:D3"), values.data(), values.size());
+
+        xlnt_assert_equals(ws.cell("B2").value<double>(), 1);
+        xlnt_assert_equals(ws.cell("C2").value<double>(), 2);
+        xlnt_assert_equals(ws.cell("C2").number_format(), xlnt::number_format::percentage());
+        xlnt_assert_equals(ws.cell("D3").value<double>(), 6);
+        xlnt_assert_equals(ws.cell("E2").value<int>(), 9);
+        xlnt_assert_equals(ws.calculate_dimension(), xlnt::range_reference("B2:E3"));
+        xlnt_assert_throws(ws.assign(xlnt::range_reference("B2:D3"), values.data(), 5), xlnt::invalid_parameter);
+
+        ws.cell("D2").value(true);
+        std::vector<double> extracted(8);
+        ws.extract(xlnt::range_reference("B2:E3"), extracted.data(), extracted.size());
+        xlnt_assert_equals(extracted[0], 1);
+        xlnt_assert_equals(extracted[1], 2);
+        xlnt_assert(std::isnan(extracted[2]));
+        xlnt_assert_equals(extracted[3], 9);
+        xlnt_assert_equals(extracted[6], 6);
+        xlnt_assert(std::isnan(extracted[7]));
+        xlnt_assert_throws(ws.extract(xlnt::range_reference("B2:E3"), extracted.data(), 6), xlnt::invalid_parameter);
+    }
+
+    void test_assign_rows()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("B1").value(7);
+
+        ws.assign(xlnt::cell_reference("A1"),
+            {{xlnt::variant(1.5), xlnt::variant(), xlnt::variant("text")},
+                {},
+                {xlnt::variant(true), xlnt::variant(std::int32_t(3)), xlnt::variant(xlnt::datetime(2021, 1, 2))}});
+
+        xlnt_assert_equals(ws.cell("A1").value<double>(), 1.5);
+        xlnt_assert(!ws.cell("B1").has_value());
+        xlnt_assert_equals(ws.cell("C1").value<std::string>(), "text");
+        xlnt_assert(!ws.has_cell("A2"));
+        xlnt_assert_equals(ws.cell("A3").data_type(), xlnt::cell::type::boolean);
+        xlnt_assert_equals(ws.cell("B3").value<int>(), 3);
+        xlnt_assert(ws.cell("C3").is_date());
+        xlnt_assert_equals(ws.cell("C3").value<xlnt::datetime>(), xlnt::datetime(2021, 1, 2));
+
+        xlnt_assert_throws(ws.assign(xlnt::cell_reference("A5"), {{xlnt::variant(std::vector<xlnt::variant>{})}}),
+            xlnt::invalid_parameter);
+    }
+
+    void test_assign_rows_dates()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A2").font(xlnt::font().bold(true));
+
+        std::vector<std::vector<xlnt::variant>> rows;
+
+        for (int day = 1; day <= 4; ++day)
+        {
+            rows.push_back({xlnt::variant(xlnt::datetime(2021, 1, day))});
+        }
+
+        ws.assign(xlnt::cell_reference("A1"), rows);
+
+        for (xlnt::row_t row = 1; row <= 4; ++row)
+        {
+            xlnt_assert(ws.cell(1, row).is_date());
+            xlnt_assert_equals(ws.cell(1, row).value<xlnt::datetime>(), xlnt::datetime(2021, 1, static_cast<int>(row)));
+            xlnt_assert_equals(ws.cell(1, row).number_format(), xlnt::number_format::date_datetime());
+        }
+
+        xlnt_assert(ws.cell("A2").font().bold());
+    }
 };
 
 static worksheet_test_suite x;